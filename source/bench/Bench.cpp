@@ -0,0 +1,161 @@
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+
+#include "Bench.hpp"
+
+namespace bench {
+
+namespace {
+
+QString baselineKey(const QString &name, const QString &params) {
+    return name + QLatin1Char('|') + params;
+}
+
+void printUsage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s [--filter=<substr>] [--format=json|csv|table]\n"
+                 "          [--samples=N] [--min-time-ms=MS] [--baseline=<file.jsonl>]\n",
+                 program);
+}
+
+} // namespace
+
+const char *optionValue(const char *arg, const char *name) {
+    const std::size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return nullptr;
+}
+
+bool parseOptions(int argc, char *argv[], Options &out) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = nullptr;
+        bool ok = true;
+
+        if ((value = optionValue(arg, "--filter"))) {
+            out.filter = QString::fromLocal8Bit(value);
+        } else if ((value = optionValue(arg, "--format"))) {
+            if (std::strcmp(value, "json") == 0) {
+                out.format = Format::JsonLines;
+            } else if (std::strcmp(value, "csv") == 0) {
+                out.format = Format::Csv;
+            } else if (std::strcmp(value, "table") == 0) {
+                out.format = Format::Table;
+            } else {
+                ok = false;
+            }
+        } else if ((value = optionValue(arg, "--samples"))) {
+            out.samples = QByteArray(value).toInt(&ok);
+            ok = ok && out.samples > 0;
+        } else if ((value = optionValue(arg, "--min-time-ms"))) {
+            out.minTimeMs = QByteArray(value).toDouble(&ok);
+            ok = ok && out.minTimeMs > 0;
+        } else if ((value = optionValue(arg, "--baseline"))) {
+            out.baselinePath = QString::fromLocal8Bit(value);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+Runner::Runner(Options options)
+    : m_options(std::move(options)) {
+    loadBaseline();
+}
+
+bool Runner::selected(const QString &name) const {
+    return m_options.filter.isEmpty() || name.contains(m_options.filter);
+}
+
+void Runner::loadBaseline() {
+    if (m_options.baselinePath.isEmpty()) {
+        return;
+    }
+
+    QFile file(m_options.baselinePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "bench: cannot open baseline %s\n",
+                     qPrintable(m_options.baselinePath));
+        return;
+    }
+
+    while (!file.atEnd()) {
+        const QJsonObject row = QJsonDocument::fromJson(file.readLine()).object();
+        if (row.contains(QLatin1String("ns_median"))) {
+            m_baseline.insert(baselineKey(row.value(QLatin1String("name")).toString(),
+                                          row.value(QLatin1String("params")).toString()),
+                              row.value(QLatin1String("ns_median")).toDouble());
+        }
+    }
+}
+
+void Runner::report(const QString &name, const QString &params, quint64 iterations,
+                    QVector<double> &perOp) {
+    std::sort(perOp.begin(), perOp.end());
+
+    Result result;
+    result.name = name;
+    result.params = params;
+    result.iterations = iterations;
+    result.nsMin = perOp.constFirst();
+    result.nsMax = perOp.constLast();
+    result.nsMedian = perOp[perOp.size() / 2];
+    result.baselineNs = m_baseline.value(baselineKey(name, params), -1.0);
+
+    const bool hasBaseline = result.baselineNs > 0;
+    const double deltaPct =
+        hasBaseline ? (result.nsMedian - result.baselineNs) * 100.0 / result.baselineNs : 0.0;
+
+    switch (m_options.format) {
+    case Format::JsonLines: {
+        QJsonObject row{{"name", result.name},
+                        {"params", result.params},
+                        {"iterations", double(result.iterations)},
+                        {"samples", perOp.size()},
+                        {"ns_median", result.nsMedian},
+                        {"ns_min", result.nsMin},
+                        {"ns_max", result.nsMax},
+                        {"ops_per_sec", result.nsMedian > 0 ? 1e9 / result.nsMedian : 0.0}};
+        if (hasBaseline) {
+            row.insert("baseline_ns_median", result.baselineNs);
+            row.insert("delta_pct", deltaPct);
+        }
+        std::fprintf(m_out, "%s\n",
+                     QJsonDocument(row).toJson(QJsonDocument::Compact).constData());
+        break;
+    }
+    case Format::Csv:
+        if (!m_headerPrinted) {
+            std::fprintf(m_out, "name,params,iterations,ns_median,ns_min,ns_max,delta_pct\n");
+            m_headerPrinted = true;
+        }
+        std::fprintf(m_out, "%s,\"%s\",%llu,%.2f,%.2f,%.2f,%s\n", qPrintable(result.name),
+                     qPrintable(result.params), static_cast<unsigned long long>(iterations),
+                     result.nsMedian, result.nsMin, result.nsMax,
+                     hasBaseline ? qPrintable(QString::number(deltaPct, 'f', 1)) : "");
+        break;
+    case Format::Table:
+        if (!m_headerPrinted) {
+            std::fprintf(m_out, "%-28s %-26s %12s %12s %12s %8s\n", "name", "params",
+                         "median ns", "min ns", "max ns", "delta");
+            m_headerPrinted = true;
+        }
+        std::fprintf(m_out, "%-28s %-26s %12.1f %12.1f %12.1f %8s\n", qPrintable(result.name),
+                     qPrintable(result.params), result.nsMedian, result.nsMin, result.nsMax,
+                     hasBaseline ? qPrintable(QString::asprintf("%+.1f%%", deltaPct)) : "");
+        break;
+    }
+    std::fflush(m_out);
+}
+
+} // namespace bench
@@ -0,0 +1,114 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Минимальный харнесс микробенчмарков: калибровка числа итераций под
+// --min-time-ms, затем --samples замеров; в отчёт идут медиана/мин/макс
+// нс на операцию. Вывод — JSON Lines (по строке на кейс), CSV или таблица.
+// --baseline=<прошлый .jsonl> добавляет к каждому кейсу дельту в процентах.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace bench {
+
+// Не даёт компилятору выбросить вычисление результата
+template <typename T>
+inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+enum class Format { JsonLines, Csv, Table };
+
+struct Options {
+    QString filter;           // подстрока имени кейса; пусто — все
+    Format format = Format::JsonLines;
+    int samples = 7;
+    double minTimeMs = 50.0;  // длительность одного замера после калибровки
+    QString baselinePath;
+};
+
+// Значение ключа вида --name=value; nullptr — ключ другой
+const char *optionValue(const char *arg, const char *name);
+
+// Разбор argv; false — неизвестный ключ или --help (usage уже напечатан)
+bool parseOptions(int argc, char *argv[], Options &out);
+
+struct Result {
+    QString name;
+    QString params;
+    quint64 iterations = 0;   // итераций в одном замере
+    double nsMedian = 0;
+    double nsMin = 0;
+    double nsMax = 0;
+    double baselineNs = -1;   // < 0 — нет в baseline
+};
+
+class Runner {
+public:
+    explicit Runner(Options options);
+
+    bool selected(const QString &name) const;
+
+    // op() — одна операция; состояние между вызовами — на совести кейса
+    template <typename Op>
+    void run(const QString &name, const QString &params, Op &&op) {
+        if (!selected(name)) {
+            return;
+        }
+
+        const double targetNs = m_options.minTimeMs * 1e6;
+        quint64 iterations = 1;
+        for (;;) {
+            const double ns = timeBatch(op, iterations);
+            if (ns >= targetNs || iterations >= (quint64(1) << 32)) {
+                break;
+            }
+            // Доводим до цели с запасом, но не больше чем в 10 раз за шаг
+            const double scale = ns > 0 ? targetNs * 1.2 / ns : 10.0;
+            iterations = quint64(double(iterations) * std::min(std::max(scale, 2.0), 10.0));
+        }
+
+        QVector<double> perOp;
+        perOp.reserve(m_options.samples);
+        for (int i = 0; i < m_options.samples; ++i) {
+            perOp.append(timeBatch(op, iterations) / double(iterations));
+        }
+
+        report(name, params, iterations, perOp);
+    }
+
+private:
+    template <typename Op>
+    static double timeBatch(Op &op, quint64 iterations) {
+        const auto started = std::chrono::steady_clock::now();
+        for (quint64 i = 0; i < iterations; ++i) {
+            op();
+        }
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - started)
+                          .count());
+    }
+
+    void report(const QString &name, const QString &params, quint64 iterations,
+                QVector<double> &perOp);
+    void loadBaseline();
+
+    Options m_options;
+    QHash<QString, double> m_baseline; // "name|params" → nsMedian
+    std::FILE *m_out = stdout;
+    bool m_headerPrinted = false;
+};
+
+} // namespace bench
+
+#endif // BENCH_HPP
@@ -0,0 +1,116 @@
+#include <QtEndian>
+#include <algorithm>
+
+#include "DatasetGenerator.hpp"
+#include "UuidCodec.hpp"
+
+namespace {
+
+constexpr quint64 kTaskDomain = 0x7461736b; // "task"
+constexpr quint64 kTagDomain = 0x746167;    // "tag"
+
+// v7: условное начало времени датасета и id на одну мс
+constexpr quint64 kV7BaseMs = 1700000000000ULL;
+constexpr quint64 kV7IdsPerMs = 1024;
+
+quint64 mix(quint64 x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Слова из фиксированного словаря — текст похож на реальный по длине слов
+// и сжимаемости, но не зависит от локали
+constexpr const char *kWords[] = {
+    "fix", "review", "deploy", "release", "migrate", "database", "client",
+    "report", "weekly", "invoice", "update", "search", "index", "cache",
+    "backend", "frontend", "design", "meeting", "customer", "support",
+    "ticket", "sprint", "refactor", "benchmark", "schema", "export",
+};
+constexpr int kWordCount = int(sizeof(kWords) / sizeof(kWords[0]));
+
+QString sentence(DatasetGenerator::Random &random, int chars) {
+    QString out;
+    out.reserve(chars + 12);
+    while (out.size() < chars) {
+        if (!out.isEmpty()) {
+            out.append(QLatin1Char(' '));
+        }
+        out.append(QLatin1String(kWords[random.below(kWordCount)]));
+    }
+    out.truncate(chars);
+    return out;
+}
+
+} // namespace
+
+quint64 DatasetGenerator::Random::next() {
+    m_state += 0x9e3779b97f4a7c15ULL;
+    return mix(m_state);
+}
+
+DatasetGenerator::DatasetGenerator(DatasetConfig config)
+    : m_config(config) {
+    m_config.tagCount = std::max(0, m_config.tagCount);
+    m_config.minTagsPerTask = std::clamp(m_config.minTagsPerTask, 0, m_config.tagCount);
+    m_config.maxTagsPerTask =
+        std::clamp(m_config.maxTagsPerTask, m_config.minTagsPerTask, m_config.tagCount);
+}
+
+DatasetGenerator::Random DatasetGenerator::random(quint64 stream) const {
+    return Random(mix(m_config.seed ^ mix(stream)));
+}
+
+QUuid DatasetGenerator::uuid(quint64 domain, quint64 index) const {
+    if (m_config.idVersion == 7) {
+        return makeUuidV7(kV7BaseMs + index / kV7IdsPerMs, index % kV7IdsPerMs,
+                          quint32(mix(m_config.seed ^ mix(domain) ^ index)));
+    }
+
+    // Версия 4 / вариант RFC 4122, биты из двух независимых хешей
+    uchar bytes[16];
+    qToBigEndian(mix(m_config.seed ^ mix(domain) ^ index), bytes);
+    qToBigEndian(mix(mix(m_config.seed + domain) + index), bytes + 8);
+    bytes[6] = uchar((bytes[6] & 0x0f) | 0x40);
+    bytes[8] = uchar((bytes[8] & 0x3f) | 0x80);
+    return QUuid::fromRfc4122(QByteArrayView(bytes, 16));
+}
+
+QUuid DatasetGenerator::taskId(qint64 index) const {
+    return uuid(kTaskDomain, quint64(index));
+}
+
+QUuid DatasetGenerator::tagId(int index) const {
+    return uuid(kTagDomain, quint64(index));
+}
+
+Tag DatasetGenerator::tag(int index) const {
+    Tag tag;
+    tag.id = tagId(index);
+    tag.name = QStringLiteral("tag-%1").arg(index);
+    return tag;
+}
+
+Task DatasetGenerator::task(qint64 index) const {
+    Random random = this->random(kTaskDomain + quint64(index));
+
+    Task task;
+    task.id = taskId(index);
+    task.title = sentence(random, m_config.titleChars);
+    task.description = sentence(random, m_config.descriptionChars);
+    task.isCompleted = double(random.next() >> 11) * 0x1.0p-53 < m_config.completedRatio;
+
+    const int span = m_config.maxTagsPerTask - m_config.minTagsPerTask;
+    const int tagCount = m_config.minTagsPerTask + int(random.below(quint64(span) + 1));
+    task.tags.reserve(tagCount);
+    // Без повторов: при совпадении выбираем заново (maxTagsPerTask ≤ tagCount)
+    while (task.tags.size() < tagCount) {
+        QUuid id = tagId(int(random.below(quint64(m_config.tagCount))));
+        while (task.tags.contains(id)) {
+            id = tagId(int(random.below(quint64(m_config.tagCount))));
+        }
+        task.tags.append(id);
+    }
+    return task;
+}
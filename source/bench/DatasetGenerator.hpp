@@ -0,0 +1,59 @@
+#ifndef DATASETGENERATOR_HPP
+#define DATASETGENERATOR_HPP
+
+#include <QString>
+#include <QUuid>
+
+#include "Tag.hpp"
+#include "Task.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Детерминированный синтетический датасет: любая задача/тег строится по
+// (seed, индекс) без общего состояния, так что потоки генерируют свои
+// диапазоны независимо, а одинаковый seed даёт одинаковые данные.
+// ─────────────────────────────────────────────────────────────────────────────
+struct DatasetConfig {
+    qint64 taskCount = 10000;
+    int tagCount = 100;          // кардинальность тегов
+    int minTagsPerTask = 0;
+    int maxTagsPerTask = 4;
+    int titleChars = 40;
+    int descriptionChars = 160;
+    double completedRatio = 0.3;
+    quint64 seed = 42;
+    int idVersion = 4;           // 4 — случайные id, 7 — растущие по индексу
+};
+
+class DatasetGenerator {
+public:
+    explicit DatasetGenerator(DatasetConfig config);
+
+    const DatasetConfig &config() const { return m_config; }
+
+    QUuid taskId(qint64 index) const;
+    QUuid tagId(int index) const;
+
+    Task task(qint64 index) const;
+    Tag tag(int index) const;
+
+    // Независимый поток псевдослучайных чисел (splitmix64)
+    class Random {
+    public:
+        explicit Random(quint64 seed) : m_state(seed) {}
+        quint64 next();
+        // Равномерно в [0, bound)
+        quint64 below(quint64 bound) { return bound ? next() % bound : 0; }
+
+    private:
+        quint64 m_state;
+    };
+
+    Random random(quint64 stream) const;
+
+private:
+    QUuid uuid(quint64 domain, quint64 index) const;
+
+    DatasetConfig m_config;
+};
+
+#endif // DATASETGENERATOR_HPP
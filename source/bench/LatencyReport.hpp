@@ -0,0 +1,22 @@
+#ifndef LATENCYREPORT_HPP
+#define LATENCYREPORT_HPP
+
+#include <QJsonObject>
+
+#include "LatencyHistogram.hpp"
+
+// Перцентили среза гистограммы в микросекундах — общий формат отчётов бенчей
+inline QJsonObject latencyJson(const LatencyHistogram::Snapshot &latency) {
+    const auto us = [&latency](double q) { return double(latency.valueAt(q)) / 1000.0; };
+    return QJsonObject{
+        {"count", double(latency.count)},
+        {"mean", latency.count ? double(latency.sumNs) / double(latency.count) / 1000.0 : 0.0},
+        {"p50", us(0.50)},
+        {"p90", us(0.90)},
+        {"p99", us(0.99)},
+        {"p999", us(0.999)},
+        {"max", double(latency.maxNs) / 1000.0},
+    };
+}
+
+#endif // LATENCYREPORT_HPP
@@ -0,0 +1,228 @@
+#include <QByteArrayView>
+#include <QList>
+#include <algorithm>
+
+#include "LoadConnection.hpp"
+
+namespace {
+
+bool headerIs(QByteArrayView line, QByteArrayView name, QByteArrayView &value) {
+    if (line.size() <= name.size() || line.at(name.size()) != ':' ||
+        line.first(name.size()).compare(name, Qt::CaseInsensitive) != 0) {
+        return false;
+    }
+    value = line.sliced(name.size() + 1).trimmed();
+    return true;
+}
+
+} // namespace
+
+LoadConnection::LoadConnection(QString host, quint16 port)
+    : m_host(std::move(host)),
+      m_port(port),
+      m_socket(std::make_unique<QTcpSocket>()) {
+    QObject::connect(m_socket.get(), &QTcpSocket::readyRead, m_socket.get(),
+                     [this] { onReadyRead(); });
+    QObject::connect(m_socket.get(), &QTcpSocket::disconnected, m_socket.get(),
+                     [this] { onDisconnected(); });
+    QObject::connect(m_socket.get(), &QTcpSocket::errorOccurred, m_socket.get(),
+                     [this](QAbstractSocket::SocketError) { onDisconnected(); });
+}
+
+LoadConnection::~LoadConnection() {
+    // Отключаемся от сигналов до разрушения: abort() испускает disconnected
+    QObject::disconnect(m_socket.get(), nullptr, m_socket.get(), nullptr);
+    m_socket->abort();
+}
+
+void LoadConnection::send(const QByteArray &request, bool keepBody, Completion done) {
+    // Сокет, закрытый сервером (или закрывающийся), переоткрываем до того,
+    // как запомнить done: abort() может синхронно испустить disconnected
+    const auto state = m_socket->state();
+    if (state == QAbstractSocket::ClosingState || state == QAbstractSocket::UnconnectedState) {
+        m_socket->abort();
+        m_buffer.clear();
+        m_socket->connectToHost(m_host, m_port);
+        m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    }
+
+    m_done = std::move(done);
+    m_keepBody = keepBody;
+    m_body.clear();
+    m_state = State::Headers;
+
+    // До установления соединения QTcpSocket буферизует запись сам
+    m_socket->write(request);
+}
+
+void LoadConnection::onDisconnected() {
+    m_buffer.clear();
+    if (m_done) {
+        complete(0);
+    }
+}
+
+bool LoadConnection::parseHeaders(qsizetype end) {
+    const QByteArrayView head(m_buffer.constData(), end);
+    const QList<QByteArrayView> lines = [&head] {
+        QList<QByteArrayView> out;
+        qsizetype from = 0;
+        while (from < head.size()) {
+            qsizetype eol = head.indexOf("\r\n", from);
+            if (eol < 0) {
+                eol = head.size();
+            }
+            out.append(head.sliced(from, eol - from));
+            from = eol + 2;
+        }
+        return out;
+    }();
+
+    // "HTTP/1.1 200 OK"
+    if (lines.isEmpty() || !lines.first().startsWith("HTTP/1.") || lines.first().size() < 12) {
+        return false;
+    }
+    bool ok = false;
+    m_status = lines.first().sliced(9, 3).toInt(&ok);
+    if (!ok) {
+        return false;
+    }
+
+    m_remaining = 0;
+    m_chunked = false;
+    m_closeAfter = lines.first().startsWith("HTTP/1.0");
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        QByteArrayView value;
+        if (headerIs(lines.at(i), "Content-Length", value)) {
+            m_remaining = value.toLongLong(&ok);
+            if (!ok || m_remaining < 0) {
+                return false;
+            }
+        } else if (headerIs(lines.at(i), "Transfer-Encoding", value)) {
+            m_chunked = value.compare("chunked", Qt::CaseInsensitive) == 0;
+        } else if (headerIs(lines.at(i), "Connection", value)) {
+            m_closeAfter = value.compare("close", Qt::CaseInsensitive) == 0;
+        }
+    }
+    return true;
+}
+
+void LoadConnection::consumeBody(qsizetype &pos) {
+    const qint64 take = std::min<qint64>(m_remaining, m_buffer.size() - pos);
+    if (m_keepBody) {
+        m_body.append(m_buffer.constData() + pos, take);
+    }
+    pos += take;
+    m_remaining -= take;
+}
+
+void LoadConnection::onReadyRead() {
+    m_buffer.append(m_socket->readAll());
+    if (!m_done) {
+        // Ответ без запроса — протокол нарушен, дальше читать нечего
+        m_buffer.clear();
+        return;
+    }
+
+    qsizetype pos = 0;
+    for (;;) {
+        switch (m_state) {
+        case State::Headers: {
+            const qsizetype end = m_buffer.indexOf("\r\n\r\n", pos);
+            if (end < 0) {
+                m_buffer.remove(0, pos);
+                return;
+            }
+            const bool parsed = parseHeaders(end);
+            pos = end + 4;
+            if (!parsed) {
+                m_socket->abort();
+                return;
+            }
+            if (m_chunked) {
+                m_state = State::ChunkSize;
+            } else if (m_remaining > 0) {
+                m_state = State::Body;
+            } else {
+                m_buffer.remove(0, pos);
+                complete(m_status);
+                return;
+            }
+            break;
+        }
+        case State::Body:
+            consumeBody(pos);
+            if (m_remaining > 0) {
+                m_buffer.remove(0, pos);
+                return;
+            }
+            m_buffer.remove(0, pos);
+            complete(m_status);
+            return;
+        case State::ChunkSize: {
+            const qsizetype eol = m_buffer.indexOf("\r\n", pos);
+            if (eol < 0) {
+                m_buffer.remove(0, pos);
+                return;
+            }
+            QByteArrayView line(m_buffer.constData() + pos, eol - pos);
+            const qsizetype extension = line.indexOf(';');
+            if (extension >= 0) {
+                line = line.first(extension);
+            }
+            bool ok = false;
+            m_remaining = line.trimmed().toLongLong(&ok, 16);
+            pos = eol + 2;
+            if (!ok || m_remaining < 0) {
+                m_socket->abort();
+                return;
+            }
+            m_state = m_remaining == 0 ? State::ChunkTrailer : State::ChunkData;
+            break;
+        }
+        case State::ChunkData:
+            consumeBody(pos);
+            if (m_remaining > 0) {
+                m_buffer.remove(0, pos);
+                return;
+            }
+            m_state = State::ChunkDataEnd;
+            break;
+        case State::ChunkDataEnd:
+            if (m_buffer.size() - pos < 2) {
+                m_buffer.remove(0, pos);
+                return;
+            }
+            pos += 2;
+            m_state = State::ChunkSize;
+            break;
+        case State::ChunkTrailer: {
+            const qsizetype eol = m_buffer.indexOf("\r\n", pos);
+            if (eol < 0) {
+                m_buffer.remove(0, pos);
+                return;
+            }
+            const bool last = eol == pos;
+            pos = eol + 2;
+            if (last) {
+                m_buffer.remove(0, pos);
+                complete(m_status);
+                return;
+            }
+            break;
+        }
+        }
+    }
+}
+
+void LoadConnection::complete(int status) {
+    Completion done = std::move(m_done);
+    m_done = nullptr;
+    m_state = State::Headers;
+
+    if (status != 0 && m_closeAfter) {
+        m_socket->disconnectFromHost();
+    }
+    // done может сразу отправить следующий запрос через это же соединение
+    done(status, m_body);
+}
@@ -0,0 +1,56 @@
+#ifndef LOADCONNECTION_HPP
+#define LOADCONNECTION_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QTcpSocket>
+#include <functional>
+#include <memory>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Keep-alive HTTP/1.1 клиент поверх QTcpSocket для tasklit_loadgen: один
+// запрос в полёте, разбор ответа инкрементально (Content-Length и chunked),
+// тело сохраняется только по запросу. После закрытия сервером соединение
+// переоткрывается при следующей отправке.
+// ─────────────────────────────────────────────────────────────────────────────
+class LoadConnection {
+public:
+    // status = 0 — сетевая ошибка или обрыв до конца ответа
+    using Completion = std::function<void(int status, const QByteArray &body)>;
+
+    LoadConnection(QString host, quint16 port);
+    ~LoadConnection();
+
+    LoadConnection(const LoadConnection &) = delete;
+    LoadConnection &operator=(const LoadConnection &) = delete;
+
+    bool isBusy() const { return static_cast<bool>(m_done); }
+
+    // request — полностью сформированный запрос (строка, заголовки, тело)
+    void send(const QByteArray &request, bool keepBody, Completion done);
+
+private:
+    enum class State { Headers, Body, ChunkSize, ChunkData, ChunkDataEnd, ChunkTrailer };
+
+    void onReadyRead();
+    void onDisconnected();
+    bool parseHeaders(qsizetype end);
+    void consumeBody(qsizetype &pos);
+    void complete(int status);
+
+    QString m_host;
+    quint16 m_port;
+    std::unique_ptr<QTcpSocket> m_socket;
+
+    Completion m_done;
+    bool m_keepBody = false;
+    QByteArray m_buffer;
+    QByteArray m_body;
+    State m_state = State::Headers;
+    int m_status = 0;
+    qint64 m_remaining = 0;
+    bool m_chunked = false;
+    bool m_closeAfter = false;
+};
+
+#endif // LOADCONNECTION_HPP
@@ -0,0 +1,673 @@
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQueue>
+#include <QTimer>
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Bench.hpp"
+#include "DatasetGenerator.hpp"
+#include "LatencyHistogram.hpp"
+#include "LatencyReport.hpp"
+#include "LoadConnection.hpp"
+#include "UuidCodec.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// tasklit_loadgen: end-to-end нагрузка на запущенный Tasklit смесью реальных
+// маршрутов TaskRouter по keep-alive соединениям.
+//
+// Open loop (--rate > 0): запросы назначаются на фиксированные моменты
+// времени; если все соединения заняты, запрос ждёт в очереди, а латентность
+// считается от назначенного момента — так медленный сервер не «прячет»
+// задержку, притормаживая клиента (coordinated omission).
+// Closed loop (--rate=0): каждое соединение шлёт следующий запрос сразу после
+// ответа; с --expected-interval-us пропущенные из-за задержки отправки
+// досчитываются в скорректированную гистограмму (как в HdrHistogram).
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+enum class Route { ListTasks, GetTask, CreateTask, PatchTask, DeleteTask, ListTags };
+constexpr int kRouteCount = 6;
+
+struct RouteInfo {
+    const char *key;  // имя в --mix
+    const char *name; // как в логах сервера
+    int defaultWeight;
+};
+
+constexpr std::array<RouteInfo, kRouteCount> kRoutes{{
+    {"list_tasks", "GET /tasks", 5},
+    {"get_task", "GET /task", 50},
+    {"create_task", "POST /task/create", 15},
+    {"patch_task", "PATCH /task", 20},
+    {"delete_task", "DELETE /task", 5},
+    {"list_tags", "GET /tags", 5},
+}};
+
+struct Options {
+    QString host = QStringLiteral("127.0.0.1");
+    quint16 port = 8080;
+    int connections = 32;
+    double rate = 0;             // запросов/с; 0 — closed loop
+    double durationSec = 30;
+    double warmupSec = 5;
+    double expectedIntervalUs = 0;
+    int seedTasks = 1000;
+    int seedTags = 20;
+    int listLimit = 100;
+    quint64 seed = 1;
+    std::array<int, kRouteCount> weights{};
+};
+
+struct RouteStats {
+    LatencyHistogram corrected;
+    quint64 completed = 0;
+    quint64 status2xx = 0;
+    quint64 status4xx = 0;
+    quint64 status5xx = 0;
+    quint64 shed = 0;        // 503 от admission control
+    quint64 networkErrors = 0;
+};
+
+class LoadGen {
+public:
+    explicit LoadGen(Options options);
+
+    void start();
+
+private:
+    // Заполнение сервера перед замером: теги, затем задачи
+    struct SeedStage {
+        int count = 0;
+        int next = 0;
+        int accepted = 0;
+        bool keepBody = false;
+        std::function<QByteArray(int index, QUuid &id)> build;
+        std::function<void(const QUuid &id, const QByteArray &body)> accept;
+        std::function<void()> then;
+    };
+
+    void runSeedStage(SeedStage stage);
+    void seedPump(int connection);
+    void startMeasurement();
+
+    void onTick();
+    void issue(int connection, qint64 intendedNs);
+    void onResponse(int connection, Route route, const QUuid &id, int status,
+                    qint64 intendedNs, qint64 sentNs);
+    void stop();
+    void finish();
+
+    Route pickRoute();
+    QUuid nextUuid();
+    QByteArray buildRequest(Route &route, QUuid &id);
+    QByteArray httpRequest(const char *method, const QByteArray &target,
+                           const QByteArray &body = {}) const;
+    QByteArray taskBody(const QUuid &id);
+
+    Options m_options;
+    QByteArray m_hostHeader;
+    DatasetGenerator::Random m_random;
+    std::vector<std::unique_ptr<LoadConnection>> m_connections;
+    QVector<int> m_idle;
+    int m_inFlight = 0;
+
+    SeedStage m_seed;
+    QVector<QUuid> m_taskIds;
+    QVector<QUuid> m_tagIds;
+
+    QTimer m_timer;
+    bool m_openLoop = false;
+    bool m_stopping = false;
+    qint64 m_startNs = 0;
+    qint64 m_measureFromNs = 0;
+    qint64 m_endNs = 0;
+    quint64 m_scheduled = 0;
+    QQueue<qint64> m_backlog; // назначенные, но ещё не отправленные
+    quint64 m_maxBacklog = 0;
+    quint64 m_unsent = 0;
+    quint64 m_sent = 0;
+    qint64 m_lastProgressNs = 0;
+
+    std::array<RouteStats, kRouteCount> m_routes;
+    LatencyHistogram m_corrected;
+    LatencyHistogram m_uncorrected;
+};
+
+LoadGen::LoadGen(Options options)
+    : m_options(std::move(options)),
+      m_random(DatasetGenerator::Random(m_options.seed)) {
+    m_hostHeader = m_options.host.toLatin1() + ':' + QByteArray::number(m_options.port);
+    m_openLoop = m_options.rate > 0;
+
+    m_connections.reserve(m_options.connections);
+    for (int i = 0; i < m_options.connections; ++i) {
+        m_connections.push_back(std::make_unique<LoadConnection>(m_options.host, m_options.port));
+    }
+
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(1);
+    QObject::connect(&m_timer, &QTimer::timeout, &m_timer, [this] { onTick(); });
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Подготовка данных
+// ─────────────────────────────────────────────────────────────────────────────
+void LoadGen::start() {
+    std::fprintf(stderr, "loadgen: seeding %d tags and %d tasks on %s\n", m_options.seedTags,
+                 m_options.seedTasks, m_hostHeader.constData());
+
+    SeedStage tags;
+    tags.count = m_options.seedTags;
+    tags.keepBody = true;
+    tags.build = [this](int index, QUuid &) {
+        const QByteArray name = "loadgen-" + QByteArray::number(m_options.seed) + '-' +
+                                QByteArray::number(index) + '-' +
+                                QByteArray::number(m_random.next() & 0xffffff, 16);
+        return httpRequest("POST", "/tag/create", "{\"name\":\"" + name + "\"}");
+    };
+    tags.accept = [this](const QUuid &, const QByteArray &body) {
+        const QJsonObject tag = QJsonDocument::fromJson(body)
+                                    .object()
+                                    .value(QLatin1String("data"))
+                                    .toObject()
+                                    .value(QLatin1String("tag"))
+                                    .toObject();
+        const QUuid id = parseUuid(tag.value(QLatin1String("id")).toString());
+        if (!id.isNull()) {
+            m_tagIds.append(id);
+        }
+    };
+    tags.then = [this] {
+        SeedStage tasks;
+        tasks.count = m_options.seedTasks;
+        tasks.build = [this](int, QUuid &id) {
+            id = nextUuid();
+            return httpRequest("POST", "/task/create", taskBody(id));
+        };
+        tasks.accept = [this](const QUuid &id, const QByteArray &) { m_taskIds.append(id); };
+        tasks.then = [this] { startMeasurement(); };
+        runSeedStage(std::move(tasks));
+    };
+    runSeedStage(std::move(tags));
+}
+
+void LoadGen::runSeedStage(SeedStage stage) {
+    const int previousCount = m_seed.count;
+    const int previousAccepted = m_seed.accepted;
+    if (previousCount > 0 && previousAccepted == 0) {
+        std::fprintf(stderr, "loadgen: seeding failed, is Tasklit running on %s?\n",
+                     m_hostHeader.constData());
+        QCoreApplication::exit(1);
+        return;
+    }
+
+    m_seed = std::move(stage);
+    if (m_seed.count == 0) {
+        auto then = std::move(m_seed.then);
+        then();
+        return;
+    }
+    for (int i = 0; i < int(m_connections.size()); ++i) {
+        seedPump(i);
+    }
+}
+
+void LoadGen::seedPump(int connection) {
+    if (m_seed.next >= m_seed.count) {
+        if (m_inFlight == 0 && m_seed.then) {
+            auto then = std::move(m_seed.then);
+            m_seed.then = nullptr;
+            then();
+        }
+        return;
+    }
+
+    QUuid id;
+    const QByteArray request = m_seed.build(m_seed.next++, id);
+    ++m_inFlight;
+    m_connections[connection]->send(
+        request, m_seed.keepBody, [this, connection, id](int status, const QByteArray &body) {
+            --m_inFlight;
+            if (status >= 200 && status < 300) {
+                ++m_seed.accepted;
+                m_seed.accept(id, body);
+            }
+            seedPump(connection);
+        });
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Замер
+// ─────────────────────────────────────────────────────────────────────────────
+void LoadGen::startMeasurement() {
+    if (m_seed.count > 0 && m_seed.accepted == 0) {
+        std::fprintf(stderr, "loadgen: seeding tasks failed\n");
+        QCoreApplication::exit(1);
+        return;
+    }
+
+    std::fprintf(stderr, "loadgen: %s loop, %d connections%s, %.0fs (+%.0fs warmup)\n",
+                 m_openLoop ? "open" : "closed", m_options.connections,
+                 m_openLoop ? qPrintable(QStringLiteral(", %1 req/s").arg(m_options.rate)) : "",
+                 m_options.durationSec, m_options.warmupSec);
+
+    m_startNs = nowNs();
+    m_measureFromNs = m_startNs + qint64(m_options.warmupSec * 1e9);
+    m_endNs = m_measureFromNs + qint64(m_options.durationSec * 1e9);
+    m_lastProgressNs = m_startNs;
+
+    m_idle.clear();
+    for (int i = 0; i < int(m_connections.size()); ++i) {
+        if (m_openLoop) {
+            m_idle.append(i);
+        } else {
+            issue(i, nowNs());
+        }
+    }
+    m_timer.start();
+}
+
+void LoadGen::onTick() {
+    const qint64 now = nowNs();
+
+    if (m_openLoop) {
+        // Моменты считаются от старта, а не накоплением интервала — без дрейфа
+        for (;;) {
+            const qint64 intended =
+                m_startNs + qint64(double(m_scheduled) * 1e9 / m_options.rate);
+            if (intended > now || intended >= m_endNs) {
+                break;
+            }
+            m_backlog.enqueue(intended);
+            ++m_scheduled;
+        }
+        m_maxBacklog = std::max<quint64>(m_maxBacklog, quint64(m_backlog.size()));
+        while (!m_backlog.isEmpty() && !m_idle.isEmpty()) {
+            issue(m_idle.takeLast(), m_backlog.dequeue());
+        }
+    }
+
+    if (now - m_lastProgressNs >= 1'000'000'000) {
+        m_lastProgressNs = now;
+        std::fprintf(stderr, "loadgen: t=%.0fs sent=%llu in-flight=%d backlog=%lld\n",
+                     double(now - m_startNs) / 1e9, static_cast<unsigned long long>(m_sent),
+                     m_inFlight, static_cast<long long>(m_backlog.size()));
+    }
+
+    if (now >= m_endNs) {
+        stop();
+    }
+}
+
+void LoadGen::issue(int connection, qint64 intendedNs) {
+    Route route = pickRoute();
+    QUuid id;
+    const QByteArray request = buildRequest(route, id);
+
+    const qint64 sentNs = nowNs();
+    ++m_sent;
+    ++m_inFlight;
+    m_connections[connection]->send(
+        request, false,
+        [this, connection, route, id, intendedNs, sentNs](int status, const QByteArray &) {
+            onResponse(connection, route, id, status, intendedNs, sentNs);
+        });
+}
+
+void LoadGen::onResponse(int connection, Route route, const QUuid &id, int status,
+                         qint64 intendedNs, qint64 sentNs) {
+    const qint64 doneNs = nowNs();
+    --m_inFlight;
+
+    if (route == Route::CreateTask && status >= 200 && status < 300) {
+        m_taskIds.append(id);
+    }
+
+    RouteStats &stats = m_routes[int(route)];
+    if (intendedNs >= m_measureFromNs && intendedNs < m_endNs) {
+        if (status == 0) {
+            ++stats.networkErrors;
+        } else {
+            ++stats.completed;
+            if (status < 300) {
+                ++stats.status2xx;
+            } else if (status < 500) {
+                ++stats.status4xx;
+            } else {
+                ++stats.status5xx;
+                stats.shed += status == 503 ? 1 : 0;
+            }
+
+            const quint64 corrected = quint64(doneNs - intendedNs);
+            m_corrected.record(corrected);
+            stats.corrected.record(corrected);
+            m_uncorrected.record(quint64(doneNs - sentNs));
+
+            // Closed loop: запросы, которые были бы отправлены за время
+            // ожидания этого ответа, досчитываются с убывающей задержкой
+            const qint64 expected = qint64(m_options.expectedIntervalUs * 1000.0);
+            if (!m_openLoop && expected > 0) {
+                for (qint64 missed = qint64(corrected) - expected; missed >= expected;
+                     missed -= expected) {
+                    m_corrected.record(quint64(missed));
+                    stats.corrected.record(quint64(missed));
+                }
+            }
+        }
+    }
+
+    if (m_stopping) {
+        if (m_inFlight == 0) {
+            finish();
+        }
+        return;
+    }
+
+    if (m_openLoop) {
+        if (!m_backlog.isEmpty()) {
+            issue(connection, m_backlog.dequeue());
+        } else {
+            m_idle.append(connection);
+        }
+    } else {
+        issue(connection, nowNs());
+    }
+}
+
+void LoadGen::stop() {
+    m_stopping = true;
+    m_timer.stop();
+
+    // Не отправленные к концу запросы ждали не меньше (конец − назначенное
+    // время) — учитываем как нижнюю оценку, иначе перегрузка выглядит лучше
+    m_unsent = quint64(m_backlog.size());
+    while (!m_backlog.isEmpty()) {
+        const qint64 intended = m_backlog.dequeue();
+        if (intended >= m_measureFromNs) {
+            m_corrected.record(quint64(m_endNs - intended));
+        }
+    }
+
+    if (m_inFlight == 0) {
+        finish();
+        return;
+    }
+    // Зависшие ответы не держат отчёт дольше 10 с
+    QTimer::singleShot(10'000, &m_timer, [this] {
+        if (m_stopping) {
+            finish();
+        }
+    });
+}
+
+void LoadGen::finish() {
+    if (!m_stopping) {
+        return;
+    }
+    m_stopping = false;
+
+    const double seconds = double(m_endNs - m_measureFromNs) / 1e9;
+    quint64 completed = 0;
+    QJsonArray routes;
+    for (int i = 0; i < kRouteCount; ++i) {
+        const RouteStats &stats = m_routes[i];
+        completed += stats.completed;
+        if (stats.completed == 0 && stats.networkErrors == 0) {
+            continue;
+        }
+        routes.append(QJsonObject{
+            {"route", QLatin1String(kRoutes[i].name)},
+            {"completed", double(stats.completed)},
+            {"throughput", double(stats.completed) / seconds},
+            {"status2xx", double(stats.status2xx)},
+            {"status4xx", double(stats.status4xx)},
+            {"status5xx", double(stats.status5xx)},
+            {"shed503", double(stats.shed)},
+            {"networkErrors", double(stats.networkErrors)},
+            {"latencyUs", latencyJson(stats.corrected.snapshot())},
+        });
+    }
+
+    QJsonObject mix;
+    for (int i = 0; i < kRouteCount; ++i) {
+        mix.insert(QLatin1String(kRoutes[i].key), m_options.weights[i]);
+    }
+
+    const QJsonObject report{
+        {"target", QString::fromLatin1(m_hostHeader)},
+        {"mode", m_openLoop ? "open" : "closed"},
+        {"rate", m_options.rate},
+        {"connections", m_options.connections},
+        {"durationSec", m_options.durationSec},
+        {"warmupSec", m_options.warmupSec},
+        {"mix", mix},
+        {"completed", double(completed)},
+        {"throughput", double(completed) / seconds},
+        {"inFlightAtEnd", m_inFlight},
+        {"unsentAtEnd", double(m_unsent)},
+        {"maxBacklog", double(m_maxBacklog)},
+        {"latencyUs",
+         QJsonObject{{"corrected", latencyJson(m_corrected.snapshot())},
+                     {"uncorrected", latencyJson(m_uncorrected.snapshot())}}},
+        {"routes", routes},
+    };
+    std::fprintf(stdout, "%s", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    std::fflush(stdout);
+    QCoreApplication::exit(0);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Запросы
+// ─────────────────────────────────────────────────────────────────────────────
+Route LoadGen::pickRoute() {
+    int total = 0;
+    for (const int weight : m_options.weights) {
+        total += weight;
+    }
+    int roll = int(m_random.below(quint64(total)));
+    for (int i = 0; i < kRouteCount; ++i) {
+        roll -= m_options.weights[i];
+        if (roll < 0) {
+            return Route(i);
+        }
+    }
+    return Route::GetTask;
+}
+
+QUuid LoadGen::nextUuid() {
+    uchar bytes[16];
+    qToBigEndian(m_random.next(), bytes);
+    qToBigEndian(m_random.next(), bytes + 8);
+    bytes[6] = uchar((bytes[6] & 0x0f) | 0x40);
+    bytes[8] = uchar((bytes[8] & 0x3f) | 0x80);
+    return QUuid::fromRfc4122(QByteArrayView(bytes, 16));
+}
+
+QByteArray LoadGen::httpRequest(const char *method, const QByteArray &target,
+                                const QByteArray &body) const {
+    QByteArray out;
+    out.reserve(128 + target.size() + body.size());
+    out.append(method).append(' ').append(target).append(" HTTP/1.1\r\nHost: ");
+    out.append(m_hostHeader).append("\r\n");
+    if (!body.isEmpty() || std::strcmp(method, "POST") == 0 || std::strcmp(method, "PATCH") == 0) {
+        out.append("Content-Type: application/json\r\nContent-Length: ");
+        out.append(QByteArray::number(body.size())).append("\r\n");
+    }
+    out.append("\r\n").append(body);
+    return out;
+}
+
+QByteArray LoadGen::taskBody(const QUuid &id) {
+    QByteArray body = "{\"id\":\"" + uuidToString(id).toLatin1() +
+                      "\",\"title\":\"loadgen task " +
+                      QByteArray::number(m_random.next() & 0xfffff) +
+                      "\",\"description\":\"synthetic task created by tasklit_loadgen\","
+                      "\"isCompleted\":false,\"tags\":[";
+    const int tagCount = m_tagIds.isEmpty() ? 0 : int(m_random.below(4));
+    for (int i = 0; i < tagCount; ++i) {
+        body.append(i > 0 ? ",\"" : "\"");
+        body.append(uuidToString(m_tagIds.at(qsizetype(m_random.below(m_tagIds.size()))))
+                        .toLatin1());
+        body.append('"');
+    }
+    body.append("]}");
+    return body;
+}
+
+QByteArray LoadGen::buildRequest(Route &route, QUuid &id) {
+    // Без известных задач точечные маршруты превращаются в создание
+    const bool needsTask =
+        route == Route::GetTask || route == Route::PatchTask || route == Route::DeleteTask;
+    if (needsTask && m_taskIds.isEmpty()) {
+        route = Route::CreateTask;
+    }
+
+    switch (route) {
+    case Route::ListTasks:
+        return httpRequest("GET", "/tasks?limit=" + QByteArray::number(m_options.listLimit));
+    case Route::GetTask:
+        id = m_taskIds.at(qsizetype(m_random.below(m_taskIds.size())));
+        return httpRequest("GET", "/task?id=" + uuidToString(id).toLatin1());
+    case Route::CreateTask:
+        id = nextUuid();
+        return httpRequest("POST", "/task/create", taskBody(id));
+    case Route::PatchTask:
+        id = m_taskIds.at(qsizetype(m_random.below(m_taskIds.size())));
+        return httpRequest("PATCH", "/task?id=" + uuidToString(id).toLatin1(),
+                           "{\"title\":\"patched " +
+                               QByteArray::number(m_random.next() & 0xfffff) +
+                               "\",\"isCompleted\":true}");
+    case Route::DeleteTask: {
+        // Удаляемый id сразу убираем из пула, чтобы не читать его параллельно
+        const qsizetype index = qsizetype(m_random.below(m_taskIds.size()));
+        id = m_taskIds.at(index);
+        m_taskIds.swapItemsAt(index, m_taskIds.size() - 1);
+        m_taskIds.removeLast();
+        return httpRequest("DELETE", "/task?id=" + uuidToString(id).toLatin1());
+    }
+    case Route::ListTags:
+        return httpRequest("GET", "/tags");
+    }
+    return {};
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Аргументы
+// ─────────────────────────────────────────────────────────────────────────────
+bool parseMix(const QByteArray &value, std::array<int, kRouteCount> &weights) {
+    weights.fill(0);
+    for (const QByteArray &item : value.split(',')) {
+        const QList<QByteArray> pair = item.split(':');
+        if (pair.size() != 2) {
+            return false;
+        }
+        bool ok = false;
+        const int weight = pair.at(1).toInt(&ok);
+        if (!ok || weight < 0) {
+            return false;
+        }
+        bool known = false;
+        for (int i = 0; i < kRouteCount; ++i) {
+            if (pair.at(0) == kRoutes[i].key) {
+                weights[i] = weight;
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return std::any_of(weights.begin(), weights.end(), [](int w) { return w > 0; });
+}
+
+bool parseOptions(int argc, char *argv[], Options &out) {
+    for (int i = 0; i < kRouteCount; ++i) {
+        out.weights[i] = kRoutes[i].defaultWeight;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = nullptr;
+        bool ok = true;
+
+        if ((value = bench::optionValue(arg, "--host"))) {
+            out.host = QString::fromLocal8Bit(value);
+        } else if ((value = bench::optionValue(arg, "--port"))) {
+            out.port = QByteArray(value).toUShort(&ok);
+        } else if ((value = bench::optionValue(arg, "--connections"))) {
+            out.connections = QByteArray(value).toInt(&ok);
+            ok = ok && out.connections > 0;
+        } else if ((value = bench::optionValue(arg, "--rate"))) {
+            out.rate = QByteArray(value).toDouble(&ok);
+            ok = ok && out.rate >= 0;
+        } else if ((value = bench::optionValue(arg, "--duration"))) {
+            out.durationSec = QByteArray(value).toDouble(&ok);
+            ok = ok && out.durationSec > 0;
+        } else if ((value = bench::optionValue(arg, "--warmup"))) {
+            out.warmupSec = QByteArray(value).toDouble(&ok);
+            ok = ok && out.warmupSec >= 0;
+        } else if ((value = bench::optionValue(arg, "--expected-interval-us"))) {
+            out.expectedIntervalUs = QByteArray(value).toDouble(&ok);
+            ok = ok && out.expectedIntervalUs >= 0;
+        } else if ((value = bench::optionValue(arg, "--seed-tasks"))) {
+            out.seedTasks = QByteArray(value).toInt(&ok);
+            ok = ok && out.seedTasks >= 0;
+        } else if ((value = bench::optionValue(arg, "--seed-tags"))) {
+            out.seedTags = QByteArray(value).toInt(&ok);
+            ok = ok && out.seedTags >= 0;
+        } else if ((value = bench::optionValue(arg, "--list-limit"))) {
+            out.listLimit = QByteArray(value).toInt(&ok);
+            ok = ok && out.listLimit > 0;
+        } else if ((value = bench::optionValue(arg, "--seed"))) {
+            out.seed = QByteArray(value).toULongLong(&ok);
+        } else if ((value = bench::optionValue(arg, "--mix"))) {
+            ok = parseMix(QByteArray(value), out.weights);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr,
+                         "usage: %s [--host=H] [--port=P] [--connections=N]\n"
+                         "          [--rate=REQ_PER_SEC (0 = closed loop)] [--duration=S]\n"
+                         "          [--warmup=S] [--expected-interval-us=US]\n"
+                         "          [--seed-tasks=N] [--seed-tags=N] [--list-limit=N] [--seed=N]\n"
+                         "          [--mix=list_tasks:5,get_task:50,create_task:15,"
+                         "patch_task:20,delete_task:5,list_tags:5]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    LoadGen loadgen(std::move(options));
+    QTimer::singleShot(0, &app, [&loadgen] { loadgen.start(); });
+    return app.exec();
+}
@@ -0,0 +1,449 @@
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQueue>
+#include <QTimer>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Bench.hpp"
+#include "LatencyHistogram.hpp"
+#include "LatencyReport.hpp"
+#include "LoadConnection.hpp"
+#include "Logger.hpp"
+#include "TrafficCapture.hpp"
+#include "UuidCodec.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// tasklit_replay: воспроизводит запись TASKLIT_CAPTURE / PUT /admin/capture
+// на свежем экземпляре с исходными интервалами (--speed=1), ускоренно
+// (--speed=N) или без пауз (--speed=0). Сравнивает статусы и отпечатки тел
+// с записанными ответами и распределения латентности по маршрутам.
+//
+// id, выданные сервером при создании, на новом экземпляре другие: пары
+// «исходный → новый» берутся из тел ответов на изменяющие запросы и
+// подставляются в последующие запросы; перед сравнением тел — обратно.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct Options {
+    QString capturePath;
+    QString host = QStringLiteral("127.0.0.1");
+    quint16 port = 8080;
+    int connections = 16;
+    double speed = 1.0;
+    int maxMismatches = 50; // подробностей в отчёте
+};
+
+// Канонические UUID в тексте (путь, query, JSON): позиции и значения
+template <typename Fn>
+void forEachUuidToken(QByteArrayView text, Fn &&fn) {
+    const auto isHex = [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    };
+    qsizetype i = 0;
+    while (i + kUuidTextLength <= text.size()) {
+        if (text[i + 8] == '-' && text[i + 13] == '-' && text[i + 18] == '-' &&
+            text[i + 23] == '-' && (i == 0 || !isHex(text[i - 1]))) {
+            QUuid id;
+            if (parseUuid(text.sliced(i, kUuidTextLength), id)) {
+                fn(i, id);
+                i += kUuidTextLength;
+                continue;
+            }
+        }
+        ++i;
+    }
+}
+
+QByteArray rewriteUuids(QByteArrayView text, const QHash<QUuid, QUuid> &map) {
+    if (map.isEmpty()) {
+        return text.toByteArray();
+    }
+    QByteArray out;
+    out.reserve(text.size());
+    qsizetype copied = 0;
+    char formatted[kUuidTextLength];
+    forEachUuidToken(text, [&](qsizetype pos, const QUuid &id) {
+        const auto it = map.constFind(id);
+        if (it == map.cend()) {
+            return;
+        }
+        out.append(text.sliced(copied, pos - copied));
+        formatUuid(*it, formatted);
+        out.append(formatted, kUuidTextLength);
+        copied = pos + kUuidTextLength;
+    });
+    out.append(text.sliced(copied));
+    return out;
+}
+
+QList<QUuid> uuidTokens(QByteArrayView text) {
+    QList<QUuid> out;
+    forEachUuidToken(text, [&out](qsizetype, const QUuid &id) { out.append(id); });
+    return out;
+}
+
+struct RouteStats {
+    LatencyHistogram original;
+    LatencyHistogram replay;
+    quint64 count = 0;
+    quint64 statusMismatches = 0;
+    quint64 bodyMismatches = 0;
+    quint64 networkErrors = 0;
+};
+
+class Replayer {
+public:
+    explicit Replayer(Options options);
+
+    bool load();
+    void start();
+
+private:
+    void onTick();
+    void issue(int connection, qsizetype index, qint64 scheduledNs);
+    void onResponse(int connection, qsizetype index, int status, const QByteArray &body,
+                    qint64 scheduledNs, qint64 sentNs);
+    void maybeFinish();
+    void finish();
+
+    QByteArray buildRequest(const capture::RequestRecord &record) const;
+    RouteStats &routeStats(const capture::RequestRecord &record);
+
+    Options m_options;
+    QByteArray m_hostHeader;
+    std::vector<std::unique_ptr<LoadConnection>> m_connections;
+    QVector<int> m_idle;
+    int m_inFlight = 0;
+
+    std::vector<capture::RequestRecord> m_requests;
+    QHash<QByteArray, capture::ResponseRecord> m_originals;
+    QHash<QUuid, QUuid> m_forward;  // исходный id → id на новом экземпляре
+    QHash<QUuid, QUuid> m_backward; // обратно — для сравнения тел
+
+    QTimer m_timer;
+    qint64 m_startNs = 0;
+    qsizetype m_nextIndex = 0;
+    QQueue<std::pair<qsizetype, qint64>> m_backlog;
+    bool m_finished = false;
+
+    std::map<QByteArray, std::unique_ptr<RouteStats>> m_routes;
+    LatencyHistogram m_original;
+    LatencyHistogram m_replay;
+    quint64 m_statusMismatches = 0;
+    quint64 m_bodyMismatches = 0;
+    quint64 m_networkErrors = 0;
+    QJsonArray m_mismatches;
+};
+
+Replayer::Replayer(Options options)
+    : m_options(std::move(options)) {
+    m_hostHeader = m_options.host.toLatin1() + ':' + QByteArray::number(m_options.port);
+    for (int i = 0; i < m_options.connections; ++i) {
+        m_connections.push_back(std::make_unique<LoadConnection>(m_options.host, m_options.port));
+        m_idle.append(i);
+    }
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(1);
+    QObject::connect(&m_timer, &QTimer::timeout, &m_timer, [this] { onTick(); });
+}
+
+bool Replayer::load() {
+    capture::Reader reader;
+    if (!reader.open(m_options.capturePath)) {
+        std::fprintf(stderr, "replay: %s is not a Tasklit capture file\n",
+                     qPrintable(m_options.capturePath));
+        return false;
+    }
+
+    capture::RecordType type;
+    capture::RequestRecord request;
+    capture::ResponseRecord response;
+    while (reader.next(type, request, response)) {
+        if (type == capture::RecordType::Request) {
+            m_requests.push_back(std::move(request));
+        } else {
+            m_originals.insert(response.requestId, std::move(response));
+        }
+    }
+    std::stable_sort(m_requests.begin(), m_requests.end(),
+                     [](const capture::RequestRecord &a, const capture::RequestRecord &b) {
+                         return a.offsetNs < b.offsetNs;
+                     });
+
+    std::fprintf(stderr, "replay: %zu requests, %lld recorded responses\n", m_requests.size(),
+                 static_cast<long long>(m_originals.size()));
+    return !m_requests.empty();
+}
+
+void Replayer::start() {
+    m_startNs = nowNs();
+    m_timer.start();
+    onTick();
+}
+
+QByteArray Replayer::buildRequest(const capture::RequestRecord &record) const {
+    const QByteArray target =
+        rewriteUuids(record.path, m_forward) +
+        (record.query.isEmpty() ? QByteArray() : '?' + rewriteUuids(record.query, m_forward));
+    const QByteArray body = rewriteUuids(record.body, m_forward);
+
+    QByteArray out;
+    out.reserve(160 + target.size() + body.size());
+    out.append(toString(record.method)).append(' ').append(target);
+    out.append(" HTTP/1.1\r\nHost: ").append(m_hostHeader).append("\r\n");
+    for (const capture::Header &header : record.headers) {
+        out.append(header.name).append(": ").append(header.value).append("\r\n");
+    }
+    const bool hasBody = !body.isEmpty() ||
+                         record.method == QHttpServerRequest::Method::Post ||
+                         record.method == QHttpServerRequest::Method::Put ||
+                         record.method == QHttpServerRequest::Method::Patch;
+    if (hasBody) {
+        out.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+    }
+    out.append("\r\n").append(body);
+    return out;
+}
+
+RouteStats &Replayer::routeStats(const capture::RequestRecord &record) {
+    const QByteArray key = QByteArray(toString(record.method)) + ' ' + record.path;
+    std::unique_ptr<RouteStats> &stats = m_routes[key];
+    if (!stats) {
+        stats = std::make_unique<RouteStats>();
+    }
+    return *stats;
+}
+
+void Replayer::onTick() {
+    const qint64 now = nowNs();
+    while (m_nextIndex < qsizetype(m_requests.size())) {
+        const quint64 offset = m_requests[std::size_t(m_nextIndex)].offsetNs;
+        const qint64 scheduled =
+            m_options.speed > 0 ? m_startNs + qint64(double(offset) / m_options.speed) : now;
+        if (scheduled > now) {
+            break;
+        }
+        m_backlog.enqueue({m_nextIndex++, scheduled});
+    }
+    while (!m_backlog.isEmpty() && !m_idle.isEmpty()) {
+        const auto [index, scheduled] = m_backlog.dequeue();
+        issue(m_idle.takeLast(), index, scheduled);
+    }
+    maybeFinish();
+}
+
+void Replayer::issue(int connection, qsizetype index, qint64 scheduledNs) {
+    const QByteArray request = buildRequest(m_requests[std::size_t(index)]);
+    const qint64 sentNs = nowNs();
+    ++m_inFlight;
+    m_connections[connection]->send(
+        request, true,
+        [this, connection, index, scheduledNs, sentNs](int status, const QByteArray &body) {
+            onResponse(connection, index, status, body, scheduledNs, sentNs);
+        });
+}
+
+void Replayer::onResponse(int connection, qsizetype index, int status, const QByteArray &body,
+                          qint64 scheduledNs, qint64 sentNs) {
+    const qint64 doneNs = nowNs();
+    --m_inFlight;
+
+    const capture::RequestRecord &request = m_requests[std::size_t(index)];
+    RouteStats &stats = routeStats(request);
+    ++stats.count;
+
+    // Без пауз латентность от отправки; с расписанием — от назначенного
+    // момента (очередь на клиенте тоже задержка)
+    const quint64 latency = quint64(doneNs - (m_options.speed > 0 ? scheduledNs : sentNs));
+    if (status == 0) {
+        ++stats.networkErrors;
+        ++m_networkErrors;
+    } else {
+        stats.replay.record(latency);
+        m_replay.record(latency);
+    }
+
+    const auto original = m_originals.constFind(request.requestId);
+    if (original != m_originals.cend()) {
+        stats.original.record(original->latencyNs);
+        m_original.record(original->latencyNs);
+
+        // Новые id из ответа на изменение сопоставляются с исходными по порядку
+        if (!original->body.isEmpty() && status >= 200 && status < 300) {
+            const QList<QUuid> before = uuidTokens(original->body);
+            const QList<QUuid> after = uuidTokens(body);
+            if (before.size() == after.size()) {
+                for (qsizetype i = 0; i < before.size(); ++i) {
+                    if (before[i] != after[i]) {
+                        m_forward.insert(before[i], after[i]);
+                        m_backward.insert(after[i], before[i]);
+                    }
+                }
+            }
+        }
+
+        const char *mismatch = nullptr;
+        if (status != 0 && status != original->status) {
+            ++stats.statusMismatches;
+            ++m_statusMismatches;
+            mismatch = "status";
+        } else if (status != 0 && original->fingerprint != 0) {
+            const quint64 fingerprint =
+                capture::responseFingerprint(rewriteUuids(body, m_backward));
+            if (fingerprint != original->fingerprint) {
+                ++stats.bodyMismatches;
+                ++m_bodyMismatches;
+                mismatch = "body";
+            }
+        }
+        if (mismatch && m_mismatches.size() < m_options.maxMismatches) {
+            m_mismatches.append(QJsonObject{
+                {"requestId", QString::fromLatin1(request.requestId)},
+                {"route", QString::fromLatin1(toString(request.method)) + u' ' +
+                              QString::fromUtf8(request.path)},
+                {"kind", mismatch},
+                {"originalStatus", original->status},
+                {"replayStatus", status},
+            });
+        }
+    }
+
+    if (!m_backlog.isEmpty()) {
+        const auto [next, scheduled] = m_backlog.dequeue();
+        issue(connection, next, scheduled);
+    } else {
+        m_idle.append(connection);
+    }
+    maybeFinish();
+}
+
+void Replayer::maybeFinish() {
+    if (!m_finished && m_nextIndex == qsizetype(m_requests.size()) && m_backlog.isEmpty() &&
+        m_inFlight == 0) {
+        finish();
+    }
+}
+
+void Replayer::finish() {
+    m_finished = true;
+    m_timer.stop();
+
+    const auto p99DeltaPct = [](const LatencyHistogram::Snapshot &original,
+                                const LatencyHistogram::Snapshot &replay) {
+        const double before = double(original.valueAt(0.99));
+        return before > 0 ? (double(replay.valueAt(0.99)) - before) * 100.0 / before : 0.0;
+    };
+
+    QJsonArray routes;
+    for (const auto &[route, stats] : m_routes) {
+        const auto original = stats->original.snapshot();
+        const auto replay = stats->replay.snapshot();
+        routes.append(QJsonObject{
+            {"route", QString::fromUtf8(route)},
+            {"count", double(stats->count)},
+            {"statusMismatches", double(stats->statusMismatches)},
+            {"bodyMismatches", double(stats->bodyMismatches)},
+            {"networkErrors", double(stats->networkErrors)},
+            {"originalLatencyUs", latencyJson(original)},
+            {"replayLatencyUs", latencyJson(replay)},
+            {"p99DeltaPct", p99DeltaPct(original, replay)},
+        });
+    }
+
+    const auto original = m_original.snapshot();
+    const auto replay = m_replay.snapshot();
+    const double seconds = double(nowNs() - m_startNs) / 1e9;
+    const QJsonObject report{
+        {"capture", m_options.capturePath},
+        {"target", QString::fromLatin1(m_hostHeader)},
+        {"speed", m_options.speed},
+        {"requests", double(m_requests.size())},
+        {"seconds", seconds},
+        {"throughput", double(m_requests.size()) / (seconds > 0 ? seconds : 1e-9)},
+        {"statusMismatches", double(m_statusMismatches)},
+        {"bodyMismatches", double(m_bodyMismatches)},
+        {"networkErrors", double(m_networkErrors)},
+        {"remappedIds", double(m_forward.size())},
+        {"originalLatencyUs", latencyJson(original)},
+        {"replayLatencyUs", latencyJson(replay)},
+        {"p99DeltaPct", p99DeltaPct(original, replay)},
+        {"routes", routes},
+        {"mismatches", m_mismatches},
+    };
+    std::fprintf(stdout, "%s", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    std::fflush(stdout);
+    QCoreApplication::exit(m_statusMismatches == 0 && m_networkErrors == 0 ? 0 : 1);
+}
+
+bool parseOptions(int argc, char *argv[], Options &out) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = nullptr;
+        bool ok = true;
+
+        if ((value = bench::optionValue(arg, "--capture"))) {
+            out.capturePath = QString::fromLocal8Bit(value);
+        } else if ((value = bench::optionValue(arg, "--host"))) {
+            out.host = QString::fromLocal8Bit(value);
+        } else if ((value = bench::optionValue(arg, "--port"))) {
+            out.port = QByteArray(value).toUShort(&ok);
+        } else if ((value = bench::optionValue(arg, "--connections"))) {
+            out.connections = QByteArray(value).toInt(&ok);
+            ok = ok && out.connections > 0;
+        } else if ((value = bench::optionValue(arg, "--speed"))) {
+            out.speed = QByteArray(value).toDouble(&ok);
+            ok = ok && out.speed >= 0;
+        } else if ((value = bench::optionValue(arg, "--max-mismatches"))) {
+            out.maxMismatches = QByteArray(value).toInt(&ok);
+            ok = ok && out.maxMismatches >= 0;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            out.capturePath.clear();
+            break;
+        }
+    }
+
+    if (out.capturePath.isEmpty()) {
+        std::fprintf(stderr,
+                     "usage: %s --capture=<file> [--host=H] [--port=P] [--connections=N]\n"
+                     "          [--speed=1.0 (0 = no pauses)] [--max-mismatches=N]\n",
+                     argv[0]);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    Replayer replayer(std::move(options));
+    if (!replayer.load()) {
+        return 2;
+    }
+    QTimer::singleShot(0, &app, [&replayer] { replayer.start(); });
+    return app.exec();
+}
@@ -0,0 +1,353 @@
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Bench.hpp"
+#include "DatasetGenerator.hpp"
+#include "IStorage.hpp"
+#include "LatencyHistogram.hpp"
+#include "LatencyReport.hpp"
+#include "SQLiteStorageImpl.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// tasklit_storage_bench: пропускная способность и перцентили латентности
+// IStorage на синтетическом датасете. Фазы: insert → (point_read, update,
+// scan) на каждом уровне параллелизма → delete. Результат — JSON в stdout,
+// ход выполнения — в stderr.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Реализация IStorage под бенчмарком. open вызывается в рабочем потоке —
+// экземпляр используется только этим потоком; close — после его удаления.
+struct Backend {
+    QString name;
+    std::function<std::unique_ptr<IStorage>(const QString &connectionName)> open;
+    std::function<void(const QString &connectionName)> close;
+};
+
+Backend sqliteBackend(const QString &dbPath) {
+    return Backend{
+        QStringLiteral("sqlite"),
+        [dbPath](const QString &connectionName) -> std::unique_ptr<IStorage> {
+            return std::make_unique<SQLiteStorage>(dbPath, connectionName);
+        },
+        [](const QString &connectionName) { QSqlDatabase::removeDatabase(connectionName); },
+    };
+}
+
+struct Options {
+    DatasetConfig dataset;
+    QString dbPath;
+    QVector<int> concurrency{1, 2, 4, 8};
+    qint64 opsPerLevel = 20000;
+    int insertBatch = 500;
+    int insertConcurrency = 1;
+    bool verbose = false;
+};
+
+struct PhaseResult {
+    QString phase;
+    int concurrency = 1;
+    quint64 ops = 0;
+    quint64 rows = 0;
+    quint64 errors = 0;
+    double seconds = 0;
+    LatencyHistogram::Snapshot latency;
+};
+
+// Одна операция фазы: opIndex — сквозной номер в пределах фазы.
+// Возвращает число затронутых строк (0 — ошибка).
+using PhaseOp = std::function<quint64(IStorage &, qint64 opIndex,
+                                      DatasetGenerator::Random &random)>;
+
+PhaseResult runPhase(const Backend &backend, const DatasetGenerator &generator,
+                     const QString &phase, int concurrency, qint64 totalOps,
+                     const PhaseOp &op) {
+    auto histogram = std::make_unique<LatencyHistogram>();
+    std::atomic<quint64> rows{0};
+    std::atomic<quint64> errors{0};
+    std::latch ready(concurrency + 1);
+    std::latch start(1);
+
+    std::vector<std::thread> workers;
+    workers.reserve(concurrency);
+    for (int w = 0; w < concurrency; ++w) {
+        workers.emplace_back([&, w] {
+            const QString connection =
+                QStringLiteral("bench-%1-%2-%3").arg(phase).arg(concurrency).arg(w);
+            {
+                std::unique_ptr<IStorage> storage = backend.open(connection);
+                DatasetGenerator::Random random = generator.random(
+                    qHash(phase) ^ (quint64(concurrency) << 32) ^ quint64(w));
+                const qint64 from = totalOps * w / concurrency;
+                const qint64 to = totalOps * (w + 1) / concurrency;
+
+                // Открытие соединения и схема — вне замера
+                ready.count_down();
+                start.wait();
+
+                for (qint64 i = from; i < to; ++i) {
+                    const auto started = Clock::now();
+                    const quint64 touched = op(*storage, i, random);
+                    histogram->record(quint64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                  Clock::now() - started)
+                                                  .count()));
+                    if (touched == 0) {
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    rows.fetch_add(touched, std::memory_order_relaxed);
+                }
+            }
+            backend.close(connection);
+        });
+    }
+
+    ready.arrive_and_wait();
+    const auto started = Clock::now();
+    start.count_down();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    PhaseResult result;
+    result.phase = phase;
+    result.concurrency = concurrency;
+    result.ops = quint64(totalOps);
+    result.rows = rows.load();
+    result.errors = errors.load();
+    result.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    result.latency = histogram->snapshot();
+
+    std::fprintf(stderr, "%-11s c=%-3d ops=%-9lld %.2fs  %.0f ops/s  p99=%.1fus  errors=%llu\n",
+                 qPrintable(phase), concurrency, static_cast<long long>(totalOps),
+                 result.seconds, result.seconds > 0 ? double(totalOps) / result.seconds : 0.0,
+                 double(result.latency.valueAt(0.99)) / 1000.0,
+                 static_cast<unsigned long long>(result.errors));
+    return result;
+}
+
+QJsonObject toJson(const PhaseResult &result) {
+    const double seconds = result.seconds > 0 ? result.seconds : 1e-9;
+    return QJsonObject{
+        {"phase", result.phase},
+        {"concurrency", result.concurrency},
+        {"ops", double(result.ops)},
+        {"rows", double(result.rows)},
+        {"errors", double(result.errors)},
+        {"seconds", result.seconds},
+        {"opsPerSec", double(result.ops) / seconds},
+        {"rowsPerSec", double(result.rows) / seconds},
+        {"latencyUs", latencyJson(result.latency)},
+    };
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Аргументы
+// ─────────────────────────────────────────────────────────────────────────────
+bool parseOptions(int argc, char *argv[], Options &out) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = nullptr;
+        bool ok = true;
+
+        if ((value = bench::optionValue(arg, "--tasks"))) {
+            out.dataset.taskCount = QByteArray(value).toLongLong(&ok);
+            ok = ok && out.dataset.taskCount > 0;
+        } else if ((value = bench::optionValue(arg, "--tags"))) {
+            out.dataset.tagCount = QByteArray(value).toInt(&ok);
+            ok = ok && out.dataset.tagCount >= 0;
+        } else if ((value = bench::optionValue(arg, "--tags-per-task"))) {
+            // N или MIN-MAX
+            const QList<QByteArray> range = QByteArray(value).split('-');
+            bool okMax = true;
+            out.dataset.minTagsPerTask = range.first().toInt(&ok);
+            out.dataset.maxTagsPerTask =
+                range.size() > 1 ? range.at(1).toInt(&okMax) : out.dataset.minTagsPerTask;
+            ok = ok && okMax && range.size() <= 2 && out.dataset.minTagsPerTask >= 0 &&
+                 out.dataset.maxTagsPerTask >= out.dataset.minTagsPerTask;
+        } else if ((value = bench::optionValue(arg, "--seed"))) {
+            out.dataset.seed = QByteArray(value).toULongLong(&ok);
+        } else if ((value = bench::optionValue(arg, "--ids"))) {
+            ok = std::strcmp(value, "v4") == 0 || std::strcmp(value, "v7") == 0;
+            out.dataset.idVersion = value[1] - '0';
+        } else if ((value = bench::optionValue(arg, "--ops"))) {
+            out.opsPerLevel = QByteArray(value).toLongLong(&ok);
+            ok = ok && out.opsPerLevel > 0;
+        } else if ((value = bench::optionValue(arg, "--concurrency"))) {
+            out.concurrency.clear();
+            for (const QByteArray &level : QByteArray(value).split(',')) {
+                const int c = level.toInt(&ok);
+                if (!ok || c < 1) {
+                    ok = false;
+                    break;
+                }
+                out.concurrency.append(c);
+            }
+        } else if ((value = bench::optionValue(arg, "--insert-batch"))) {
+            out.insertBatch = QByteArray(value).toInt(&ok);
+            ok = ok && out.insertBatch > 0;
+        } else if ((value = bench::optionValue(arg, "--insert-concurrency"))) {
+            out.insertConcurrency = QByteArray(value).toInt(&ok);
+            ok = ok && out.insertConcurrency > 0;
+        } else if ((value = bench::optionValue(arg, "--db"))) {
+            out.dbPath = QString::fromLocal8Bit(value);
+        } else if (std::strcmp(arg, "--verbose") == 0) {
+            out.verbose = true;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr,
+                         "usage: %s [--tasks=N] [--tags=N] [--tags-per-task=N|MIN-MAX]\n"
+                         "          [--seed=N] [--ids=v4|v7] [--ops=N] [--concurrency=1,2,4,8]\n"
+                         "          [--insert-batch=N] [--insert-concurrency=N]\n"
+                         "          [--db=<new file>] [--verbose]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    if (!options.verbose) {
+        // Логи хранилища на каждый запрос исказили бы замер
+        QLoggingCategory::setFilterRules(QStringLiteral("tasklit.*=false"));
+    }
+
+    QTemporaryDir scratch;
+    if (options.dbPath.isEmpty()) {
+        options.dbPath = scratch.filePath(QStringLiteral("bench.db"));
+    } else if (QFileInfo::exists(options.dbPath)) {
+        std::fprintf(stderr, "bench: %s already exists, refusing to reuse it\n",
+                     qPrintable(options.dbPath));
+        return 2;
+    }
+
+    const DatasetGenerator generator(options.dataset);
+    const DatasetConfig &dataset = generator.config();
+    const Backend backend = sqliteBackend(options.dbPath);
+    QJsonArray phases;
+
+    // ── Загрузка: теги одним потоком, затем задачи пачками ──────────────────
+    phases.append(toJson(runPhase(
+        backend, generator, QStringLiteral("insert_tag"), 1, dataset.tagCount,
+        [&generator](IStorage &storage, qint64 i, DatasetGenerator::Random &) -> quint64 {
+            return storage.addTag(generator.tag(int(i))).isNull() ? 0 : 1;
+        })));
+
+    const qint64 batch = options.insertBatch;
+    const qint64 insertOps = (dataset.taskCount + batch - 1) / batch;
+    phases.append(toJson(runPhase(
+        backend, generator, QStringLiteral("insert"), options.insertConcurrency, insertOps,
+        [&](IStorage &storage, qint64 i, DatasetGenerator::Random &) -> quint64 {
+            const qint64 from = i * batch;
+            const qint64 to = std::min(dataset.taskCount, from + batch);
+            if (batch == 1) {
+                return storage.addTask(generator.task(from)).isNull() ? 0 : 1;
+            }
+            std::vector<TaskMutation> ops(std::size_t(to - from));
+            for (qint64 k = from; k < to; ++k) {
+                ops[std::size_t(k - from)].task = generator.task(k);
+            }
+            const auto results = storage.applyMutations(ops, true);
+            const bool ok = std::all_of(results.begin(), results.end(),
+                                        [](const TaskMutationResult &r) { return r.ok; });
+            return ok ? quint64(to - from) : 0;
+        })));
+
+    // ── Рабочая нагрузка на каждом уровне параллелизма ──────────────────────
+    for (const int c : options.concurrency) {
+        phases.append(toJson(runPhase(
+            backend, generator, QStringLiteral("point_read"), c, options.opsPerLevel,
+            [&](IStorage &storage, qint64, DatasetGenerator::Random &random) -> quint64 {
+                const qint64 index = qint64(random.below(quint64(dataset.taskCount)));
+                return storage.getTaskById(generator.taskId(index)) ? 1 : 0;
+            })));
+
+        phases.append(toJson(runPhase(
+            backend, generator, QStringLiteral("update"), c, options.opsPerLevel,
+            [&](IStorage &storage, qint64 i, DatasetGenerator::Random &random) -> quint64 {
+                const qint64 index = qint64(random.below(quint64(dataset.taskCount)));
+                TaskPatch patch;
+                patch.title = QStringLiteral("updated %1").arg(i);
+                patch.isCompleted = (i & 1) != 0;
+                return storage.patchTask(generator.taskId(index), patch).ok ? 1 : 0;
+            })));
+
+        // Каждый поток читает всю таблицу один раз
+        phases.append(toJson(runPhase(
+            backend, generator, QStringLiteral("scan"), c, c,
+            [](IStorage &storage, qint64, DatasetGenerator::Random &) -> quint64 {
+                quint64 seen = 0;
+                TaskScan scan;
+                scan.fields = TaskFields::all();
+                storage.forEachTaskBatch(scan, [&seen](const TaskBatch &rows) {
+                    seen += quint64(rows.size());
+                    return true;
+                });
+                return seen;
+            })));
+    }
+
+    // ── Удаление: непересекающиеся диапазоны с конца датасета ───────────────
+    qint64 deleteEnd = dataset.taskCount;
+    for (const int c : options.concurrency) {
+        const qint64 count = std::min(options.opsPerLevel, deleteEnd);
+        if (count == 0) {
+            break;
+        }
+        const qint64 from = deleteEnd - count;
+        phases.append(toJson(runPhase(
+            backend, generator, QStringLiteral("delete"), c, count,
+            [&generator, from](IStorage &storage, qint64 i, DatasetGenerator::Random &) -> quint64 {
+                return storage.deleteTask(generator.taskId(from + i)).ok ? 1 : 0;
+            })));
+        deleteEnd = from;
+    }
+
+    const QJsonObject report{
+        {"backend", backend.name},
+        {"dbPath", options.dbPath},
+        {"dbBytes", double(QFileInfo(options.dbPath).size())},
+        {"dataset",
+         QJsonObject{{"tasks", double(dataset.taskCount)},
+                     {"tags", dataset.tagCount},
+                     {"minTagsPerTask", dataset.minTagsPerTask},
+                     {"maxTagsPerTask", dataset.maxTagsPerTask},
+                     {"titleChars", dataset.titleChars},
+                     {"descriptionChars", dataset.descriptionChars},
+                     {"seed", QString::number(dataset.seed)},
+                     {"idVersion", dataset.idVersion}}},
+        {"insertBatch", options.insertBatch},
+        {"phases", phases},
+    };
+    std::fprintf(stdout, "%s", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    return 0;
+}
@@ -0,0 +1,283 @@
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <algorithm>
+
+#include "Bench.hpp"
+#include "ErrorHandler.hpp"
+#include "JsonUtils.hpp"
+#include "JsonWriter.hpp"
+#include "Logger.hpp"
+#include "Task.hpp"
+#include "TaskBodyDecoder.hpp"
+#include "TaskPatch.hpp"
+#include "UuidCodec.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// tasklit_bench: микробенчмарки горячих путей model/utils.
+// Данные детерминированы (фиксированный seed UUID), так что прогоны разных
+// коммитов сравнимы через --baseline.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+// Типичные формы задач: от заголовка без тегов до длинного описания
+struct TaskShape {
+    const char *label;
+    int titleChars;
+    int descriptionChars;
+    int tagCount;
+};
+
+constexpr TaskShape kShapes[] = {
+    {"small", 16, 0, 0},
+    {"medium", 48, 256, 4},
+    {"large", 96, 4096, 32},
+};
+
+QUuid uuidFor(quint32 seed) {
+    return QUuid(seed, quint16(seed >> 3), quint16(0x4000 | (seed & 0x0fff)), 0x80,
+                 quint8(seed), 1, 2, 3, 4, 5, quint8(seed >> 8));
+}
+
+QString text(int chars, char16_t base) {
+    QString out;
+    out.reserve(chars);
+    for (int i = 0; i < chars; ++i) {
+        // вперемешку ASCII, кириллица и символы, требующие экранирования
+        const int k = i % 37;
+        out.append(k == 0 ? QChar(u'"') : k == 1 ? QChar(u'\n')
+                 : k < 20 ? QChar(char16_t(base + k)) : QChar(char16_t(u'а' + k)));
+    }
+    return out;
+}
+
+Task makeTask(const TaskShape &shape, quint32 seed = 1) {
+    Task task;
+    task.id = uuidFor(seed);
+    task.title = text(shape.titleChars, u'A');
+    task.description = text(shape.descriptionChars, u'a');
+    task.isCompleted = (seed & 1) != 0;
+    for (int i = 0; i < shape.tagCount; ++i) {
+        task.tags.append(uuidFor(seed * 131 + quint32(i) + 7));
+    }
+    return task;
+}
+
+QString shapeParams(const TaskShape &shape) {
+    return QStringLiteral("%1 title=%2 desc=%3 tags=%4")
+        .arg(QLatin1String(shape.label))
+        .arg(shape.titleChars)
+        .arg(shape.descriptionChars)
+        .arg(shape.tagCount);
+}
+
+QJsonObject patchObject(const TaskShape &shape) {
+    QJsonArray tags;
+    for (int i = 0; i < shape.tagCount; ++i) {
+        tags.append(uuidToString(uuidFor(quint32(1000 + i))));
+    }
+    return QJsonObject{{"title", text(shape.titleChars, u'P')},
+                       {"isCompleted", true},
+                       {"tags", tags}};
+}
+
+void benchModel(bench::Runner &runner) {
+    for (const TaskShape &shape : kShapes) {
+        const Task task = makeTask(shape);
+        const QString params = shapeParams(shape);
+        const QJsonObject json = task.toJson();
+
+        runner.run(QStringLiteral("Task::toJson"), params, [&] {
+            bench::doNotOptimize(task.toJson());
+        });
+        runner.run(QStringLiteral("Task::fromJson"), params, [&] {
+            bench::doNotOptimize(Task::fromJson(json));
+        });
+
+        QByteArray buffer;
+        runner.run(QStringLiteral("writeTaskJson"), params, [&] {
+            buffer.resize(0);
+            writeTaskJson(buffer, task);
+            bench::doNotOptimize(buffer);
+        });
+    }
+}
+
+void benchPatch(bench::Runner &runner) {
+    for (const TaskShape &shape : kShapes) {
+        const Task original = makeTask(shape);
+        const QString params = shapeParams(shape);
+        const QJsonObject patchJson = patchObject(shape);
+        const TaskPatch patch = taskPatchFromJson(patchJson);
+
+        runner.run(QStringLiteral("applyTaskPatch(TaskPatch)"), params, [&] {
+            Task task = original;
+            applyTaskPatch(task, patch);
+            bench::doNotOptimize(task);
+        });
+        runner.run(QStringLiteral("applyTaskPatch(QJsonObject)"), params, [&] {
+            Task task = original;
+            applyTaskPatch(task, patchJson);
+            bench::doNotOptimize(task);
+        });
+        runner.run(QStringLiteral("patchedTask"), params, [&] {
+            bench::doNotOptimize(patchedTask(original, patchJson));
+        });
+    }
+}
+
+void benchPaginate(bench::Runner &runner) {
+    for (const int total : {100, 1000, 10000}) {
+        QJsonArray data;
+        for (int i = 0; i < total; ++i) {
+            data.append(makeTask(kShapes[1], quint32(i)).toJson());
+        }
+        for (const int perPage : {20, 100}) {
+            const qsizetype middlePage = std::max(1, total / perPage / 2);
+            runner.run(QStringLiteral("paginate"),
+                       QStringLiteral("total=%1 per_page=%2").arg(total).arg(perPage),
+                       [&] { bench::doNotOptimize(paginate(data, middlePage, perPage)); });
+        }
+    }
+}
+
+// parseBodyObject принимает QHttpServerRequest, у которого нет публичного
+// конструктора, поэтому меряется его ядро — QJsonDocument::fromJson тела
+// (под этим именем) — рядом с однопроходным decodeTaskCreate на том же теле
+void benchBodyParsing(bench::Runner &runner) {
+    for (const TaskShape &shape : kShapes) {
+        const QByteArray body =
+            QJsonDocument(makeTask(shape).toJson()).toJson(QJsonDocument::Compact);
+        const QString params = shapeParams(shape) +
+                               QStringLiteral(" bytes=%1").arg(body.size());
+
+        runner.run(QStringLiteral("QJsonDocument::fromJson"), params, [&] {
+            QJsonParseError error{};
+            const QJsonDocument doc = QJsonDocument::fromJson(body, &error);
+            bench::doNotOptimize(doc.isObject() ? doc.object() : QJsonObject());
+        });
+        runner.run(QStringLiteral("decodeTaskCreate"), params, [&] {
+            bench::doNotOptimize(decodeTaskCreate(body));
+        });
+    }
+}
+
+void benchUuid(bench::Runner &runner) {
+    const QUuid id = uuidFor(0xdeadbeef);
+    const QString canonical = id.toString(QUuid::WithoutBraces);
+    const QString braces = id.toString(QUuid::WithBraces);
+    const QString compact = id.toString(QUuid::Id128);
+
+    QUuid parsed;
+    runner.run(QStringLiteral("parseUuid"), QStringLiteral("form=canonical"), [&] {
+        parseUuid(QStringView(canonical), parsed);
+        bench::doNotOptimize(parsed);
+    });
+    runner.run(QStringLiteral("parseUuid"), QStringLiteral("form=braces"), [&] {
+        parseUuid(QStringView(braces), parsed);
+        bench::doNotOptimize(parsed);
+    });
+    runner.run(QStringLiteral("parseUuid"), QStringLiteral("form=id128"), [&] {
+        parseUuid(QStringView(compact), parsed);
+        bench::doNotOptimize(parsed);
+    });
+    runner.run(QStringLiteral("QUuid::fromString"), QStringLiteral("form=canonical"), [&] {
+        bench::doNotOptimize(QUuid::fromString(canonical));
+    });
+    runner.run(QStringLiteral("createUuidV7"), QString(), [&] {
+        bench::doNotOptimize(createUuidV7());
+    });
+    runner.run(QStringLiteral("QUuid::createUuid"), QString(), [&] {
+        bench::doNotOptimize(QUuid::createUuid());
+    });
+
+    for (const int count : {4, 32}) {
+        QStringList parts;
+        for (int i = 0; i < count; ++i) {
+            parts.append(uuidToString(uuidFor(quint32(i))));
+        }
+        const QString list = parts.join(u',');
+        QVector<QUuid> out;
+        runner.run(QStringLiteral("parseUuidList"), QStringLiteral("tags=%1").arg(count), [&] {
+            out.resize(0);
+            parseUuidList(list, u',', out);
+            bench::doNotOptimize(out);
+        });
+    }
+}
+
+void benchEnvelope(bench::Runner &runner) {
+    const QString requestId = QStringLiteral("0123abcd-0001-000000000001");
+    for (const TaskShape &shape : kShapes) {
+        const Task task = makeTask(shape);
+        const QString params = shapeParams(shape);
+        const QJsonObject data = task.toJson();
+
+        runner.run(QStringLiteral("makeApiOk"), params, [&] {
+            bench::doNotOptimize(makeApiOk(QStringLiteral("Task fetched"), data, requestId));
+        });
+
+        QByteArray json;
+        runner.run(QStringLiteral("makeApiOkRaw"), params, [&] {
+            json.resize(0);
+            writeTaskJson(json, task);
+            bench::doNotOptimize(makeApiOkRaw(QStringLiteral("Task fetched"), json, requestId));
+        });
+    }
+}
+
+// Обработчик логов ставится последним: после initLogging весь qDebug
+// процесса идёт через асинхронное кольцо (и в stderr фоновым потоком).
+// Мерится стоимость на потоке запроса — форматирование и постановка в кольцо.
+void benchLogger(bench::Runner &runner, const QString &logPath) {
+    if (!runner.selected(QStringLiteral("logger.qInfo")) &&
+        !runner.selected(QStringLiteral("logger.disabledCategory"))) {
+        return;
+    }
+
+    initLogging(logPath);
+    const QString requestId = QStringLiteral("0123abcd-0001-000000000001");
+    for (const int payload : {16, 256}) {
+        const QString message = text(payload, u'L');
+        runner.run(QStringLiteral("logger.qInfo"), QStringLiteral("chars=%1").arg(payload), [&] {
+            qInfo(appHttp) << "[GET] /task" << message << "| requestId=" << requestId;
+        });
+    }
+    runner.run(QStringLiteral("logger.disabledCategory"), QString(), [&] {
+        qDebug(appSql) << "filtered out" << requestId;
+    });
+    shutdownLogging();
+
+    std::fprintf(stderr, "bench: logger dropped %llu records under load\n",
+                 static_cast<unsigned long long>(droppedLogRecords()));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    bench::Options options;
+    if (!bench::parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    QTemporaryDir scratch;
+    bench::Runner runner(options);
+
+    benchModel(runner);
+    benchPatch(runner);
+    benchPaginate(runner);
+    benchBodyParsing(runner);
+    benchUuid(runner);
+    benchEnvelope(runner);
+
+    QLoggingCategory::setFilterRules(QStringLiteral("tasklit.sql.debug=false"));
+    benchLogger(runner, scratch.filePath(QStringLiteral("bench.log")));
+
+    return 0;
+}
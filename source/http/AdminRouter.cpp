@@ -0,0 +1,140 @@
+#include <QUrlQuery>
+#include <QtHttpServer/QHttpServerRequest>
+#include <QtHttpServer/QHttpServerResponse>
+
+#include "AdminRouter.hpp"
+#include "ErrorHandler.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Tracing.hpp"
+#include "TrafficCapture.hpp"
+
+void AdminRouter::registerRoutes(QHttpServer &server) {
+    // ─────────────────────────────────────────────────────────────────────────────
+    // GET /metrics  (Prometheus text format)
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/metrics", QHttpServerRequest::Method::Get,
+        wrapSafe("GET /metrics",
+                 [](const QString &) {
+                     return QHttpServerResponse(
+                         "text/plain; version=0.0.4; charset=utf-8",
+                         metrics::renderPrometheus());
+                 }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // GET /admin/traces  (Chrome trace-event JSON: chrome://tracing, Perfetto)
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/admin/traces", QHttpServerRequest::Method::Get,
+        wrapSafe("GET /admin/traces",
+                 [](const QString &) {
+                     QHttpServerResponse response("application/json",
+                                                  tracing::exportChromeTrace());
+                     QHttpHeaders headers = response.headers();
+                     headers.append(QHttpHeaders::WellKnownHeader::ContentDisposition,
+                                    "attachment; filename=\"tasklit-trace.json\"");
+                     response.setHeaders(std::move(headers));
+                     return response;
+                 }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // PUT /admin/traces?sample=<0..1>  — доля сэмплируемых запросов
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/admin/traces", QHttpServerRequest::Method::Put,
+        wrapSafe("PUT /admin/traces",
+                 [](const QHttpServerRequest &request, const QString &requestId) {
+                     const QString raw =
+                         QUrlQuery(request.url()).queryItemValue("sample");
+                     bool ok = false;
+                     const double rate = raw.toDouble(&ok);
+                     if (!ok || rate < 0.0 || rate > 1.0) {
+                         return makeApiError(
+                             QHttpServerResponse::StatusCode::BadRequest,
+                             "Query parameter 'sample' must be a number in [0, 1]",
+                             "bad_request", {}, requestId);
+                     }
+
+                     tracing::setSampleRate(rate);
+                     qInfo(appHttp) << "[ADMIN] trace sample rate set to" << rate;
+                     return makeApiOk("Trace sampling updated",
+                                      QJsonObject{{"sample", tracing::sampleRate()},
+                                                  {"stored", tracing::storedTraceCount()}},
+                                      requestId);
+                 }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // DELETE /admin/traces
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/admin/traces", QHttpServerRequest::Method::Delete,
+        wrapSafe("DELETE /admin/traces",
+                 [](const QString &requestId) {
+                     tracing::clearTraces();
+                     return makeApiOk("Traces cleared", {}, requestId);
+                 }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // GET /admin/capture  — состояние записи трафика
+    // ─────────────────────────────────────────────────────────────────────────────
+    const auto captureStatusJson = [] {
+        const capture::Status status = capture::status();
+        return QJsonObject{{"active", status.active},
+                           {"file", status.path},
+                           {"requests", double(status.requests)},
+                           {"responses", double(status.responses)},
+                           {"bytes", double(status.bytes)}};
+    };
+
+    mirrorRoute(
+        server, "/admin/capture", QHttpServerRequest::Method::Get,
+        wrapSafe("GET /admin/capture",
+                 [captureStatusJson](const QString &requestId) {
+                     return makeApiOk("Capture status", captureStatusJson(), requestId);
+                 }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // PUT /admin/capture?file=<name>.tlcap  — начать запись в новый файл
+    // каталога записей
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/admin/capture", QHttpServerRequest::Method::Put,
+        wrapSafe("PUT /admin/capture",
+                 [captureStatusJson](const QHttpServerRequest &request,
+                                     const QString &requestId) {
+                     const QString file = QUrlQuery(request.url()).queryItemValue("file");
+
+                     switch (capture::start(file)) {
+                     case capture::StartResult::Started:
+                         break;
+                     case capture::StartResult::InvalidName:
+                         return makeApiError(
+                             QHttpServerResponse::StatusCode::BadRequest,
+                             "Query parameter 'file' must be a plain file name ending in .tlcap",
+                             "bad_request", {}, requestId);
+                     case capture::StartResult::Exists:
+                         return makeApiError(
+                             QHttpServerResponse::StatusCode::Conflict,
+                             "Capture file already exists", "conflict",
+                             QJsonObject{{"file", file}}, requestId);
+                     case capture::StartResult::Failed:
+                         return makeApiError(
+                             QHttpServerResponse::StatusCode::InternalServerError,
+                             "Cannot open capture file", "internal_error",
+                             QJsonObject{{"file", file}}, requestId);
+                     }
+                     return makeApiOk("Capture started", captureStatusJson(), requestId);
+                 }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // DELETE /admin/capture  — остановить запись (файл остаётся)
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/admin/capture", QHttpServerRequest::Method::Delete,
+        wrapSafe("DELETE /admin/capture",
+                 [captureStatusJson](const QString &requestId) {
+                     capture::stop();
+                     return makeApiOk("Capture stopped", captureStatusJson(), requestId);
+                 }));
+}
@@ -0,0 +1,12 @@
+#ifndef TASKLIT_HTTP_ADMINROUTER_HPP
+#define TASKLIT_HTTP_ADMINROUTER_HPP
+
+#include "IRouter.hpp"
+
+// Служебные маршруты: метрики и диагностика
+class AdminRouter : public IRouter {
+public:
+    void registerRoutes(QHttpServer &server) override;
+};
+
+#endif // TASKLIT_HTTP_ADMINROUTER_HPP
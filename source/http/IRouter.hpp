@@ -1,7 +1,19 @@
 #ifndef TASKLIT_HTTP_IROUTER_HPP
 #define TASKLIT_HTTP_IROUTER_HPP
 
+#include <QString>
 #include <QtHttpServer/QHttpServer>
+#include <QtHttpServer/QHttpServerRequest>
+
+#include <utility>
+
+// Шаблон пути Qt — регулярное выражение (^…$), поэтому одно правило
+// с хвостом "/?" обслуживает и "/path", и "/path/"
+template <typename Handler>
+void mirrorRoute(QHttpServer &server, const char *path, QHttpServerRequest::Method method,
+                 Handler handler) {
+    server.route(QString::fromLatin1(path) + QStringLiteral("/?"), method, std::move(handler));
+}
 
 class IRouter {
 public:
@@ -0,0 +1,129 @@
+#include <QTcpServer>
+
+#include <algorithm>
+
+#include "Logger.hpp"
+#include "StreamPump.hpp"
+
+namespace {
+
+// Проверка зависших клиентов, пока есть незавершённые ответы
+constexpr int kStallCheckIntervalMs = 5000;
+
+} // namespace
+
+QTcpSocket *findClientSocket(QAbstractHttpServer *server, const QHttpServerRequest &request) {
+    if (!server) {
+        return nullptr;
+    }
+    for (QTcpServer *tcpServer : server->servers()) {
+        const auto sockets = tcpServer->findChildren<QTcpSocket *>(Qt::FindDirectChildrenOnly);
+        for (QTcpSocket *socket : sockets) {
+            if (socket->peerPort() == request.remotePort() &&
+                socket->peerAddress() == request.remoteAddress()) {
+                return socket;
+            }
+        }
+    }
+    return nullptr;
+}
+
+StreamPump::StreamPump(QAbstractHttpServer *server, QObject *parent)
+    : QObject(parent), m_server(server) {
+    m_clock.start();
+
+    m_stallCheck.setInterval(kStallCheckIntervalMs);
+    connect(&m_stallCheck, &QTimer::timeout, this, [this]() { pump(); });
+}
+
+StreamPump::~StreamPump() {
+    // Незавершённые ответы обрываются в ~ChunkedResponse
+    for (Job &job : m_jobs) {
+        QObject::disconnect(job.drained);
+    }
+}
+
+void StreamPump::adopt(const QHttpServerRequest &request, ChunkedResponse &stream,
+                       Step step) {
+    Job job;
+    job.stream = stream.detach();
+    job.socket = findClientSocket(m_server, request);
+    job.step = std::move(step);
+    if (job.socket) {
+        // Сокет разгрузился — можно писать следующую часть
+        job.drained = connect(job.socket, &QTcpSocket::bytesWritten, this,
+                              [this]() { schedule(); });
+    } else {
+        qWarning(appHttp) << "[STREAM] socket not found, no backpressure for"
+                          << request.remoteAddress().toString() << request.remotePort();
+    }
+
+    m_jobs.push_back(std::move(job));
+    if (!m_stallCheck.isActive()) {
+        m_stallCheck.start();
+    }
+    schedule();
+}
+
+StreamPump::Writable StreamPump::checkWritable(Job &job) {
+    if (!job.socket || job.socket->bytesToWrite() <= kMaxQueuedBytes) {
+        job.stalledSinceMs = -1;
+        return Writable::Yes;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    if (job.stalledSinceMs < 0) {
+        job.stalledSinceMs = now;
+    } else if (now - job.stalledSinceMs > kMaxStallMs) {
+        qWarning(appHttp) << "[STREAM] client stalled, disconnecting"
+                          << "| queuedBytes=" << job.socket->bytesToWrite();
+        job.socket->abort();
+        return Writable::Drop;
+    }
+    return Writable::Stalled;
+}
+
+void StreamPump::schedule() {
+    if (m_scheduled) {
+        return;
+    }
+    m_scheduled = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_scheduled = false;
+        pump();
+    }, Qt::QueuedConnection);
+}
+
+// Одна часть каждому клиенту, сокет которого не переполнен
+void StreamPump::pump() {
+    bool hasMore = false;
+    const auto done = std::remove_if(m_jobs.begin(), m_jobs.end(), [this, &hasMore](Job &job) {
+        if (job.stream->finished() || job.stream->canceled()) {
+            return true;
+        }
+        switch (checkWritable(job)) {
+        case Writable::Drop:
+            return true;
+        case Writable::Stalled:
+            return false; // продолжим по bytesWritten
+        case Writable::Yes:
+            break;
+        }
+        if (!job.step(*job.stream)) {
+            return true;
+        }
+        hasMore = true;
+        return false;
+    });
+    for (auto it = done; it != m_jobs.end(); ++it) {
+        QObject::disconnect(it->drained);
+    }
+    m_jobs.erase(done, m_jobs.end());
+
+    if (m_jobs.empty()) {
+        m_stallCheck.stop();
+    }
+    if (hasMore) {
+        schedule();
+    }
+}
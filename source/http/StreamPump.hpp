@@ -0,0 +1,66 @@
+#ifndef TASKLIT_HTTP_STREAMPUMP_HPP
+#define TASKLIT_HTTP_STREAMPUMP_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtHttpServer/QAbstractHttpServer>
+#include <QtHttpServer/QHttpServerRequest>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ChunkedResponse.hpp"
+
+// Сокет соединения запроса: дочерний объект QTcpServer с тем же адресом и
+// портом клиента (responder его не отдаёт). nullptr — не найден
+QTcpSocket *findClientSocket(QAbstractHttpServer *server, const QHttpServerRequest &request);
+
+// Дописывает большие потоковые ответы по частям. Обработчик маршрута пишет
+// первую часть сам и отдаёт ответ сюда вместе с step: дальше step вызывается
+// не чаще раза за цикл событий, и только пока в сокете клиента ждут отправки
+// не больше kMaxQueuedBytes. Иначе продолжение — по bytesWritten, так что
+// в памяти процесса одновременно лежит не больше порога и одной части.
+// Не разгрузившийся за kMaxStallMs клиент отключается.
+class StreamPump : public QObject {
+public:
+    static constexpr qint64 kMaxQueuedBytes = 256 * 1024;
+    static constexpr qint64 kMaxStallMs = 60000;
+
+    // Пишет следующую часть; false — ответ завершён (finish или fail)
+    using Step = std::function<bool(ChunkedResponse &)>;
+
+    explicit StreamPump(QAbstractHttpServer *server, QObject *parent = nullptr);
+    ~StreamPump() override;
+
+    // stream отсоединяется (detach) и после возврата из обработчика не пишет
+    void adopt(const QHttpServerRequest &request, ChunkedResponse &stream, Step step);
+
+    qsizetype activeCount() const { return static_cast<qsizetype>(m_jobs.size()); }
+
+private:
+    struct Job {
+        std::unique_ptr<ChunkedResponse> stream;
+        QPointer<QTcpSocket> socket; // null — сокет не найден, очередь не учитывается
+        Step step;
+        QMetaObject::Connection drained; // bytesWritten сокета
+        qint64 stalledSinceMs = -1;
+    };
+
+    enum class Writable { Yes, Stalled, Drop };
+
+    Writable checkWritable(Job &job);
+    void schedule();
+    void pump();
+
+    QAbstractHttpServer *m_server = nullptr;
+    std::vector<Job> m_jobs;
+    QTimer m_stallCheck;
+    QElapsedTimer m_clock;
+    bool m_scheduled = false;
+};
+
+#endif // TASKLIT_HTTP_STREAMPUMP_HPP
@@ -0,0 +1,206 @@
+#include <QUrlQuery>
+#include <QtNetwork/QHttpHeaders>
+
+#include <algorithm>
+#include <optional>
+
+#include "Logger.hpp"
+#include "StreamPump.hpp"
+#include "TaskEventStream.hpp"
+
+namespace {
+
+constexpr qsizetype kMaxBytesPerFlush = 64 * 1024;
+constexpr int kHeartbeatIntervalMs = 15000;
+
+const QByteArray kResetFrame = QByteArrayLiteral(
+    "event: reset\ndata: {\"type\":\"reset\",\"reason\":\"events_lost\"}\n\n");
+
+// Last-Event-ID (заголовок при переподключении EventSource) или ?lastEventId=
+QByteArray lastEventId(const QHttpServerRequest &request) {
+    QByteArray raw = request.headers().value("Last-Event-ID").toByteArray().trimmed();
+    if (raw.isEmpty()) {
+        raw = QUrlQuery(request.url()).queryItemValue("lastEventId").toLatin1();
+    }
+    return raw;
+}
+
+} // namespace
+
+TaskEventStream::TaskEventStream(TaskChangeFeed &feed, QAbstractHttpServer *server,
+                                 QObject *parent)
+    : QObject(parent), m_feed(feed), m_server(server) {
+    m_feed.setListener([this]() { scheduleFlush(); });
+    m_clock.start();
+
+    m_heartbeat.setInterval(kHeartbeatIntervalMs);
+    connect(&m_heartbeat, &QTimer::timeout, this, [this]() { sendHeartbeat(); });
+    m_heartbeat.start();
+}
+
+TaskEventStream::~TaskEventStream() {
+    m_feed.setListener({});
+    for (Subscriber &subscriber : m_subscribers) {
+        if (!subscriber.responder->isResponseCanceled()) {
+            subscriber.responder->writeEndChunked(QByteArray());
+        }
+    }
+}
+
+bool TaskEventStream::subscribe(const QHttpServerRequest &request,
+                                QHttpServerResponder &responder,
+                                const QString &requestId) {
+    if (subscriberCount() >= kMaxSubscribers) {
+        return false;
+    }
+
+    const quint64 head = m_feed.lastId();
+    const QByteArray rawResumeFrom = lastEventId(request);
+    const std::optional<quint64> resumeFrom = m_feed.parseEventId(rawResumeFrom);
+
+    Subscriber subscriber;
+    subscriber.responder = std::make_unique<QHttpServerResponder>(std::move(responder));
+    subscriber.socket = findClientSocket(m_server, request);
+    subscriber.requestId = requestId;
+    if (!subscriber.socket) {
+        qWarning(appHttp) << "[SSE] socket not found, no backpressure for"
+                          << request.remoteAddress().toString() << request.remotePort();
+    } else {
+        // Сокет разгрузился — продолжить рассылку тем, кто ждал
+        connect(subscriber.socket, &QTcpSocket::bytesWritten, this, [this]() {
+            if (m_anyStalled) {
+                scheduleFlush();
+            }
+        });
+    }
+
+    QHttpHeaders headers;
+    headers.append(QHttpHeaders::WellKnownHeader::ContentType, "text/event-stream");
+    headers.append(QHttpHeaders::WellKnownHeader::CacheControl, "no-cache");
+    headers.append("X-Accel-Buffering", "no");
+    subscriber.responder->writeBeginChunked(headers);
+
+    QByteArray hello = QByteArrayLiteral("retry: 3000\n\n");
+    if (resumeFrom && *resumeFrom <= head) {
+        subscriber.cursor = *resumeFrom;
+    } else {
+        // Без Last-Event-ID — только новые события; id другой эпохи
+        // (перезапуск сервера) или из будущего — клиенту нужно перечитать
+        // состояние
+        if (!rawResumeFrom.isEmpty()) {
+            hello.append(kResetFrame);
+        }
+        subscriber.cursor = head;
+    }
+    subscriber.responder->writeChunk(hello);
+
+    qInfo(appHttp) << "[SSE] subscribed"
+                   << "| requestId=" << requestId
+                   << "| cursor=" << subscriber.cursor
+                   << "| subscribers=" << subscriberCount() + 1;
+
+    const bool replay = subscriber.cursor < head;
+    m_subscribers.push_back(std::move(subscriber));
+    if (replay) {
+        scheduleFlush();
+    }
+    return true;
+}
+
+TaskEventStream::Writable TaskEventStream::checkWritable(Subscriber &subscriber) {
+    if (!subscriber.socket || subscriber.socket->bytesToWrite() <= kMaxQueuedBytes) {
+        subscriber.stalledSinceMs = -1;
+        return Writable::Yes;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    if (subscriber.stalledSinceMs < 0) {
+        subscriber.stalledSinceMs = now;
+    } else if (now - subscriber.stalledSinceMs > kMaxStallMs) {
+        qWarning(appHttp) << "[SSE] subscriber stalled, disconnecting"
+                          << "| requestId=" << subscriber.requestId
+                          << "| queuedBytes=" << subscriber.socket->bytesToWrite();
+        subscriber.socket->abort();
+        return Writable::Drop;
+    }
+    m_anyStalled = true;
+    return Writable::Stalled;
+}
+
+void TaskEventStream::scheduleFlush() {
+    if (m_flushScheduled) {
+        return;
+    }
+    m_flushScheduled = true;
+    QMetaObject::invokeMethod(this, [this]() { flush(); }, Qt::QueuedConnection);
+}
+
+// true — подписчик жив; hasMore — остались непрочитанные события
+bool TaskEventStream::deliver(Subscriber &subscriber, bool &hasMore) {
+    if (subscriber.responder->isResponseCanceled()) {
+        return false;
+    }
+    switch (checkWritable(subscriber)) {
+    case Writable::Drop:
+        return false;
+    case Writable::Stalled:
+        return true; // продолжим по bytesWritten, без повторной рассылки впустую
+    case Writable::Yes:
+        break;
+    }
+
+    QByteArray chunk;
+    quint64 lastRead = subscriber.cursor;
+    if (!m_feed.readSince(subscriber.cursor, kMaxBytesPerFlush, chunk, lastRead)) {
+        qWarning(appHttp) << "[SSE] subscriber fell behind, sending reset"
+                          << "| requestId=" << subscriber.requestId;
+        subscriber.responder->writeChunk(kResetFrame);
+        subscriber.cursor = m_feed.lastId();
+        return true;
+    }
+
+    if (!chunk.isEmpty()) {
+        subscriber.responder->writeChunk(chunk);
+        subscriber.cursor = lastRead;
+    }
+    hasMore = hasMore || subscriber.cursor < m_feed.lastId();
+    return true;
+}
+
+void TaskEventStream::flush() {
+    m_flushScheduled = false;
+    m_anyStalled = false;
+
+    bool hasMore = false;
+    const auto dead = std::remove_if(
+        m_subscribers.begin(), m_subscribers.end(),
+        [this, &hasMore](Subscriber &subscriber) { return !deliver(subscriber, hasMore); });
+    const auto dropped = std::distance(dead, m_subscribers.end());
+    m_subscribers.erase(dead, m_subscribers.end());
+
+    if (dropped > 0) {
+        qInfo(appHttp) << "[SSE] dropped" << dropped << "closed subscribers"
+                       << "| subscribers=" << subscriberCount();
+    }
+    if (hasMore) {
+        scheduleFlush();
+    }
+}
+
+void TaskEventStream::sendHeartbeat() {
+    static const QByteArray ping = QByteArrayLiteral(": ping\n\n");
+    m_anyStalled = false;
+    const auto dead = std::remove_if(
+        m_subscribers.begin(), m_subscribers.end(), [this](Subscriber &subscriber) {
+            if (subscriber.responder->isResponseCanceled()) {
+                return true;
+            }
+            // Ждущему разгрузки ping не нужен: соединение и так занято данными
+            const Writable writable = checkWritable(subscriber);
+            if (writable == Writable::Yes) {
+                subscriber.responder->writeChunk(ping);
+            }
+            return writable == Writable::Drop;
+        });
+    m_subscribers.erase(dead, m_subscribers.end());
+}
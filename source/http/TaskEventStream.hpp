@@ -0,0 +1,72 @@
+#ifndef TASKLIT_HTTP_TASKEVENTSTREAM_HPP
+#define TASKLIT_HTTP_TASKEVENTSTREAM_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtHttpServer/QAbstractHttpServer>
+#include <QtHttpServer/QHttpServerRequest>
+#include <QtHttpServer/QHttpServerResponder>
+
+#include <memory>
+#include <vector>
+
+#include "TaskChangeFeed.hpp"
+
+// Подписчики GET /tasks/stream (Server-Sent Events). Держит responder'ы
+// открытых соединений и рассылает им кадры из TaskChangeFeed: после
+// публикации — одна отложенная рассылка на цикл событий, каждому не больше
+// kMaxBytesPerFlush за проход (остаток — на следующем). Отставший дальше
+// кольца ленты подписчик получает событие "reset" и продолжает с головы.
+//
+// Обратное давление: пока в сокете подписчика ждут отправки больше
+// kMaxQueuedBytes, ему ничего не пишется — рассылка продолжится по
+// bytesWritten. Не разгрузившийся за kMaxStallMs подписчик отключается.
+class TaskEventStream : public QObject {
+public:
+    static constexpr qsizetype kMaxSubscribers = 10000;
+    static constexpr qint64 kMaxQueuedBytes = 256 * 1024;
+    static constexpr qint64 kMaxStallMs = 60000;
+
+    // server — для поиска сокета подписчика (responder его не отдаёт)
+    TaskEventStream(TaskChangeFeed &feed, QAbstractHttpServer *server,
+                    QObject *parent = nullptr);
+    ~TaskEventStream() override;
+
+    // false — достигнут лимит подписчиков, responder не тронут
+    bool subscribe(const QHttpServerRequest &request, QHttpServerResponder &responder,
+                   const QString &requestId);
+
+    qsizetype subscriberCount() const {
+        return static_cast<qsizetype>(m_subscribers.size());
+    }
+
+private:
+    struct Subscriber {
+        std::unique_ptr<QHttpServerResponder> responder;
+        QPointer<QTcpSocket> socket; // null — сокет не найден, очередь не учитывается
+        quint64 cursor = 0;
+        QString requestId;
+        qint64 stalledSinceMs = -1; // -1 — очередь сокета в пределах бюджета
+    };
+
+    enum class Writable { Yes, Stalled, Drop };
+
+    Writable checkWritable(Subscriber &subscriber);
+    void scheduleFlush();
+    void flush();
+    void sendHeartbeat();
+    bool deliver(Subscriber &subscriber, bool &hasMore);
+
+    TaskChangeFeed &m_feed;
+    QAbstractHttpServer *m_server = nullptr;
+    std::vector<Subscriber> m_subscribers;
+    QTimer m_heartbeat;
+    QElapsedTimer m_clock;
+    bool m_flushScheduled = false;
+    bool m_anyStalled = false;
+};
+
+#endif // TASKLIT_HTTP_TASKEVENTSTREAM_HPP
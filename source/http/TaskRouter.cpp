@@ -1,3 +1,4 @@
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -5,28 +6,382 @@
 #include <QUrlQuery>
 #include <QtHttpServer/QHttpServerRequest>
 #include <QtHttpServer/QHttpServerResponse>
+#include <algorithm>
 
+#include "ChunkedResponse.hpp"
 #include "ErrorHandler.hpp"
 #include "JsonUtils.hpp"
+#include "JsonWriter.hpp"
 #include "Logger.hpp"
 #include "Tag.hpp"
 #include "Task.hpp"
+#include "TaskBodyDecoder.hpp"
 #include "TaskPatch.hpp"
 #include "TaskRouter.hpp"
+#include "Tracing.hpp"
+#include "UuidCodec.hpp"
 
 TaskRouter::TaskRouter(std::shared_ptr<ITaskService> service)
     : m_service(std::move(service)) {}
 
-static QUuid parseUuidLoose(const QString &string) {
-    QUuid id = QUuid::fromString(string);
-    if (!id.isNull()) {
-        return id;
+// Максимальный размер страницы GET /tasks?limit=
+static constexpr qlonglong kMaxPageLimit = 10000;
+
+// Строк задач в одной части потокового списка: следующая часть — новый
+// keyset-запрос на следующем обороте цикла событий (StreamPump)
+static constexpr qsizetype kTaskRowsPerStep = 2048;
+
+// GET /tags/suggest?limit=: по умолчанию и максимум
+static constexpr qlonglong kDefaultSuggestLimit = 10;
+static constexpr qlonglong kMaxSuggestLimit = 50;
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Курсор keyset-страницы: ключ сортировки последней строки.
+//   порядок вставки — rowid; по id и для GET /tag/tasks — id задачи;
+//   по title — base64url(title) + "." + rowid.
+// ─────────────────────────────────────────────────────────────────────────────
+static bool usesIdCursor(const TaskScan &scan) {
+    return !scan.tagId.isNull() || scan.sort == TaskSort::IdAsc ||
+           scan.sort == TaskSort::IdDesc;
+}
+
+static bool usesTitleCursor(const TaskScan &scan) {
+    return scan.tagId.isNull() &&
+           (scan.sort == TaskSort::TitleAsc || scan.sort == TaskSort::TitleDesc);
+}
+
+static void writeTaskCursor(QByteArray &out, const TaskScan &scan, const TaskBatch &batch,
+                            qsizetype row) {
+    if (usesIdCursor(scan)) {
+        char id[kUuidTextLength];
+        formatUuid(batch.id(row), id);
+        out.append(id, kUuidTextLength);
+    } else if (usesTitleCursor(scan)) {
+        out.append(batch.title(row).toUtf8().toBase64(QByteArray::Base64UrlEncoding |
+                                                       QByteArray::OmitTrailingEquals));
+        out.append('.');
+        out.append(QByteArray::number(batch.rowIds[row]));
+    } else {
+        out.append(QByteArray::number(batch.rowIds[row]));
+    }
+}
+
+// Курсор scan за строку row — то же, что parseTaskCursor(writeTaskCursor(…))
+static void advanceTaskScan(TaskScan &scan, const TaskBatch &batch, qsizetype row) {
+    if (usesIdCursor(scan)) {
+        scan.afterTaskId = batch.id(row);
+    } else if (usesTitleCursor(scan)) {
+        scan.afterTitle = batch.title(row).toString();
+        scan.afterRowId = batch.rowIds[row];
+    } else {
+        scan.afterRowId = batch.rowIds[row];
+    }
+}
+
+static bool parseTaskCursor(const QString &cursor, TaskScan &scan) {
+    if (usesIdCursor(scan)) {
+        scan.afterTaskId = parseUuid(cursor);
+        return !scan.afterTaskId.isNull();
+    }
+
+    bool ok = false;
+    if (usesTitleCursor(scan)) {
+        const qsizetype dot = cursor.lastIndexOf(u'.');
+        if (dot < 0) {
+            return false;
+        }
+        const auto decoded = QByteArray::fromBase64Encoding(
+            cursor.first(dot).toLatin1(),
+            QByteArray::Base64UrlEncoding | QByteArray::AbortOnBase64DecodingErrors);
+        if (!decoded) {
+            return false;
+        }
+        scan.afterTitle = QString::fromUtf8(*decoded);
+        scan.afterRowId = cursor.sliced(dot + 1).toLongLong(&ok);
+        return ok;
+    }
+
+    scan.afterRowId = cursor.toLongLong(&ok);
+    return ok && scan.afterRowId >= 0;
+}
+
+// "tags": массив UUID-строк или объектов {id}; ошибка формата → outError
+static bool parseTagIdList(const QJsonValue &tagsVal, QVector<QUuid> &out,
+                           QString &outError) {
+    if (!tagsVal.isArray()) {
+        outError = QStringLiteral("Field 'tags' must be an array");
+        return false;
+    }
+
+    const QJsonArray in = tagsVal.toArray();
+    out.reserve(in.size());
+    for (const QJsonValue &v : in) {
+        QUuid parsed;
+        if (v.isString()) {
+            parsed = parseUuid(v.toString());
+        } else if (v.isObject()) {
+            parsed = parseUuid(v.toObject().value("id").toString());
+        } else {
+            outError = QStringLiteral(
+                "Each tag must be a UUID string or an object with 'id' (UUID)");
+            return false;
+        }
+
+        if (parsed.isNull()) {
+            outError = QStringLiteral("Invalid tag id (expected UUID)");
+            return false;
+        }
+        out.push_back(parsed);
+    }
+
+    return true;
+}
+
+// 400 по результату TaskBodyDecoder: синтаксис → bad_request,
+// нарушение схемы → validation_error; в details — точное место ошибки
+static QHttpServerResponse makeBodyDecodeError(const BodyDecodeError &error,
+                                               const QString &requestId) {
+    QJsonObject details{{"offset", error.offset},
+                        {"line", error.line},
+                        {"column", error.column}};
+
+    if (error.kind == BodyDecodeError::Kind::Syntax) {
+        return makeApiError(QHttpServerResponse::StatusCode::BadRequest,
+                            QString("Invalid JSON: %1 at line %2, column %3")
+                                .arg(error.message)
+                                .arg(error.line)
+                                .arg(error.column),
+                            "bad_request", details, requestId);
+    }
+
+    details.insert("field", error.field);
+    return makeApiError(QHttpServerResponse::StatusCode::BadRequest,
+                        error.message, "validation_error", details, requestId);
+}
+
+// data для ответов с одной задачей: {"task":{...}}
+static QByteArray taskData(const Task &task,
+                           TaskFields fields = TaskFields::all()) {
+    tracing::Span span("serializeTask");
+    QByteArray data;
+    data.reserve(256);
+    data.append("{\"task\":");
+    writeTaskJson(data, task, fields);
+    data.append('}');
+    return data;
+}
+
+static const char *mutationKindName(TaskMutation::Kind kind) {
+    switch (kind) {
+    case TaskMutation::Kind::Create: return "create";
+    case TaskMutation::Kind::Patch: return "patch";
+    case TaskMutation::Kind::Delete: return "delete";
+    }
+    return "unknown";
+}
+
+// Разбор одной операции пакета:
+//  {"op":"create","task":{...}} | {"op":"patch","id":"<uuid>","patch":{...}}
+//  | {"op":"delete","id":"<uuid>"}
+static bool parseMutation(const QJsonValue &value, TaskMutation &out,
+                          QString &outError) {
+    if (!value.isObject()) {
+        outError = QStringLiteral("Operation must be an object");
+        return false;
+    }
+
+    const QJsonObject obj = value.toObject();
+    const QString op = obj.value("op").toString();
+
+    if (op == QLatin1String("create")) {
+        const QJsonValue taskVal = obj.value("task");
+        if (!taskVal.isObject()) {
+            outError = QStringLiteral("Field 'task' must be an object");
+            return false;
+        }
+
+        const QJsonObject payload = taskVal.toObject();
+        QVector<QUuid> tagIds;
+        if (payload.contains("tags") &&
+            !parseTagIdList(payload.value("tags"), tagIds, outError)) {
+            return false;
+        }
+
+        out.kind = TaskMutation::Kind::Create;
+        out.task = Task::fromJson(payload);
+        out.task.tags = std::move(tagIds);
+        if (out.task.description.isNull()) {
+            out.task.description = QStringLiteral("");
+        }
+        return true;
+    }
+
+    if (op != QLatin1String("patch") && op != QLatin1String("delete")) {
+        outError = QStringLiteral(
+            "Field 'op' must be one of: create, patch, delete");
+        return false;
+    }
+
+    out.id = parseUuid(obj.value("id").toString());
+    if (out.id.isNull()) {
+        outError = QStringLiteral("Invalid 'id' (expected UUID)");
+        return false;
+    }
+
+    if (op == QLatin1String("delete")) {
+        out.kind = TaskMutation::Kind::Delete;
+        return true;
+    }
+
+    const QJsonValue patchVal = obj.value("patch");
+    if (!patchVal.isObject()) {
+        outError = QStringLiteral("Field 'patch' must be an object");
+        return false;
+    }
+
+    out.kind = TaskMutation::Kind::Patch;
+    out.patch = taskPatchFromJson(patchVal.toObject());
+    return true;
+}
+
+// "filter": {"ids":[uuid], "isCompleted":bool, "tags":[uuid], "titlePrefix":"...",
+//            "titleContains":"..."};
+// outField — поле с ошибкой для details
+static bool parseTaskFilter(const QJsonValue &value, TaskFilter &out,
+                            QString &outError, QString &outField) {
+    if (!value.isObject()) {
+        outField = QStringLiteral("filter");
+        outError = QStringLiteral("Field 'filter' must be an object ({} selects all tasks)");
+        return false;
+    }
+    const QJsonObject obj = value.toObject();
+
+    if (obj.contains("ids")) {
+        outField = QStringLiteral("filter.ids");
+        const QJsonValue idsVal = obj.value("ids");
+        if (!idsVal.isArray()) {
+            outError = QStringLiteral("Field 'filter.ids' must be an array");
+            return false;
+        }
+        for (const QJsonValue &v : idsVal.toArray()) {
+            const QUuid id = parseUuid(v.toString());
+            if (id.isNull()) {
+                outError = QStringLiteral("Invalid id in 'filter.ids' (expected UUID)");
+                return false;
+            }
+            out.ids.push_back(id);
+        }
+        // Пустой список не сужает выборку: вычисленный клиентом пустой
+        // набор id иначе затронул бы все задачи
+        if (out.ids.isEmpty()) {
+            outError = QStringLiteral("Field 'filter.ids' must not be empty "
+                                      "(omit it to not filter by id)");
+            return false;
+        }
+    }
+
+    if (obj.contains("isCompleted")) {
+        outField = QStringLiteral("filter.isCompleted");
+        if (!obj.value("isCompleted").isBool()) {
+            outError = QStringLiteral("Field 'filter.isCompleted' must be a boolean");
+            return false;
+        }
+        out.isCompleted = obj.value("isCompleted").toBool();
+    }
+
+    if (obj.contains("tags")) {
+        outField = QStringLiteral("filter.tags");
+        if (!parseTagIdList(obj.value("tags"), out.tags, outError)) {
+            return false;
+        }
+        if (out.tags.isEmpty()) {
+            outError = QStringLiteral("Field 'filter.tags' must not be empty "
+                                      "(omit it to not filter by tag)");
+            return false;
+        }
+    }
+
+    if (obj.contains("titlePrefix")) {
+        outField = QStringLiteral("filter.titlePrefix");
+        if (!obj.value("titlePrefix").isString()) {
+            outError = QStringLiteral("Field 'filter.titlePrefix' must be a string");
+            return false;
+        }
+        out.titlePrefix = obj.value("titlePrefix").toString();
+    }
+
+    if (obj.contains("titleContains")) {
+        outField = QStringLiteral("filter.titleContains");
+        if (!obj.value("titleContains").isString()) {
+            outError = QStringLiteral("Field 'filter.titleContains' must be a string");
+            return false;
+        }
+        out.titleContains = obj.value("titleContains").toString();
+    }
+
+    if (out.ids.size() > kMaxBulkListSize || out.tags.size() > kMaxBulkListSize) {
+        outField = QStringLiteral("filter");
+        outError = QStringLiteral("Filter lists are limited to %1 ids").arg(kMaxBulkListSize);
+        return false;
+    }
+    return true;
+}
+
+static const char *bulkKindName(const TaskBulkOp &op) {
+    switch (op.kind) {
+    case TaskBulkOp::Kind::SetCompleted: return op.isCompleted ? "complete" : "uncomplete";
+    case TaskBulkOp::Kind::Delete: return "delete";
+    case TaskBulkOp::Kind::AddTags: return "addTags";
+    case TaskBulkOp::Kind::RemoveTags: return "removeTags";
+    }
+    return "unknown";
+}
+
+// {"op":"complete"|"uncomplete"|"delete"|"addTags"|"removeTags",
+//  "filter":{...}, "tags":[uuid]}  (tags — только для addTags / removeTags)
+static bool parseBulkOp(const QJsonObject &obj, TaskBulkOp &out, QString &outError,
+                        QString &outField) {
+    const QString op = obj.value("op").toString();
+    outField = QStringLiteral("op");
+    if (op == QLatin1String("complete") || op == QLatin1String("uncomplete")) {
+        out.kind = TaskBulkOp::Kind::SetCompleted;
+        out.isCompleted = op == QLatin1String("complete");
+    } else if (op == QLatin1String("delete")) {
+        out.kind = TaskBulkOp::Kind::Delete;
+    } else if (op == QLatin1String("addTags")) {
+        out.kind = TaskBulkOp::Kind::AddTags;
+    } else if (op == QLatin1String("removeTags")) {
+        out.kind = TaskBulkOp::Kind::RemoveTags;
+    } else {
+        outError = QStringLiteral(
+            "Field 'op' must be one of: complete, uncomplete, delete, addTags, removeTags");
+        return false;
     }
-    if (!string.isEmpty() && !string.startsWith('{') && !string.endsWith('}')) {
-        id = QUuid::fromString(QStringLiteral("{") + string +
-                               QStringLiteral("}"));
+
+    if (out.kind == TaskBulkOp::Kind::AddTags || out.kind == TaskBulkOp::Kind::RemoveTags) {
+        outField = QStringLiteral("tags");
+        if (!parseTagIdList(obj.value("tags"), out.tags, outError)) {
+            return false;
+        }
+        if (out.tags.isEmpty() || out.tags.size() > kMaxBulkListSize) {
+            outError = QStringLiteral("Field 'tags' must contain 1..%1 tag ids")
+                           .arg(kMaxBulkListSize);
+            return false;
+        }
+    }
+
+    // Поле filter обязательно: все задачи выбираются только явным {}, а не
+    // пропущенным полем
+    return parseTaskFilter(obj.value("filter"), out.filter, outError, outField);
+}
+
+// Idempotency-Key: 1..255 видимых ASCII-символов
+static bool isValidIdempotencyKey(QByteArrayView key) {
+    if (key.isEmpty() || key.size() > 255) {
+        return false;
     }
-    return id;
+    return std::all_of(key.begin(), key.end(),
+                       [](char c) { return c >= 0x21 && c <= 0x7E; });
 }
 
 void TaskRouter::registerRoutes(QHttpServer &server) {
@@ -44,7 +399,7 @@ void TaskRouter::registerRoutes(QHttpServer &server) {
             return false;
         }
 
-        const QUuid id = parseUuidLoose(idString);
+        const QUuid id = parseUuid(idString);
         if (id.isNull()) {
             outError = QStringLiteral("Invalid 'id' (expected UUID)");
             return false;
@@ -54,195 +409,412 @@ void TaskRouter::registerRoutes(QHttpServer &server) {
         return true;
     };
 
-    const auto mirrorRoute = [&server](const char *path,
-                                       QHttpServerRequest::Method method,
-                                       auto handler) {
-        server.route(path, method, handler);
-        QString withSlash = QString::fromLatin1(path);
-        if (!withSlash.endsWith('/')) {
-            withSlash.append('/');
+    // ?fields=id,title,... — проекция; без параметра — все поля
+    const auto parseFieldsFromQuery = [](const QHttpServerRequest &request,
+                                         TaskFields &outFields,
+                                         QString &outError) -> bool {
+        const QUrlQuery query = request.query();
+        if (!query.hasQueryItem(QStringLiteral("fields"))) {
+            outFields = TaskFields::all();
+            return true;
+        }
+
+        QString unknown;
+        const auto fields =
+            TaskFields::parse(query.queryItemValue(QStringLiteral("fields")), &unknown);
+        if (!fields) {
+            outError = unknown.isEmpty()
+                           ? QStringLiteral("Query param 'fields' must not be empty")
+                           : QStringLiteral("Unknown field '%1' in 'fields' "
+                                            "(expected id, title, description, "
+                                            "isCompleted, tags)")
+                                 .arg(unknown);
+            return false;
         }
 
-        server.route(withSlash.toLatin1().constData(), method, handler);
+        outFields = *fields;
+        return true;
+    };
+
+    // ?completed=&tag=&title_prefix=&sort= — фильтр и порядок списка задач;
+    // tag — один или несколько id через запятую (любой из)
+    const auto parseListQuery = [](const QHttpServerRequest &request, TaskScan &scan,
+                                   QString &outError) -> bool {
+        const QUrlQuery query = request.query();
+        if (query.hasQueryItem(QStringLiteral("completed"))) {
+            const QString value = query.queryItemValue(QStringLiteral("completed"));
+            if (value == QLatin1String("true") || value == QLatin1String("1")) {
+                scan.filter.isCompleted = true;
+            } else if (value == QLatin1String("false") || value == QLatin1String("0")) {
+                scan.filter.isCompleted = false;
+            } else {
+                outError = QStringLiteral("Query param 'completed' must be true or false");
+                return false;
+            }
+        }
+        if (query.hasQueryItem(QStringLiteral("tag"))) {
+            const QString value = query.queryItemValue(QStringLiteral("tag"));
+            if (parseUuidList(value, u',', scan.filter.tags) != value.count(u',') + 1 ||
+                scan.filter.tags.size() > kMaxBulkListSize) {
+                outError = QStringLiteral("Query param 'tag' must be 1..%1 comma-separated "
+                                          "UUIDs")
+                               .arg(kMaxBulkListSize);
+                return false;
+            }
+        }
+        if (query.hasQueryItem(QStringLiteral("title_prefix"))) {
+            scan.filter.titlePrefix = query.queryItemValue(QStringLiteral("title_prefix"),
+                                                           QUrl::FullyDecoded);
+        }
+        if (query.hasQueryItem(QStringLiteral("sort"))) {
+            const QString value = query.queryItemValue(QStringLiteral("sort"));
+            if (value == QLatin1String("id")) {
+                scan.sort = TaskSort::IdAsc;
+            } else if (value == QLatin1String("-id")) {
+                scan.sort = TaskSort::IdDesc;
+            } else if (value == QLatin1String("title")) {
+                scan.sort = TaskSort::TitleAsc;
+            } else if (value == QLatin1String("-title")) {
+                scan.sort = TaskSort::TitleDesc;
+            } else {
+                outError = QStringLiteral("Query param 'sort' must be one of: "
+                                          "id, -id, title, -title");
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // ?limit=&after= — keyset-страница по курсору (nextCursor предыдущей);
+    // вид курсора зависит от сортировки, поэтому разбирается после неё
+    const auto parsePageFromQuery = [](const QHttpServerRequest &request, TaskScan &scan,
+                                       QString &outError) -> bool {
+        const QUrlQuery query = request.query();
+        if (query.hasQueryItem(QStringLiteral("limit"))) {
+            bool ok = false;
+            const qlonglong limit =
+                query.queryItemValue(QStringLiteral("limit")).toLongLong(&ok);
+            if (!ok || limit < 1 || limit > kMaxPageLimit) {
+                outError = QStringLiteral("Query param 'limit' must be an integer in [1, %1]")
+                               .arg(kMaxPageLimit);
+                return false;
+            }
+            scan.limit = limit;
+        }
+        if (query.hasQueryItem(QStringLiteral("after")) &&
+            !parseTaskCursor(query.queryItemValue(QStringLiteral("after")), scan)) {
+            outError = QStringLiteral("Query param 'after' must be a cursor "
+                                      "returned as 'nextCursor'");
+            return false;
+        }
+        return true;
+    };
+
+    // Страница задач частями по kTaskRowsPerStep строк: первая пишется в
+    // обработчике, остальные дописывает StreamPump, пока сокет клиента
+    // успевает отправлять. Каждая часть — keyset-запрос от последней отданной
+    // строки, поэтому задачи, изменённые между частями, видны как при
+    // постраничном чтении. Сбой чтения — 500 или оборванное тело (см. fail)
+    m_pump = std::make_unique<StreamPump>(&server);
+    const auto streamTaskPage = [this](const QHttpServerRequest &request, const TaskScan &scan,
+                                       const char *message, ChunkedResponse &stream,
+                                       const QString &requestId) {
+        stream.begin();
+        writeApiOkEnvelopeHead(stream.buffer(), message, requestId);
+        stream.buffer().append("{\"items\":[");
+
+        auto step = [this, scan, limit = scan.limit, count = qsizetype(0),
+                     cursor = QByteArray(), requestId](ChunkedResponse &response) mutable {
+            TaskScan part = scan;
+            part.limit = limit < 0 ? kTaskRowsPerStep
+                                   : std::min(kTaskRowsPerStep, limit - count);
+
+            QByteArray &buffer = response.buffer();
+            qsizetype read = 0;
+            const bool ok = m_service->forEachTaskBatch(part, [&](const TaskBatch &batch) {
+                for (qsizetype row = 0; row < batch.size(); ++row) {
+                    if (count > 0) {
+                        buffer.append(',');
+                    }
+                    writeTaskJson(buffer, batch, row);
+                    ++count;
+                }
+                read += batch.size();
+                advanceTaskScan(scan, batch, batch.size() - 1);
+                if (limit > 0) {
+                    cursor.resize(0);
+                    writeTaskCursor(cursor, scan, batch, batch.size() - 1);
+                }
+                response.flushIfFull();
+                return true;
+            });
+
+            if (!ok) {
+                response.fail(makeApiError(
+                    QHttpServerResponse::StatusCode::InternalServerError, "Read tasks failed",
+                    "internal_error", {}, requestId));
+                return false;
+            }
+            // Часть заполнена целиком — выборка, возможно, не кончилась
+            if (read == part.limit && (limit < 0 || count < limit)) {
+                return true;
+            }
+
+            buffer.append("],\"count\":");
+            writeJsonInt(buffer, count);
+            // Полная страница — возможно, есть следующая
+            if (limit > 0) {
+                buffer.append(",\"nextCursor\":");
+                if (count == limit) {
+                    // Символы курсора не требуют экранирования в JSON
+                    buffer.append('"').append(cursor).append('"');
+                } else {
+                    buffer.append("null");
+                }
+            }
+            buffer.append("}}");
+            response.finish();
+            return false;
+        };
+
+        if (step(stream)) {
+            m_pump->adopt(request, stream, std::move(step));
+        }
+    };
+
+    // POST с заголовком Idempotency-Key: повтор с тем же ключом и телом отдаёт
+    // сохранённый ответ, не доходя до хранилища; тот же ключ с другим телом
+    // или маршрутом — 422. Ответы 5xx не сохраняются: повтор выполнится заново.
+    const auto idempotent = [this](const char *routeName, auto handler) {
+        return [this, routeName, handler](const QHttpServerRequest &request,
+                                          const QString &requestId) -> QHttpServerResponse {
+            const QByteArray key =
+                request.headers().value("Idempotency-Key").toByteArray().trimmed();
+            if (key.isEmpty()) {
+                return handler(request, requestId);
+            }
+            if (!isValidIdempotencyKey(key)) {
+                return makeApiError(
+                    QHttpServerResponse::StatusCode::BadRequest,
+                    "Idempotency-Key must be 1..255 visible ASCII characters",
+                    "bad_request", {}, requestId);
+            }
+
+            QCryptographicHash hash(QCryptographicHash::Sha256);
+            hash.addData(QByteArrayView(routeName));
+            hash.addData(QByteArrayView("\n"));
+            hash.addData(request.body());
+            const QByteArray fingerprint = hash.result();
+            const QString keyString = QString::fromLatin1(key);
+
+            if (const auto stored = m_service->findIdempotencyRecord(keyString)) {
+                if (stored->fingerprint != fingerprint) {
+                    return makeApiError(
+                        QHttpServerResponse::StatusCode::UnprocessableEntity,
+                        "Idempotency-Key was already used with a different request",
+                        "idempotency_key_reused",
+                        QJsonObject{{"key", keyString}}, requestId);
+                }
+
+                qInfo(appHttp) << "[IDEMPOTENT]" << routeName
+                               << "replay key=" << keyString
+                               << "| requestId=" << requestId;
+                QHttpServerResponse replay(
+                    stored->contentType, stored->body,
+                    static_cast<QHttpServerResponse::StatusCode>(stored->status));
+                QHttpHeaders headers = replay.headers();
+                headers.append("Idempotent-Replayed", "true");
+                replay.setHeaders(std::move(headers));
+                return replay;
+            }
+
+            QHttpServerResponse response = handler(request, requestId);
+            const int status = static_cast<int>(response.statusCode());
+            if (status < 500) {
+                IdempotencyRecord record;
+                record.key = keyString;
+                record.fingerprint = fingerprint;
+                record.status = status;
+                record.contentType =
+                    response.headers()
+                        .value(QHttpHeaders::WellKnownHeader::ContentType, "application/json")
+                        .toByteArray();
+                record.body = response.data();
+                record.createdAtMs = QDateTime::currentMSecsSinceEpoch();
+                m_service->rememberIdempotencyRecord(record);
+            }
+            return response;
+        };
     };
 
     // ─────────────────────────────────────────────────────────────────────────────
     // GET /tasks
     // ─────────────────────────────────────────────────────────────────────────────
     mirrorRoute(
-        "/tasks", QHttpServerRequest::Method::Get,
-        wrapSafe("GET /tasks",
-                 std::function<QHttpServerResponse(const QHttpServerRequest &,
-                                                   const QString &)>(
-                     [this](const QHttpServerRequest &request,
-                            const QString &requestId) {
-                         qInfo(appHttp)
-                         << "[GET] /tasks"
-                         << "url:" << request.url().toString()
-                         << "query:" << request.query().toString()
-                         << "| requestId=" << requestId;
-
-                         QJsonArray items;
-                         const auto allTasks = m_service->getAllTasks();
-                         for (const Task &task : allTasks) {
-                             items.append(task.toJson());
-                         }
-
-                         return makeApiOk("Tasks fetched",
-                                          QJsonObject{{"items", items},
-                                                      {"count", items.size()}},
-                                          requestId);
-                     })));
+        server, "/tasks", QHttpServerRequest::Method::Get,
+        wrapSafeStream(
+            "GET /tasks", admission::RouteClass::Read,
+            [this, parseFieldsFromQuery, parseListQuery, parsePageFromQuery, streamTaskPage](
+                const QHttpServerRequest &request, ChunkedResponse &stream,
+                const QString &requestId) {
+                qInfo(appHttp) << "[GET] /tasks"
+                               << "url:" << request.url().toString()
+                               << "query:" << request.query().toString()
+                               << "| requestId=" << requestId;
+
+                TaskScan scan;
+                QString queryError;
+                if (!parseFieldsFromQuery(request, scan.fields, queryError) ||
+                    !parseListQuery(request, scan, queryError) ||
+                    !parsePageFromQuery(request, scan, queryError)) {
+                    stream.sendResponse(makeApiError(
+                        QHttpServerResponse::StatusCode::BadRequest, queryError,
+                        "bad_request", {}, requestId));
+                    return;
+                }
+
+                // ?explain=1 — план запроса вместо строк
+                const QString explain =
+                    request.query().queryItemValue(QStringLiteral("explain"));
+                if (explain == QLatin1String("1") || explain == QLatin1String("true")) {
+                    const auto plan = m_service->explainTaskScan(scan);
+                    if (!plan) {
+                        stream.sendResponse(makeApiError(
+                            QHttpServerResponse::StatusCode::InternalServerError,
+                            "Explain failed", "internal_error", {}, requestId));
+                        return;
+                    }
+                    stream.sendResponse(makeApiOk(
+                        "Query plan",
+                        QJsonObject{{"sql", plan->sql},
+                                    {"plan", QJsonArray::fromStringList(plan->steps)}},
+                        requestId));
+                    return;
+                }
+
+                streamTaskPage(request, scan, "Tasks fetched", stream, requestId);
+            }));
 
     // ─────────────────────────────────────────────────────────────────────────────
-    // GET /task?id=<uuid>
+    // GET /tasks/stream  (Server-Sent Events, resume по Last-Event-ID)
+    // Соединение остаётся у TaskEventStream; запрос считается завершённым,
+    // как только отправлены заголовки потока.
     // ─────────────────────────────────────────────────────────────────────────────
+    m_events = std::make_unique<TaskEventStream>(m_service->changeFeed(), &server);
     mirrorRoute(
-        "/task", QHttpServerRequest::Method::Get,
-        wrapSafe(
-            "GET /task",
-            std::function<QHttpServerResponse(const QHttpServerRequest &,
-                                              const QString &)>(
-                [this, &parseUuidFromQuery](const QHttpServerRequest &request,
-                                            const QString &requestId) {
-                    qInfo(appHttp) << "[GET] /task"
-                                   << "url:" << request.url().toString()
-                                   << "| requestId=" << requestId;
+        server, "/tasks/stream", QHttpServerRequest::Method::Get,
+        [this](const QHttpServerRequest &request, QHttpServerResponder &responder) {
+            const char *routeName = "GET /tasks/stream";
+            const QString requestId = nextRequestId();
+            const auto started = metrics::Clock::now();
 
-                    QUuid taskId;
-                    QString parseError;
-                    if (!parseUuidFromQuery(request, taskId, parseError)) {
-                        return makeApiError(
-                            QHttpServerResponse::StatusCode::BadRequest,
-                            parseError, "bad_request", {}, requestId);
-                    }
-
-                    const auto taskOpt = m_service->getTaskById(taskId);
-                    if (!taskOpt) {
-                        return makeApiError(
-                            QHttpServerResponse::StatusCode::NotFound,
-                            QString("Task with id=%1 not found")
-                                .arg(taskId.toString(QUuid::WithoutBraces)),
-                            "not_found",
-                            QJsonObject{
-                                        {"id", taskId.toString(QUuid::WithoutBraces)}},
-                            requestId);
-                    }
+            const admission::Decision decision =
+                admission::tryAdmit(admission::RouteClass::Read);
+            if (!decision.admitted) {
+                responder.sendResponse(reportRequestShed(
+                    routeName, requestId, started, admission::RouteClass::Read, decision));
+                return;
+            }
 
-                    return makeApiOk("Task fetched",
-                                     QJsonObject{{"task", taskOpt->toJson()}},
-                                     requestId);
-                })));
+            if (!m_events->subscribe(request, responder, requestId)) {
+                constexpr auto status = QHttpServerResponse::StatusCode::ServiceUnavailable;
+                responder.sendResponse(makeApiError(
+                    status, "Too many event stream subscribers", "overloaded",
+                    QJsonObject{{"limit", TaskEventStream::kMaxSubscribers}}, requestId));
+                reportRequestDone(routeName, requestId, started, static_cast<int>(status));
+                return;
+            }
+            reportRequestDone(routeName, requestId, started,
+                              static_cast<int>(QHttpServerResponse::StatusCode::Ok));
+        });
 
     // ─────────────────────────────────────────────────────────────────────────────
-    // POST /task/create
+    // GET /task?id=<uuid>
     // ─────────────────────────────────────────────────────────────────────────────
     mirrorRoute(
-        "/task/create", QHttpServerRequest::Method::Post,
+        server, "/task", QHttpServerRequest::Method::Get,
         wrapSafe(
-            "POST /task/create",
-            std::function<QHttpServerResponse(
-                const QHttpServerRequest &,
-                const QString &)>([this](const QHttpServerRequest &request,
-                                         const QString &requestId) {
-                qInfo(appHttp) << "[POST] /task/create"
-                               << "bytes=" << request.body().size()
+            "GET /task", admission::RouteClass::Read,
+            [this, parseUuidFromQuery, parseFieldsFromQuery](
+                const QHttpServerRequest &request, const QString &requestId) {
+                qInfo(appHttp) << "[GET] /task"
+                               << "url:" << request.url().toString()
                                << "| requestId=" << requestId;
 
+                QUuid taskId;
                 QString parseError;
-                const auto bodyOpt = parseBodyObject(request, &parseError);
-                if (!bodyOpt) {
+                if (!parseUuidFromQuery(request, taskId, parseError)) {
                     return makeApiError(
                         QHttpServerResponse::StatusCode::BadRequest,
-                        "Invalid JSON: " + parseError, "bad_request", {},
-                        requestId);
+                        parseError, "bad_request", {}, requestId);
                 }
 
-                QJsonObject payload = *bodyOpt;
-
-                const QString title = payload.value("title").toString();
-                if (title.trimmed().isEmpty()) {
+                TaskFields fields;
+                if (!parseFieldsFromQuery(request, fields, parseError)) {
                     return makeApiError(
                         QHttpServerResponse::StatusCode::BadRequest,
-                        "Field 'title' is required and must be non-empty",
-                        "validation_error", QJsonObject{{"field", "title"}},
-                        requestId);
+                        parseError, "bad_request", {}, requestId);
                 }
 
-                if (!payload.contains("description")) {
-                    payload.insert("description", "");
-                }
-                if (!payload.contains("isCompleted")) {
-                    payload.insert("isCompleted", false);
+                const auto taskOpt = m_service->getTaskById(taskId, fields);
+                if (!taskOpt) {
+                    return makeApiError(
+                        QHttpServerResponse::StatusCode::NotFound,
+                        QString("Task with id=%1 not found")
+                            .arg(uuidToString(taskId)),
+                        "not_found",
+                        QJsonObject{
+                                    {"id", uuidToString(taskId)}},
+                        requestId);
                 }
 
-                QVector<QUuid> tagIds;
-                if (payload.contains("tags")) {
-                    const QJsonValue tagsVal = payload.value("tags");
-                    if (!tagsVal.isArray()) {
-                        return makeApiError(
-                            QHttpServerResponse::StatusCode::BadRequest,
-                            "Field 'tags' must be an array", "validation_error",
-                            QJsonObject{{"field", "tags"}}, requestId);
-                    }
+                return makeApiOkRaw("Task fetched", taskData(*taskOpt, fields),
+                                    requestId);
+            }));
 
-                    const QJsonArray in = tagsVal.toArray();
-                    tagIds.reserve(in.size());
-                    for (const QJsonValue &v : in) {
-                        QUuid parsed;
-                        if (v.isString()) {
-                            parsed = parseUuidLoose(v.toString());
-                        } else if (v.isObject()) {
-                            parsed = parseUuidLoose(
-                                v.toObject().value("id").toString());
-                        } else {
-                            return makeApiError(
-                                QHttpServerResponse::StatusCode::BadRequest,
-                                "Each tag must be a UUID string or an object "
-                                "with 'id' (UUID)",
-                                "validation_error",
-                                QJsonObject{{"field", "tags"}}, requestId);
-                        }
+    // ─────────────────────────────────────────────────────────────────────────────
+    // POST /task/create
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/task/create", QHttpServerRequest::Method::Post,
+        wrapSafe(
+            "POST /task/create", admission::RouteClass::Write,
+            idempotent(
+                "POST /task/create",
+                [this](const QHttpServerRequest &request, const QString &requestId) {
+                    qInfo(appHttp) << "[POST] /task/create"
+                                   << "bytes=" << request.body().size()
+                                   << "| requestId=" << requestId;
 
-                        if (parsed.isNull()) {
-                            return makeApiError(
-                                QHttpServerResponse::StatusCode::BadRequest,
-                                "Invalid tag id (expected UUID)",
-                                "validation_error",
-                                QJsonObject{{"field", "tags"}}, requestId);
-                        }
-                        tagIds.push_back(parsed);
+                    BodyDecodeError decodeError;
+                    auto decoded = decodeTaskCreate(request.body(), &decodeError);
+                    if (!decoded) {
+                        return makeBodyDecodeError(decodeError, requestId);
                     }
-                }
 
-                Task newTask = Task::fromJson(payload);
-                newTask.tags = std::move(tagIds);
+                    Task newTask = std::move(*decoded);
 
-                const QUuid storedId = m_service->addTask(newTask);
-                if (storedId.isNull()) {
-                    return makeApiError(
-                        QHttpServerResponse::StatusCode::InternalServerError,
-                        "Insert failed", "internal_error", {}, requestId);
-                }
-                newTask.id = storedId;
+                    const QUuid storedId = m_service->addTask(newTask);
+                    if (storedId.isNull()) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::InternalServerError,
+                            "Insert failed", "internal_error", {}, requestId);
+                    }
+                    newTask.id = storedId;
 
-                return makeApiOk(
-                    "Task created", QJsonObject{{"task", newTask.toJson()}},
-                    requestId, QHttpServerResponse::StatusCode::Created);
-            })));
+                    return makeApiOkRaw("Task created", taskData(newTask), requestId,
+                                        QHttpServerResponse::StatusCode::Created);
+                })));
 
     // ─────────────────────────────────────────────────────────────────────────────
     // PATCH /task?id<uuid>
     // ─────────────────────────────────────────────────────────────────────────────
     mirrorRoute(
-        "/task", QHttpServerRequest::Method::Patch,
+        server, "/task", QHttpServerRequest::Method::Patch,
         wrapSafe(
-            "PATCH /task",
-            std::function<QHttpServerResponse(
-                const QHttpServerRequest &,
-                const QString &)>([this, &parseUuidFromQuery](
-                                      const QHttpServerRequest &request,
-                                      const QString &requestId) {
+            "PATCH /task", admission::RouteClass::Write,
+            [this, parseUuidFromQuery](const QHttpServerRequest &request,
+                                       const QString &requestId) {
                 qInfo(appHttp) << "[PATCH] /task"
                                << "url:" << request.url().toString()
                                << "bytes=" << request.body().size()
@@ -255,175 +827,536 @@ void TaskRouter::registerRoutes(QHttpServer &server) {
                                         parseError, "bad_request", {}, requestId);
                 }
 
-                const auto current = m_service->getTaskById(taskId);
-                if (!current) {
+                BodyDecodeError decodeError;
+                const auto patch = decodeTaskPatch(request.body(), &decodeError);
+                if (!patch) {
+                    return makeBodyDecodeError(decodeError, requestId);
+                }
+
+                const TaskMutationResult result = m_service->patchTask(taskId, *patch);
+                if (result.error == QLatin1String("not_found")) {
                     return makeApiError(
                         QHttpServerResponse::StatusCode::NotFound,
                         QString("Task with id=%1 not found")
-                            .arg(taskId.toString(QUuid::WithoutBraces)),
+                            .arg(uuidToString(taskId)),
                         "not_found",
-                        QJsonObject{{"id", taskId.toString(QUuid::WithoutBraces)}},
+                        QJsonObject{{"id", uuidToString(taskId)}},
                         requestId);
                 }
-
-                QString bodyErr;
-                const auto body = parseBodyObject(request, &bodyErr);
-                if (!body) {
-                    return makeApiError(QHttpServerResponse::StatusCode::BadRequest,
-                                        "Invalid JSON: " + bodyErr, "bad_request",
-                                        {}, requestId);
+                if (result.error == QLatin1String("validation_error")) {
+                    return makeApiError(
+                        QHttpServerResponse::StatusCode::UnprocessableEntity,
+                        result.message, "validation_error",
+                        QJsonObject{{"id", uuidToString(taskId)}},
+                        requestId);
                 }
-
-                Task patched = *current;
-                applyTaskPatch(
-                    patched,
-                    *body);
-
-                if (!m_service->updateTask(taskId, patched)) {
+                if (!result.ok || !result.task) {
                     return makeApiError(
                         QHttpServerResponse::StatusCode::InternalServerError,
                         "Update failed", "internal_error",
-                        QJsonObject{{"id", taskId.toString(QUuid::WithoutBraces)}},
+                        QJsonObject{{"id", uuidToString(taskId)}},
+                        requestId);
+                }
+
+                return makeApiOkRaw("Task updated", taskData(*result.task),
+                                    requestId);
+            }));
+
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // DELETE /task?id=<uuid>
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/task", QHttpServerRequest::Method::Delete,
+        wrapSafe(
+            "DELETE /task", admission::RouteClass::Write,
+            [this, parseUuidFromQuery](const QHttpServerRequest &request,
+                                       const QString &requestId) {
+                qInfo(appHttp) << "[DELETE] /task"
+                               << "url:" << request.url().toString()
+                               << "| requestId=" << requestId;
+
+                QUuid taskId;
+                QString parseError;
+                if (!parseUuidFromQuery(request, taskId, parseError)) {
+                    return makeApiError(
+                        QHttpServerResponse::StatusCode::BadRequest,
+                        parseError, "bad_request", {}, requestId);
+                }
+
+                if (!m_service->deleteTask(taskId)) {
+                    return makeApiError(
+                        QHttpServerResponse::StatusCode::NotFound,
+                        "Task not found", "not_found",
+                        QJsonObject{
+                                    {"id", uuidToString(taskId)}},
                         requestId);
                 }
 
-                const auto updated = m_service->getTaskById(taskId);
                 return makeApiOk(
-                    "Task updated",
+                    "Task deleted",
                     QJsonObject{
-                                {"task", (updated ? updated->toJson() : patched.toJson())}},
+                                {"id", uuidToString(taskId)}},
                     requestId);
-            })));
+            }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // DELETE /tasks
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/tasks", QHttpServerRequest::Method::Delete,
+        wrapSafe(
+            "DELETE /tasks", admission::RouteClass::Bulk,
+            [this](const QString &requestId) {
+                qInfo(appHttp) << "[DELETE] /tasks (all)"
+                               << "| requestId=" << requestId;
+
+                if (!m_service->deleteAll()) {
+                    return makeApiError(
+                        QHttpServerResponse::StatusCode::InternalServerError,
+                        "Delete all failed", "internal_error", {}, requestId);
+                }
 
+                return makeApiOk("All tasks deleted", {}, requestId);
+            }));
 
     // ─────────────────────────────────────────────────────────────────────────────
-    // DELETE /task?id=<uuid>
+    // POST /tasks/batch
     // ─────────────────────────────────────────────────────────────────────────────
     mirrorRoute(
-        "/task", QHttpServerRequest::Method::Delete,
+        server, "/tasks/batch", QHttpServerRequest::Method::Post,
         wrapSafe(
-            "DELETE /task",
-            std::function<QHttpServerResponse(const QHttpServerRequest &,
-                                              const QString &)>(
-                [this, &parseUuidFromQuery](const QHttpServerRequest &request,
-                                            const QString &requestId) {
-                    qInfo(appHttp) << "[DELETE] /task"
-                                   << "url:" << request.url().toString()
+            "POST /tasks/batch", admission::RouteClass::Bulk,
+            idempotent(
+                "POST /tasks/batch",
+                [this](const QHttpServerRequest &request, const QString &requestId) {
+                    qInfo(appHttp) << "[POST] /tasks/batch"
+                                   << "bytes=" << request.body().size()
                                    << "| requestId=" << requestId;
 
-                    QUuid taskId;
+                    constexpr qsizetype kMaxBatchOps = 1000;
+
                     QString parseError;
-                    if (!parseUuidFromQuery(request, taskId, parseError)) {
+                    const auto body = parseBodyObject(request, &parseError);
+                    if (!body) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::BadRequest,
+                            "Invalid JSON: " + parseError, "bad_request", {},
+                            requestId);
+                    }
+
+                    const QJsonValue atomicVal = body->value("atomic");
+                    if (!atomicVal.isUndefined() && !atomicVal.isBool()) {
                         return makeApiError(
                             QHttpServerResponse::StatusCode::BadRequest,
-                            parseError, "bad_request", {}, requestId);
+                            "Field 'atomic' must be a boolean", "validation_error",
+                            QJsonObject{{"field", "atomic"}}, requestId);
                     }
+                    const bool atomic = atomicVal.toBool(true);
 
-                    if (!m_service->deleteTask(taskId)) {
+                    const QJsonValue opsVal = body->value("ops");
+                    if (!opsVal.isArray()) {
                         return makeApiError(
-                            QHttpServerResponse::StatusCode::NotFound,
-                            "Task not found", "not_found",
-                            QJsonObject{
-                                        {"id", taskId.toString(QUuid::WithoutBraces)}},
+                            QHttpServerResponse::StatusCode::BadRequest,
+                            "Field 'ops' must be an array", "validation_error",
+                            QJsonObject{{"field", "ops"}}, requestId);
+                    }
+
+                    const QJsonArray opsArray = opsVal.toArray();
+                    if (opsArray.size() > kMaxBatchOps) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::PayloadTooLarge,
+                            QString("Too many operations (max %1)").arg(kMaxBatchOps),
+                            "validation_error",
+                            QJsonObject{{"field", "ops"}, {"max", kMaxBatchOps}},
                             requestId);
                     }
 
-                    return makeApiOk(
-                        "Task deleted",
-                        QJsonObject{
-                                    {"id", taskId.toString(QUuid::WithoutBraces)}},
-                        requestId);
+                    std::vector<TaskMutation> ops;
+                    ops.reserve(opsArray.size());
+                    for (qsizetype i = 0; i < opsArray.size(); ++i) {
+                        TaskMutation op;
+                        QString opError;
+                        if (!parseMutation(opsArray.at(i), op, opError)) {
+                            return makeApiError(
+                                QHttpServerResponse::StatusCode::BadRequest,
+                                opError, "validation_error",
+                                QJsonObject{{"field", "ops"}, {"index", i}},
+                                requestId);
+                        }
+                        ops.push_back(std::move(op));
+                    }
+
+                    const auto results = m_service->applyMutations(ops, atomic);
+
+                    QJsonArray items;
+                    qsizetype applied = 0;
+                    for (std::size_t i = 0; i < results.size(); ++i) {
+                        const TaskMutationResult &result = results[i];
+                        QJsonObject item{
+                            {"index", static_cast<qint64>(i)},
+                            {"op", mutationKindName(ops[i].kind)},
+                            {"ok", result.ok}};
+                        if (!result.id.isNull()) {
+                            item.insert("id", uuidToString(result.id));
+                        }
+                        if (result.ok) {
+                            ++applied;
+                            if (result.task) {
+                                item.insert("task", result.task->toJson());
+                            }
+                        } else {
+                            item.insert("error", result.error);
+                            item.insert("message", result.message);
+                        }
+                        items.append(item);
+                    }
+
+                    const QJsonObject data{{"atomic", atomic},
+                                           {"applied", applied},
+                                           {"failed", items.size() - applied},
+                                           {"results", items}};
+
+                    if (atomic && applied != items.size()) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::UnprocessableEntity,
+                            "Batch rolled back", "batch_failed", data, requestId);
+                    }
+
+                    return makeApiOk("Batch applied", data, requestId);
                 })));
 
     // ─────────────────────────────────────────────────────────────────────────────
-    // DELETE /tasks
+    // POST /tasks/bulk  (операция над всеми задачами под фильтром)
     // ─────────────────────────────────────────────────────────────────────────────
     mirrorRoute(
-        "/tasks", QHttpServerRequest::Method::Delete,
+        server, "/tasks/bulk", QHttpServerRequest::Method::Post,
         wrapSafe(
-            "DELETE /tasks",
-            std::function<QHttpServerResponse(
-                const QString &)>([this](const QString &requestId) {
-                qInfo(appHttp) << "[DELETE] /tasks (all)"
+            "POST /tasks/bulk", admission::RouteClass::Bulk,
+            idempotent(
+                "POST /tasks/bulk",
+                [this](const QHttpServerRequest &request, const QString &requestId) {
+                    qInfo(appHttp) << "[POST] /tasks/bulk"
+                                   << "bytes=" << request.body().size()
+                                   << "| requestId=" << requestId;
+
+                    QString parseError;
+                    const auto body = parseBodyObject(request, &parseError);
+                    if (!body) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::BadRequest,
+                            "Invalid JSON: " + parseError, "bad_request", {},
+                            requestId);
+                    }
+
+                    TaskBulkOp op;
+                    QString field;
+                    if (!parseBulkOp(*body, op, parseError, field)) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::BadRequest, parseError,
+                            "validation_error", QJsonObject{{"field", field}}, requestId);
+                    }
+
+                    const TaskBulkResult result = m_service->applyBulk(op);
+                    if (!result.ok) {
+                        const auto status =
+                            result.error == QLatin1String("not_found")
+                                ? QHttpServerResponse::StatusCode::NotFound
+                            : result.error == QLatin1String("validation_error")
+                                ? QHttpServerResponse::StatusCode::BadRequest
+                                : QHttpServerResponse::StatusCode::InternalServerError;
+                        return makeApiError(status, result.message, result.error,
+                                            QJsonObject{{"op", bulkKindName(op)}},
+                                            requestId);
+                    }
+
+                    return makeApiOk("Bulk operation applied",
+                                     QJsonObject{{"op", bulkKindName(op)},
+                                                 {"affected", result.affected}},
+                                     requestId);
+                })));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // GET /stats  (счётчики задач, одна строка task_stats)
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/stats", QHttpServerRequest::Method::Get,
+        wrapSafe(
+            "GET /stats", admission::RouteClass::Read,
+            [this](const QString &requestId) {
+                qInfo(appHttp) << "[GET] /stats"
                                << "| requestId=" << requestId;
 
-                if (!m_service->deleteAll()) {
+                const auto stats = m_service->getTaskStats();
+                if (!stats) {
                     return makeApiError(
                         QHttpServerResponse::StatusCode::InternalServerError,
-                        "Delete all failed", "internal_error", {}, requestId);
+                        "Read stats failed", "internal_error", {}, requestId);
                 }
 
-                return makeApiOk("All tasks deleted", {}, requestId);
-            })));
+                return makeApiOk("Stats fetched",
+                                 QJsonObject{{"total", stats->total},
+                                             {"completed", stats->completed},
+                                             {"pending", stats->total - stats->completed}},
+                                 requestId);
+            }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // GET /tags  (?withCounts=1 — с числом задач у каждого тега)
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/tags", QHttpServerRequest::Method::Get,
+        wrapSafeStream(
+            "GET /tags", admission::RouteClass::Read,
+            [this](const QHttpServerRequest &request, ChunkedResponse &stream,
+                   const QString &requestId) {
+                qInfo(appHttp) << "[GET] /tags"
+                               << "query:" << request.query().toString()
+                               << "| requestId=" << requestId;
+
+                const QString withCounts =
+                    request.query().queryItemValue(QStringLiteral("withCounts"));
+
+                stream.begin();
+                QByteArray &buffer = stream.buffer();
+                writeApiOkEnvelopeHead(buffer, "Tags fetched", requestId);
+                buffer.append("{\"items\":[");
+
+                qsizetype count = 0;
+                bool ok = false;
+                if (withCounts == QLatin1String("1") || withCounts == QLatin1String("true")) {
+                    ok = m_service->forEachTagUsage([&](const Tag &tag, qint64 taskCount) {
+                        if (count > 0) {
+                            buffer.append(',');
+                        }
+                        buffer.append("{\"id\":");
+                        writeJsonUuid(buffer, tag.id);
+                        buffer.append(",\"name\":");
+                        writeJsonString(buffer, tag.name);
+                        buffer.append(",\"taskCount\":");
+                        writeJsonInt(buffer, taskCount);
+                        buffer.append('}');
+                        ++count;
+                        stream.flushIfFull();
+                        return true;
+                    });
+                } else {
+                    ok = m_service->forEachTag([&](const Tag &tag) {
+                        if (count > 0) {
+                            buffer.append(',');
+                        }
+                        writeTagJson(buffer, tag);
+                        ++count;
+                        stream.flushIfFull();
+                        return true;
+                    });
+                }
+
+                if (!ok) {
+                    stream.fail(makeApiError(
+                        QHttpServerResponse::StatusCode::InternalServerError,
+                        "Read tags failed", "internal_error", {}, requestId));
+                    return;
+                }
+
+                buffer.append("],\"count\":");
+                writeJsonInt(buffer, count);
+                buffer.append("}}");
+                stream.finish();
+            }));
 
     // ─────────────────────────────────────────────────────────────────────────────
-    // GET /tags
+    // GET /tags/suggest?prefix=&limit=  (автодополнение из индекса в памяти)
     // ─────────────────────────────────────────────────────────────────────────────
-    mirrorRoute("/tags", QHttpServerRequest::Method::Get,
-                wrapSafe("GET /tags",
-                         std::function<QHttpServerResponse(const QString &)>(
-                             [this](const QString &requestId) {
-                                 qInfo(appHttp) << "[GET] /tags"
-                                                << "| requestId=" << requestId;
+    mirrorRoute(
+        server, "/tags/suggest", QHttpServerRequest::Method::Get,
+        wrapSafe(
+            "GET /tags/suggest", admission::RouteClass::Read,
+            [this](const QHttpServerRequest &request, const QString &requestId) {
+                qInfo(appHttp) << "[GET] /tags/suggest"
+                               << "query:" << request.query().toString()
+                               << "| requestId=" << requestId;
+
+                const QUrlQuery query = request.query();
+                qlonglong limit = kDefaultSuggestLimit;
+                if (query.hasQueryItem(QStringLiteral("limit"))) {
+                    bool ok = false;
+                    limit = query.queryItemValue(QStringLiteral("limit")).toLongLong(&ok);
+                    if (!ok || limit < 1 || limit > kMaxSuggestLimit) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::BadRequest,
+                            QStringLiteral("Query param 'limit' must be an integer in [1, %1]")
+                                .arg(kMaxSuggestLimit),
+                            "bad_request", {}, requestId);
+                    }
+                }
+                const QString prefix =
+                    query.queryItemValue(QStringLiteral("prefix"), QUrl::FullyDecoded);
 
-                                 QJsonArray items;
-                                 const auto allTags = m_service->getAllTags();
-                                 for (const Tag &tag : allTags) {
-                                     items.append(tag.toJson());
-                                 }
+                const std::vector<TagSuggestion> found =
+                    m_service->suggestTags(prefix, qsizetype(limit));
 
-                                 return makeApiOk(
-                                     "Tags fetched",
-                                     QJsonObject{{"items", items},
-                                                 {"count", items.size()}},
-                                     requestId);
-                             })));
+                QByteArray data("{\"items\":[");
+                for (std::size_t i = 0; i < found.size(); ++i) {
+                    if (i > 0) {
+                        data.append(',');
+                    }
+                    data.append("{\"id\":");
+                    writeJsonUuid(data, found[i].id);
+                    data.append(",\"name\":");
+                    writeJsonString(data, found[i].name);
+                    data.append(",\"usage\":");
+                    writeJsonInt(data, found[i].usage);
+                    data.append('}');
+                }
+                data.append("],\"count\":");
+                writeJsonInt(data, qsizetype(found.size()));
+                data.append('}');
+                return makeApiOkRaw("Tag suggestions", data, requestId);
+            }));
 
     // ─────────────────────────────────────────────────────────────────────────────
     // POST /tag/create
     // ─────────────────────────────────────────────────────────────────────────────
     mirrorRoute(
-        "/tag/create", QHttpServerRequest::Method::Post,
+        server, "/tag/create", QHttpServerRequest::Method::Post,
         wrapSafe(
-            "POST /tag/create",
-            std::function<QHttpServerResponse(
-                const QHttpServerRequest &,
-                const QString &)>([this](const QHttpServerRequest &request,
-                                         const QString &requestId) {
-                qInfo(appHttp) << "[POST] /tag/create"
-                               << "bytes=" << request.body().size()
+            "POST /tag/create", admission::RouteClass::Write,
+            idempotent(
+                "POST /tag/create",
+                [this](const QHttpServerRequest &request, const QString &requestId) {
+                    qInfo(appHttp) << "[POST] /tag/create"
+                                   << "bytes=" << request.body().size()
+                                   << "| requestId=" << requestId;
+
+                    QString parseError;
+                    const auto body = parseBodyObject(request, &parseError);
+                    if (!body) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::BadRequest,
+                            "Invalid JSON: " + parseError, "bad_request", {},
+                            requestId);
+                    }
+
+                    Tag tag = Tag::fromJson(*body);
+                    if (tag.name.trimmed().isEmpty()) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::BadRequest,
+                            "Field 'name' is required and must be non-empty",
+                            "validation_error", QJsonObject{{"field", "name"}},
+                            requestId);
+                    }
+
+                    const QUuid newId = m_service->addTag(tag);
+                    if (newId.isNull()) {
+                        return makeApiError(
+                            QHttpServerResponse::StatusCode::InternalServerError,
+                            "Insert tag failed", "internal_error", {}, requestId);
+                    }
+
+                    tag.id = newId;
+                    QByteArray data("{\"tag\":");
+                    writeTagJson(data, tag);
+                    data.append('}');
+                    return makeApiOkRaw("Tag created", data, requestId,
+                                        QHttpServerResponse::StatusCode::Created);
+                })));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // GET /tag/tasks?id=<uuid>  (задачи с тегом, keyset по id задачи)
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/tag/tasks", QHttpServerRequest::Method::Get,
+        wrapSafeStream(
+            "GET /tag/tasks", admission::RouteClass::Read,
+            [this, parseUuidFromQuery, parseFieldsFromQuery, parsePageFromQuery,
+             streamTaskPage](const QHttpServerRequest &request, ChunkedResponse &stream,
+                             const QString &requestId) {
+                qInfo(appHttp) << "[GET] /tag/tasks"
+                               << "query:" << request.query().toString()
+                               << "| requestId=" << requestId;
+
+                TaskScan scan;
+                QString queryError;
+                if (!parseUuidFromQuery(request, scan.tagId, queryError) ||
+                    !parseFieldsFromQuery(request, scan.fields, queryError) ||
+                    !parsePageFromQuery(request, scan, queryError)) {
+                    stream.sendResponse(makeApiError(
+                        QHttpServerResponse::StatusCode::BadRequest, queryError,
+                        "bad_request", {}, requestId));
+                    return;
+                }
+
+                if (!m_service->getTagById(scan.tagId)) {
+                    stream.sendResponse(makeApiError(
+                        QHttpServerResponse::StatusCode::NotFound,
+                        QString("Tag with id=%1 not found").arg(uuidToString(scan.tagId)),
+                        "not_found", QJsonObject{{"id", uuidToString(scan.tagId)}},
+                        requestId));
+                    return;
+                }
+
+                streamTaskPage(request, scan, "Tag tasks fetched", stream, requestId);
+            }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // DELETE /tag?id=<uuid>
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/tag", QHttpServerRequest::Method::Delete,
+        wrapSafe(
+            "DELETE /tag", admission::RouteClass::Write,
+            [this, parseUuidFromQuery](const QHttpServerRequest &request,
+                                       const QString &requestId) {
+                qInfo(appHttp) << "[DELETE] /tag"
+                               << "url:" << request.url().toString()
                                << "| requestId=" << requestId;
 
+                QUuid tagId;
                 QString parseError;
-                const auto body = parseBodyObject(request, &parseError);
-                if (!body) {
+                if (!parseUuidFromQuery(request, tagId, parseError)) {
                     return makeApiError(
                         QHttpServerResponse::StatusCode::BadRequest,
-                        "Invalid JSON: " + parseError, "bad_request", {},
-                        requestId);
+                        parseError, "bad_request", {}, requestId);
                 }
 
-                Tag tag = Tag::fromJson(*body);
-                if (tag.name.trimmed().isEmpty()) {
+                switch (m_service->deleteTag(tagId)) {
+                case DeleteResult::Deleted:
+                    break;
+                case DeleteResult::NotFound:
                     return makeApiError(
-                        QHttpServerResponse::StatusCode::BadRequest,
-                        "Field 'name' is required and must be non-empty",
-                        "validation_error", QJsonObject{{"field", "name"}},
-                        requestId);
+                        QHttpServerResponse::StatusCode::NotFound,
+                        "Tag not found", "not_found",
+                        QJsonObject{{"id", uuidToString(tagId)}}, requestId);
+                case DeleteResult::Failed:
+                    return makeApiError(
+                        QHttpServerResponse::StatusCode::InternalServerError,
+                        "Delete tag failed", "internal_error", {}, requestId);
                 }
 
-                const QUuid newId = m_service->addTag(tag);
-                if (newId.isNull()) {
+                return makeApiOk("Tag deleted", QJsonObject{{"id", uuidToString(tagId)}},
+                                 requestId);
+            }));
+
+    // ─────────────────────────────────────────────────────────────────────────────
+    // DELETE /tags
+    // ─────────────────────────────────────────────────────────────────────────────
+    mirrorRoute(
+        server, "/tags", QHttpServerRequest::Method::Delete,
+        wrapSafe(
+            "DELETE /tags", admission::RouteClass::Bulk,
+            [this](const QString &requestId) {
+                qInfo(appHttp) << "[DELETE] /tags (all)"
+                               << "| requestId=" << requestId;
+
+                if (!m_service->deleteAllTags()) {
                     return makeApiError(
                         QHttpServerResponse::StatusCode::InternalServerError,
-                        "Insert tag failed", "internal_error", {}, requestId);
+                        "Delete all tags failed", "internal_error", {}, requestId);
                 }
 
-                tag.id = newId;
-                return makeApiOk("Tag created",
-                                 QJsonObject{{"tag", tag.toJson()}}, requestId,
-                                 QHttpServerResponse::StatusCode::Created);
-            })));
+                return makeApiOk("All tags deleted", {}, requestId);
+            }));
 
     // ─────────────────────────────────────────────────────────────────────────────
     // Глобальный 404‑фолбек
@@ -3,6 +3,8 @@
 
 #include "IRouter.hpp"
 #include "ITaskService.hpp"
+#include "StreamPump.hpp"
+#include "TaskEventStream.hpp"
 #include <memory>
 
 class TaskRouter : public IRouter {
@@ -13,6 +15,8 @@ public:
 
 private:
     std::shared_ptr<ITaskService> m_service;
+    std::unique_ptr<TaskEventStream> m_events;
+    std::unique_ptr<StreamPump> m_pump;
 };
 
 #endif // TASKLIT_HTTP_TASKROUTER_HPP
@@ -5,10 +5,13 @@
 #include <QHostAddress>
 #include <QDebug>
 
+#include "Admission.hpp"
 #include "Logger.hpp"
 #include "SQLiteStorageImpl.hpp"
 #include "TaskServiceImpl.hpp"
+#include "AdminRouter.hpp"
 #include "TaskRouter.hpp"
+#include "TrafficCapture.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -42,6 +45,9 @@ int main(int argc, char *argv[])
     TaskRouter router(service);
     router.registerRoutes(server);
 
+    AdminRouter adminRouter;
+    adminRouter.registerRoutes(server);
+
     // ──────────────────────────────
     // 5. Привязка и запуск
     // ──────────────────────────────
@@ -51,6 +57,13 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    admission::startLagProbe(&app);
+    capture::startFromEnvironment();
+
     qInfo() << "Server running on port" << tcp->serverPort();
-    return app.exec();
+    const int rc = app.exec();
+
+    capture::stop();
+    shutdownLogging();
+    return rc;
 }
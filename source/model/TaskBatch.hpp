@@ -0,0 +1,114 @@
+#ifndef TASKBATCH_HPP
+#define TASKBATCH_HPP
+
+#include <QString>
+#include <QStringView>
+#include <QUuid>
+#include <QVector>
+
+#include "Task.hpp"
+#include "TaskFields.hpp"
+
+// Пачка задач в виде struct-of-arrays для списочных путей (GET /tasks,
+// выгрузка, фильтры). Вместо трёх QString и QVector на каждую задачу:
+//   ids / completed / rowIds — плотные массивы по строкам;
+//   text        — одна арена UTF-16: title и description строк подряд,
+//                 textOffsets (2n+1) — границы: title i = [2i, 2i+1),
+//                 description i = [2i+1, 2i+2);
+//   tagOffsets  — CSR: теги строки i = tagIds[tagOffsets[i], tagOffsets[i+1]).
+// clear() сохраняет ёмкость, поэтому переиспользуемая пачка после первой
+// страницы не аллоцирует.
+struct TaskBatch {
+    TaskFields fields;
+
+    QVector<QUuid> ids;
+    QVector<qint64> rowIds; // rowid в хранилище — курсор keyset-пагинации
+    QVector<bool> completed;
+    QString text;
+    QVector<qsizetype> textOffsets{0};
+    QVector<QUuid> tagIds;
+    QVector<qsizetype> tagOffsets{0};
+
+    qsizetype size() const { return ids.size(); }
+    bool isEmpty() const { return ids.isEmpty(); }
+
+    void clear() {
+        ids.resize(0);
+        rowIds.resize(0);
+        completed.resize(0);
+        text.resize(0);
+        textOffsets.resize(1);
+        tagIds.resize(0);
+        tagOffsets.resize(1);
+    }
+
+    void reserve(qsizetype rows, qsizetype textChars = 0, qsizetype tags = 0) {
+        ids.reserve(rows);
+        rowIds.reserve(rows);
+        completed.reserve(rows);
+        textOffsets.reserve(2 * rows + 1);
+        tagOffsets.reserve(rows + 1);
+        text.reserve(textChars);
+        tagIds.reserve(tags);
+    }
+
+    // Строка добавляется полем за полем: beginRow → appendText ×2 → теги
+    // (tagIds.append или parseUuidList) → endRow
+    void beginRow(const QUuid &id, qint64 rowId, bool isCompleted) {
+        ids.append(id);
+        rowIds.append(rowId);
+        completed.append(isCompleted);
+    }
+
+    void appendText(QStringView value) {
+        text.append(value);
+        textOffsets.append(text.size());
+    }
+
+    void endRow() { tagOffsets.append(tagIds.size()); }
+
+    void append(const Task &task, qint64 rowId = 0) {
+        beginRow(task.id, rowId, task.isCompleted);
+        appendText(task.title);
+        appendText(task.description);
+        tagIds.append(task.tags);
+        endRow();
+    }
+
+    const QUuid &id(qsizetype row) const { return ids[row]; }
+    bool isCompleted(qsizetype row) const { return completed[row]; }
+
+    QStringView title(qsizetype row) const {
+        return textAt(2 * row);
+    }
+
+    QStringView description(qsizetype row) const {
+        return textAt(2 * row + 1);
+    }
+
+    const QUuid *tagsBegin(qsizetype row) const {
+        return tagIds.constData() + tagOffsets[row];
+    }
+
+    qsizetype tagCount(qsizetype row) const {
+        return tagOffsets[row + 1] - tagOffsets[row];
+    }
+
+    Task toTask(qsizetype row) const {
+        Task task;
+        task.id = ids[row];
+        task.title = title(row).toString();
+        task.description = description(row).toString();
+        task.isCompleted = completed[row];
+        task.tags = QVector<QUuid>(tagsBegin(row), tagsBegin(row) + tagCount(row));
+        return task;
+    }
+
+private:
+    QStringView textAt(qsizetype slot) const {
+        const qsizetype from = textOffsets[slot];
+        return QStringView(text).sliced(from, textOffsets[slot + 1] - from);
+    }
+};
+
+#endif // TASKBATCH_HPP
@@ -0,0 +1,77 @@
+#ifndef TASKFIELDS_HPP
+#define TASKFIELDS_HPP
+
+#include <QString>
+#include <QStringView>
+#include <optional>
+
+// Набор полей задачи для проекции (?fields=id,title,isCompleted):
+// хранилище читает только эти колонки, сериализатор пишет только эти ключи.
+struct TaskFields {
+    enum Field : quint8 {
+        Id = 1 << 0,
+        Title = 1 << 1,
+        Description = 1 << 2,
+        IsCompleted = 1 << 3,
+        Tags = 1 << 4,
+    };
+
+    static constexpr quint8 kAll = Id | Title | Description | IsCompleted | Tags;
+
+    quint8 bits = kAll;
+
+    static constexpr TaskFields all() { return TaskFields{}; }
+
+    constexpr bool has(Field field) const { return (bits & field) != 0; }
+    constexpr bool isAll() const { return bits == kAll; }
+
+    // Список имён через запятую; пустой список или неизвестное имя → nullopt,
+    // в unknown — первое непонятое имя
+    static std::optional<TaskFields> parse(QStringView list, QString *unknown = nullptr) {
+        TaskFields fields;
+        fields.bits = 0;
+
+        qsizetype start = 0;
+        while (start <= list.size()) {
+            qsizetype end = list.indexOf(u',', start);
+            if (end < 0) {
+                end = list.size();
+            }
+            const QStringView name = list.sliced(start, end - start).trimmed();
+            start = end + 1;
+
+            if (name.isEmpty()) {
+                continue;
+            }
+
+            const quint8 bit = fieldBit(name);
+            if (bit == 0) {
+                if (unknown) {
+                    *unknown = name.toString();
+                }
+                return std::nullopt;
+            }
+            fields.bits |= bit;
+        }
+
+        if (fields.bits == 0) {
+            if (unknown) {
+                unknown->clear();
+            }
+            return std::nullopt;
+        }
+        return fields;
+    }
+
+private:
+    static quint8 fieldBit(QStringView name) {
+        if (name == u"id") return Id;
+        if (name == u"title") return Title;
+        if (name == u"description") return Description;
+        if (name == u"isCompleted") return IsCompleted;
+        if (name == u"tags") return Tags;
+        return 0;
+    }
+};
+
+#endif // TASKFIELDS_HPP
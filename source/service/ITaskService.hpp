@@ -2,9 +2,13 @@
 #define TASKLIT_SERVICE_ITASKSERVICE_HPP
 
 #include <QUuid>
+#include <functional>
 #include <optional>
 #include <vector>
 
+#include "IStorage.hpp"
+#include "TagSuggestIndex.hpp"
+#include "TaskChangeFeed.hpp"
 #include "Task.hpp"
 #include "Tag.hpp"
 
@@ -14,14 +18,48 @@ public:
 
     virtual std::vector<Task> getAllTasks() const = 0;
     virtual std::optional<Task> getTaskById(const QUuid &taskId) const = 0;
+    virtual std::optional<Task> getTaskById(const QUuid &taskId, TaskFields fields) const = 0;
+    virtual bool forEachTask(const std::function<bool(const Task &)> &visitor) const = 0;
+    virtual bool forEachTask(TaskFields fields,
+                             const std::function<bool(const Task &)> &visitor) const = 0;
+    virtual bool forEachTaskBatch(const TaskScan &scan,
+                                  const std::function<bool(const TaskBatch &)> &visitor) const = 0;
+    virtual std::optional<TaskQueryPlan> explainTaskScan(const TaskScan &scan) const = 0;
 
     virtual QUuid addTask(const Task &task) = 0;
-    virtual bool updateTask(const QUuid &taskId, const Task &task) = 0;
+    virtual TaskMutationResult patchTask(const QUuid &taskId, const TaskPatch &patch) = 0;
     virtual bool deleteTask(const QUuid &taskId) = 0;
     virtual bool deleteAll() = 0;
 
+    virtual std::vector<TaskMutationResult>
+    applyMutations(const std::vector<TaskMutation> &ops, bool atomic) = 0;
+    // В changeFeed — одно событие Changed (если что-то изменилось), без
+    // событий по отдельным задачам
+    virtual TaskBulkResult applyBulk(const TaskBulkOp &op) = 0;
+    // Счётчики из хранилища, O(1)
+    virtual std::optional<TaskStats> getTaskStats() const = 0;
+
+    // События о закоммиченных изменениях задач (GET /tasks/stream)
+    virtual TaskChangeFeed &changeFeed() = 0;
+
     virtual std::vector<Tag> getAllTags() const = 0;
+    virtual bool forEachTag(const std::function<bool(const Tag &)> &visitor) const = 0;
+    // Как forEachTag, с числом задач у каждого тега
+    virtual bool forEachTagUsage(
+        const std::function<bool(const Tag &, qint64 taskCount)> &visitor) const = 0;
+    virtual std::optional<Tag> getTagById(const QUuid &tagId) const = 0;
     virtual QUuid addTag(const Tag &tag) = 0;
+    // Автодополнение по префиксу имени из индекса в памяти, без обращения к БД
+    virtual std::vector<TagSuggestion> suggestTags(QStringView prefix,
+                                                   qsizetype limit) const = 0;
+    // Задачи с тегом теряют его без событий в changeFeed
+    virtual DeleteResult deleteTag(const QUuid &tagId) = 0;
+    virtual bool deleteAllTags() = 0;
+
+    // Idempotency-Key: кэш в памяти, затем таблица в хранилище; просроченные
+    // по TTL записи не возвращаются
+    virtual std::optional<IdempotencyRecord> findIdempotencyRecord(const QString &key) = 0;
+    virtual void rememberIdempotencyRecord(const IdempotencyRecord &record) = 0;
 };
 
 #endif // TASKLIT_SERVICE_ITASKSERVICE_HPP
@@ -0,0 +1,41 @@
+#include "IdempotencyCache.hpp"
+
+#include <algorithm>
+
+IdempotencyCache::IdempotencyCache(qsizetype capacity, qint64 ttlMs)
+    : m_capacity(std::max<qsizetype>(1, capacity)), m_ttlMs(ttlMs) {}
+
+std::optional<IdempotencyRecord> IdempotencyCache::get(const QString &key,
+                                                       qint64 nowMs) {
+    const auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        return std::nullopt;
+    }
+
+    const Entries::iterator entry = it.value();
+    if (entry->createdAtMs + m_ttlMs <= nowMs) {
+        m_entries.erase(entry);
+        m_index.erase(it);
+        return std::nullopt;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, entry);
+    return *entry;
+}
+
+void IdempotencyCache::put(const IdempotencyRecord &record) {
+    const auto it = m_index.find(record.key);
+    if (it != m_index.end()) {
+        *it.value() = record;
+        m_entries.splice(m_entries.begin(), m_entries, it.value());
+        return;
+    }
+
+    m_entries.push_front(record);
+    m_index.insert(record.key, m_entries.begin());
+
+    if (m_index.size() > m_capacity) {
+        m_index.remove(m_entries.back().key);
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef TASKLIT_SERVICE_IDEMPOTENCYCACHE_HPP
+#define TASKLIT_SERVICE_IDEMPOTENCYCACHE_HPP
+
+#include <QHash>
+#include <QString>
+
+#include <list>
+#include <optional>
+
+#include "IStorage.hpp"
+
+// LRU-кэш ответов по Idempotency-Key с ограничением по числу записей и TTL.
+// Горячий слой перед таблицей idempotency_keys; не потокобезопасен
+// (используется из потока HTTP-сервера).
+class IdempotencyCache {
+public:
+    IdempotencyCache(qsizetype capacity, qint64 ttlMs);
+
+    std::optional<IdempotencyRecord> get(const QString &key, qint64 nowMs);
+    void put(const IdempotencyRecord &record);
+
+    qint64 ttlMs() const { return m_ttlMs; }
+    qsizetype size() const { return m_index.size(); }
+
+private:
+    using Entries = std::list<IdempotencyRecord>;
+
+    qsizetype m_capacity;
+    qint64 m_ttlMs;
+    Entries m_entries; // начало — самые свежие по использованию
+    QHash<QString, Entries::iterator> m_index;
+};
+
+#endif // TASKLIT_SERVICE_IDEMPOTENCYCACHE_HPP
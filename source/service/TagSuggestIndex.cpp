@@ -0,0 +1,202 @@
+#include "TagSuggestIndex.hpp"
+
+#include <algorithm>
+
+namespace {
+
+template <typename Entry>
+bool entryLess(const Entry &a, const Entry &b) {
+    const int byFolded = QString::compare(a.folded, b.folded);
+    return byFolded < 0 || (byFolded == 0 && QString::compare(a.name, b.name) < 0);
+}
+
+} // namespace
+
+void TagSuggestIndex::reset(std::vector<TagSuggestion> tags) {
+    clear();
+    m_entries.reserve(tags.size());
+    m_foldedById.reserve(qsizetype(tags.size()));
+    for (TagSuggestion &tag : tags) {
+        if (m_foldedById.contains(tag.id)) {
+            continue;
+        }
+        Entry entry{tag.name.toCaseFolded(), std::move(tag.name), tag.id, tag.usage};
+        m_foldedById.insert(entry.id, entry.folded);
+        m_entries.push_back(std::move(entry));
+    }
+    std::sort(m_entries.begin(), m_entries.end(), entryLess<Entry>);
+}
+
+void TagSuggestIndex::clear() {
+    m_entries.clear();
+    m_foldedById.clear();
+    m_treeDirty = true;
+}
+
+void TagSuggestIndex::insert(const QUuid &id, const QString &name, qint64 usage) {
+    if (id.isNull() || m_foldedById.contains(id)) {
+        return;
+    }
+
+    Entry entry{name.toCaseFolded(), name, id, usage};
+    const auto position =
+        std::lower_bound(m_entries.begin(), m_entries.end(), entry, entryLess<Entry>);
+    m_foldedById.insert(id, entry.folded);
+    m_entries.insert(position, std::move(entry));
+    m_treeDirty = true;
+}
+
+void TagSuggestIndex::remove(const QUuid &id) {
+    const qsizetype position = find(id);
+    if (position < 0) {
+        return;
+    }
+    m_entries.erase(m_entries.begin() + position);
+    m_foldedById.remove(id);
+    m_treeDirty = true;
+}
+
+void TagSuggestIndex::addUsage(const QUuid &id, qint64 delta) {
+    const qsizetype position = find(id);
+    if (position < 0) {
+        return;
+    }
+    Entry &entry = m_entries[std::size_t(position)];
+    entry.usage = std::max<qint64>(0, entry.usage + delta);
+    if (!m_treeDirty) {
+        updateTree(position);
+    }
+}
+
+qsizetype TagSuggestIndex::find(const QUuid &id) const {
+    const auto folded = m_foldedById.constFind(id);
+    if (folded == m_foldedById.cend()) {
+        return -1;
+    }
+
+    // Одинаковая folded-форма бывает у имён, различающихся регистром
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), *folded,
+                               [](const Entry &entry, const QString &key) {
+                                   return QString::compare(entry.folded, key) < 0;
+                               });
+    for (; it != m_entries.end() && it->folded == *folded; ++it) {
+        if (it->id == id) {
+            return qsizetype(it - m_entries.begin());
+        }
+    }
+    return -1;
+}
+
+std::vector<TagSuggestion> TagSuggestIndex::suggest(QStringView prefix,
+                                                    qsizetype limit) const {
+    std::vector<TagSuggestion> out;
+    if (limit <= 0 || m_entries.empty()) {
+        return out;
+    }
+
+    // Совпадающие по префиксу имена в отсортированном массиве идут подряд
+    const QString folded = prefix.toString().toCaseFolded();
+    const auto first = std::lower_bound(m_entries.begin(), m_entries.end(), folded,
+                                        [](const Entry &entry, const QString &key) {
+                                            return QString::compare(entry.folded, key) < 0;
+                                        });
+    const auto last = std::partition_point(first, m_entries.end(), [&folded](const Entry &e) {
+        return e.folded.startsWith(folded);
+    });
+    if (first == last) {
+        return out;
+    }
+
+    if (m_treeDirty) {
+        rebuildTree();
+    }
+
+    // Куча отрезков по их максимуму: взяли максимум — отрезок делится на два
+    struct Range {
+        qsizetype from;
+        qsizetype to;
+        qsizetype best;
+    };
+    const auto worse = [this](const Range &a, const Range &b) {
+        return better(a.best, b.best) == b.best;
+    };
+
+    std::vector<Range> heap;
+    heap.reserve(std::size_t(2 * limit + 1));
+    const qsizetype from = qsizetype(first - m_entries.begin());
+    const qsizetype to = qsizetype(last - m_entries.begin());
+    heap.push_back({from, to, maxIn(from, to)});
+
+    out.reserve(std::size_t(std::min(limit, to - from)));
+    while (!heap.empty() && qsizetype(out.size()) < limit) {
+        std::pop_heap(heap.begin(), heap.end(), worse);
+        const Range range = heap.back();
+        heap.pop_back();
+
+        const Entry &entry = m_entries[std::size_t(range.best)];
+        out.push_back({entry.id, entry.name, entry.usage});
+
+        if (range.from < range.best) {
+            heap.push_back({range.from, range.best, maxIn(range.from, range.best)});
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+        if (range.best + 1 < range.to) {
+            heap.push_back({range.best + 1, range.to, maxIn(range.best + 1, range.to)});
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+    }
+    return out;
+}
+
+qsizetype TagSuggestIndex::better(qsizetype a, qsizetype b) const {
+    if (a < 0) {
+        return b;
+    }
+    if (b < 0) {
+        return a;
+    }
+    const qint64 usageA = m_entries[std::size_t(a)].usage;
+    const qint64 usageB = m_entries[std::size_t(b)].usage;
+    if (usageA != usageB) {
+        return usageA > usageB ? a : b;
+    }
+    return std::min(a, b);
+}
+
+void TagSuggestIndex::rebuildTree() const {
+    const qsizetype count = qsizetype(m_entries.size());
+    m_leaves = 1;
+    while (m_leaves < count) {
+        m_leaves *= 2;
+    }
+
+    m_tree.assign(std::size_t(2 * m_leaves), -1);
+    for (qsizetype i = 0; i < count; ++i) {
+        m_tree[std::size_t(m_leaves + i)] = qint32(i);
+    }
+    for (qsizetype node = m_leaves - 1; node >= 1; --node) {
+        m_tree[std::size_t(node)] =
+            qint32(better(m_tree[std::size_t(2 * node)], m_tree[std::size_t(2 * node + 1)]));
+    }
+    m_treeDirty = false;
+}
+
+void TagSuggestIndex::updateTree(qsizetype position) const {
+    for (qsizetype node = (m_leaves + position) / 2; node >= 1; node /= 2) {
+        m_tree[std::size_t(node)] =
+            qint32(better(m_tree[std::size_t(2 * node)], m_tree[std::size_t(2 * node + 1)]));
+    }
+}
+
+qsizetype TagSuggestIndex::maxIn(qsizetype from, qsizetype to) const {
+    qsizetype best = -1;
+    for (qsizetype l = from + m_leaves, r = to + m_leaves; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            best = better(best, m_tree[std::size_t(l++)]);
+        }
+        if (r & 1) {
+            best = better(best, m_tree[std::size_t(--r)]);
+        }
+    }
+    return best;
+}
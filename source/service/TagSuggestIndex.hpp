@@ -0,0 +1,67 @@
+#ifndef TASKLIT_SERVICE_TAGSUGGESTINDEX_HPP
+#define TASKLIT_SERVICE_TAGSUGGESTINDEX_HPP
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QUuid>
+
+#include <vector>
+
+struct TagSuggestion {
+    QUuid id;
+    QString name;
+    qint64 usage = 0;
+};
+
+// Индекс имён тегов для автодополнения (GET /tags/suggest). Массив,
+// отсортированный по имени в case-folded форме: префикс — непрерывный
+// диапазон (два бинарных поиска), а top-k по частоте использования внутри
+// диапазона берётся из дерева отрезков максимумов за O(k log n) вместо
+// просмотра всего диапазона.
+//
+// Вставка и удаление сдвигают массив и помечают дерево устаревшим; оно
+// перестраивается одним проходом при следующем запросе. Не потокобезопасен
+// (используется из потока HTTP-сервера).
+class TagSuggestIndex {
+public:
+    // Полная перестройка (старт сервиса): одна сортировка вместо n вставок
+    void reset(std::vector<TagSuggestion> tags);
+    void clear();
+
+    // Тег с уже известным id не добавляется повторно
+    void insert(const QUuid &id, const QString &name, qint64 usage = 0);
+    void remove(const QUuid &id);
+    void addUsage(const QUuid &id, qint64 delta);
+
+    // До limit тегов с именем, начинающимся с prefix (без учёта регистра):
+    // по убыванию usage, при равенстве — по имени
+    std::vector<TagSuggestion> suggest(QStringView prefix, qsizetype limit) const;
+
+    qsizetype size() const { return qsizetype(m_entries.size()); }
+
+private:
+    struct Entry {
+        QString folded;
+        QString name;
+        QUuid id;
+        qint64 usage = 0;
+    };
+
+    qsizetype find(const QUuid &id) const;
+    void rebuildTree() const;
+    void updateTree(qsizetype position) const;
+    // Позиция максимального usage в [from, to); при равенстве — меньшая
+    qsizetype maxIn(qsizetype from, qsizetype to) const;
+    qsizetype better(qsizetype a, qsizetype b) const;
+
+    std::vector<Entry> m_entries; // по (folded, name)
+    QHash<QUuid, QString> m_foldedById;
+
+    // Дерево отрезков по позициям m_entries: узел — позиция максимума
+    mutable std::vector<qint32> m_tree;
+    mutable qsizetype m_leaves = 0;
+    mutable bool m_treeDirty = true;
+};
+
+#endif // TASKLIT_SERVICE_TAGSUGGESTINDEX_HPP
@@ -0,0 +1,115 @@
+#include "TaskChangeFeed.hpp"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+#include "JsonWriter.hpp"
+
+TaskChangeFeed::TaskChangeFeed(qsizetype capacity)
+    : m_ring(static_cast<std::size_t>(std::max<qsizetype>(1, capacity))),
+      m_epoch(QByteArray::number(QRandomGenerator::system()->generate64(), 16)
+                  .rightJustified(16, '0')) {}
+
+std::optional<quint64> TaskChangeFeed::parseEventId(QByteArrayView raw) const {
+    const qsizetype dash = raw.indexOf('-');
+    if (dash < 0 || raw.first(dash) != m_epoch) {
+        return std::nullopt;
+    }
+    bool ok = false;
+    const quint64 id = raw.sliced(dash + 1).toULongLong(&ok);
+    return ok ? std::optional<quint64>(id) : std::nullopt;
+}
+
+const char *TaskChangeFeed::kindName(Kind kind) {
+    switch (kind) {
+    case Kind::Created: return "task.created";
+    case Kind::Updated: return "task.updated";
+    case Kind::Deleted: return "task.deleted";
+    case Kind::Cleared: return "tasks.cleared";
+    case Kind::Changed: return "tasks.changed";
+    }
+    return "task.unknown";
+}
+
+quint64 TaskChangeFeed::publish(Kind kind, const QUuid &taskId, const Task *task) {
+    const quint64 id = m_nextId++;
+    const char *name = kindName(kind);
+
+    QByteArray frame;
+    frame.reserve(task ? 384 : 160);
+    frame.append("id: ");
+    frame.append(m_epoch);
+    frame.append('-');
+    frame.append(QByteArray::number(id));
+    frame.append("\nevent: ");
+    frame.append(name);
+    frame.append("\ndata: {\"type\":\"");
+    frame.append(name);
+    frame.append('"');
+    if (!taskId.isNull()) {
+        frame.append(",\"id\":");
+        writeJsonUuid(frame, taskId);
+    }
+    if (task) {
+        frame.append(",\"task\":");
+        writeTaskJson(frame, *task);
+    }
+    frame.append(",\"ts\":");
+    writeJsonTimestamp(frame);
+    frame.append("}\n\n");
+
+    const qsizetype capacity = static_cast<qsizetype>(m_ring.size());
+    qsizetype slot = 0;
+    if (m_size < capacity) {
+        slot = (m_head + m_size) % capacity;
+        ++m_size;
+    } else {
+        slot = m_head;
+        m_head = (m_head + 1) % capacity;
+    }
+    m_ring[static_cast<std::size_t>(slot)] = Event{id, std::move(frame)};
+
+    if (m_listener) {
+        m_listener();
+    }
+    return id;
+}
+
+bool TaskChangeFeed::readSince(quint64 afterId, qsizetype maxBytes,
+                               QByteArray &out, quint64 &lastRead) const {
+    lastRead = afterId;
+    if (afterId >= lastId()) {
+        return true;
+    }
+    if (m_size == 0) {
+        return false;
+    }
+
+    const quint64 oldestId = m_ring[static_cast<std::size_t>(m_head)].id;
+    if (afterId + 1 < oldestId) {
+        return false;
+    }
+
+    const qsizetype capacity = static_cast<qsizetype>(m_ring.size());
+    qsizetype offset = static_cast<qsizetype>(afterId + 1 - oldestId);
+    for (; offset < m_size; ++offset) {
+        const Event &event =
+            m_ring[static_cast<std::size_t>((m_head + offset) % capacity)];
+        if (!out.isEmpty() && out.size() + event.frame.size() > maxBytes) {
+            break;
+        }
+        // Одно событие — разделяемая копия кадра без memcpy
+        if (out.isEmpty()) {
+            out = event.frame;
+        } else {
+            out.append(event.frame);
+        }
+        lastRead = event.id;
+    }
+    return true;
+}
+
+void TaskChangeFeed::setListener(std::function<void()> listener) {
+    m_listener = std::move(listener);
+}
@@ -0,0 +1,64 @@
+#ifndef TASKLIT_SERVICE_TASKCHANGEFEED_HPP
+#define TASKLIT_SERVICE_TASKCHANGEFEED_HPP
+
+#include <QByteArray>
+#include <QUuid>
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "Task.hpp"
+
+// Лента изменений задач для GET /tasks/stream. Каждое событие сериализуется
+// один раз в готовый SSE-кадр ("id/event/data") и хранится в кольце
+// фиксированной ёмкости; подписчики читают кольцо со своей позиции, так что
+// рассылка N подписчикам не сериализует событие N раз.
+// SSE-id события — "<epoch>-<id>": id начинаются с 1 в каждом процессе, а
+// случайная эпоха отличает Last-Event-ID предыдущего запуска.
+// Не потокобезопасна: публикация и чтение — из потока HTTP-сервера.
+class TaskChangeFeed {
+public:
+    // Changed — изменено множество задач (POST /tasks/bulk, удаление тегов)
+    // без перечисления: клиенту нужно перечитать список
+    enum class Kind { Created, Updated, Deleted, Cleared, Changed };
+
+    explicit TaskChangeFeed(qsizetype capacity = 4096);
+
+    // task == nullptr для Deleted / Cleared / Changed
+    quint64 publish(Kind kind, const QUuid &taskId, const Task *task);
+
+    // id последнего опубликованного события (0 — событий не было)
+    quint64 lastId() const { return m_nextId - 1; }
+
+    // Эпоха этого процесса: 16 hex-символов
+    const QByteArray &epoch() const { return m_epoch; }
+
+    // SSE-id "<epoch>-<id>" → id; nullopt — другая эпоха или не наш формат
+    std::optional<quint64> parseEventId(QByteArrayView raw) const;
+
+    // Кадры событий с id > afterId, не больше maxBytes (минимум одно событие).
+    // false — события после afterId уже вытеснены из кольца.
+    bool readSince(quint64 afterId, qsizetype maxBytes, QByteArray &out,
+                   quint64 &lastRead) const;
+
+    // Вызывается после каждой публикации
+    void setListener(std::function<void()> listener);
+
+    static const char *kindName(Kind kind);
+
+private:
+    struct Event {
+        quint64 id = 0;
+        QByteArray frame;
+    };
+
+    std::vector<Event> m_ring;
+    qsizetype m_head = 0;  // позиция самого старого события
+    qsizetype m_size = 0;
+    quint64 m_nextId = 1;
+    QByteArray m_epoch;
+    std::function<void()> m_listener;
+};
+
+#endif // TASKLIT_SERVICE_TASKCHANGEFEED_HPP
@@ -1,29 +1,67 @@
 #include "Logger.hpp"
+#include "Metrics.hpp"
 #include "TaskServiceImpl.hpp"
+#include "Tracing.hpp"
+#include "UuidCodec.hpp"
 
+#include <QDateTime>
 #include <QSet>
+#include <algorithm>
+
+namespace {
+
+constexpr qsizetype kIdempotencyCacheCapacity = 10000;
+constexpr qint64 kIdempotencyTtlMs = 24LL * 60 * 60 * 1000;
+// Как часто (в записях) чистить просроченные ключи в хранилище
+constexpr quint32 kIdempotencyPurgeEvery = 256;
+
+QVector<QUuid> uniqueTagIds(const QVector<QUuid> &tagIds) {
+    QVector<QUuid> unique;
+    QSet<QUuid> seen;
+    for (const QUuid &tid : tagIds) {
+        if (!tid.isNull() && !seen.contains(tid)) {
+            unique.push_back(tid);
+            seen.insert(tid);
+        }
+    }
+    return unique;
+}
+
+} // namespace
 
 TaskServiceImpl::TaskServiceImpl(std::shared_ptr<IStorage> storage)
-    : m_storage(std::move(storage)) {}
+    : m_storage(std::move(storage)),
+    m_idempotency(kIdempotencyCacheCapacity, kIdempotencyTtlMs) {
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    m_storage->purgeIdempotencyRecords(nowMs - m_idempotency.ttlMs());
+    reloadTagIndex();
+}
 
 // ───────────────────────────────────────────────
 // Tasks
 // ───────────────────────────────────────────────
 
 std::vector<Task> TaskServiceImpl::getAllTasks() const {
+    tracing::Span span("service.getAllTasks");
     auto tasks = m_storage->getAllTasks();
     qInfo(appCore) << "[Server] Retrieved" << tasks.size() << "tasks";
     return tasks;
 }
 
 std::optional<Task> TaskServiceImpl::getTaskById(const QUuid &taskId) const {
+    return getTaskById(taskId, TaskFields::all());
+}
+
+std::optional<Task> TaskServiceImpl::getTaskById(const QUuid &taskId,
+                                                 TaskFields fields) const {
+    tracing::Span span("service.getTaskById");
     if (taskId.isNull()) {
         qWarning(appCore) << "[Server] getTaskById called with null id";
         return std::nullopt;
     }
-    auto task = m_storage->getTaskById(taskId);
+    auto task = m_storage->getTaskById(taskId, fields);
     if (task) {
-        qInfo(appCore) << "[Server] Task found:" << task->title;
+        qInfo(appCore) << "[Server] Task found:" << task->id.toString();
     } else {
         qWarning(appCore) << "[Server] Task with id" << taskId.toString()
         << "not found";
@@ -31,7 +69,42 @@ std::optional<Task> TaskServiceImpl::getTaskById(const QUuid &taskId) const {
     return task;
 }
 
+bool TaskServiceImpl::forEachTask(
+    const std::function<bool(const Task &)> &visitor) const {
+    return forEachTask(TaskFields::all(), visitor);
+}
+
+bool TaskServiceImpl::forEachTask(
+    TaskFields fields, const std::function<bool(const Task &)> &visitor) const {
+    tracing::Span span("service.forEachTask");
+    qsizetype visited = 0;
+    const bool ok = m_storage->forEachTask(fields, [&](const Task &task) {
+        ++visited;
+        return visitor(task);
+    });
+    qInfo(appCore) << "[Server] Streamed" << visited << "tasks";
+    return ok;
+}
+
+bool TaskServiceImpl::forEachTaskBatch(
+    const TaskScan &scan, const std::function<bool(const TaskBatch &)> &visitor) const {
+    tracing::Span span("service.forEachTaskBatch");
+    qsizetype visited = 0;
+    const bool ok = m_storage->forEachTaskBatch(scan, [&](const TaskBatch &batch) {
+        visited += batch.size();
+        return visitor(batch);
+    });
+    qInfo(appCore) << "[Server] Streamed" << visited << "tasks in batches";
+    return ok;
+}
+
+std::optional<TaskQueryPlan> TaskServiceImpl::explainTaskScan(const TaskScan &scan) const {
+    tracing::Span span("service.explainTaskScan");
+    return m_storage->explainTaskScan(scan);
+}
+
 QUuid TaskServiceImpl::addTask(const Task &task) {
+    tracing::Span span("service.addTask");
     if (task.title.trimmed().isEmpty()) {
         qWarning(appCore) << "[Server] Attempt to add task with empty title";
         return QUuid();
@@ -39,25 +112,18 @@ QUuid TaskServiceImpl::addTask(const Task &task) {
 
     auto toStore = task;
     if (toStore.id.isNull()) {
-        toStore.id = QUuid::createUuid();
+        toStore.id = createUuidV7();
     }
 
-    {
-        QVector<QUuid> unique;
-        QSet<QUuid> seen;
-        for (const QUuid &tid : std::as_const(toStore.tags)) {
-            if (!tid.isNull() && !seen.contains(tid)) {
-                unique.push_back(tid);
-                seen.insert(tid);
-            }
-        }
-        toStore.tags = std::move(unique);
-    }
+    toStore.tags = uniqueTagIds(toStore.tags);
 
     const QUuid storedId = m_storage->addTask(toStore);
     if (!storedId.isNull()) {
         qInfo(appCore) << "[Server] Task added:" << toStore.title
                        << "(id=" << storedId.toString() << ")";
+        toStore.id = storedId;
+        noteTagUsage(toStore.tags, 1);
+        m_changeFeed.publish(TaskChangeFeed::Kind::Created, storedId, &toStore);
     } else {
         qCritical(appCore) << "[Server] Failed to add task:" << toStore.title;
     }
@@ -65,59 +131,64 @@ QUuid TaskServiceImpl::addTask(const Task &task) {
     return storedId;
 }
 
-bool TaskServiceImpl::updateTask(const QUuid &taskId, const Task &task) {
+TaskMutationResult TaskServiceImpl::patchTask(const QUuid &taskId,
+                                              const TaskPatch &patch) {
+    tracing::Span span("service.patchTask");
     if (taskId.isNull()) {
-        qWarning(appCore) << "[Server] Attempt to update task with null id";
-        return false;
+        qWarning(appCore) << "[Server] Attempt to patch task with null id";
+        TaskMutationResult result;
+        result.error = QStringLiteral("validation_error");
+        result.message = QStringLiteral("Invalid 'id' (expected UUID)");
+        return result;
     }
 
-    Task toSave = task;
-    toSave.id = taskId;
-
-    QVector<QUuid> unique;
-    QSet<QUuid> seen;
-    for (const QUuid &tid : std::as_const(toSave.tags)) {
-        if (!tid.isNull() && !seen.contains(tid)) {
-            unique.push_back(tid);
-            seen.insert(tid);
-        }
+    TaskPatch normalized = patch;
+    if (normalized.tags) {
+        normalized.tags = uniqueTagIds(*normalized.tags);
     }
-    toSave.tags = std::move(unique);
 
-    bool ok = m_storage->updateTask(taskId, toSave);
-    if (ok) {
-        qInfo(appCore) << "[Server] Task updated:" << toSave.title
-                       << "(id=" << taskId.toString() << ")";
+    TaskMutationResult result = m_storage->patchTask(taskId, normalized);
+    if (result.ok) {
+        qInfo(appCore) << "[Server] Task patched (id=" << taskId.toString() << ")";
+        noteTagUsage(result.tagsAdded, 1);
+        noteTagUsage(result.tagsRemoved, -1);
+        publishMutation(TaskMutation::Kind::Patch, result);
     } else {
-        qCritical(appCore) << "[Server] Failed to update task (id="
-                           << taskId.toString() << ")";
+        qWarning(appCore) << "[Server] Failed to patch task (id="
+                          << taskId.toString() << "):" << result.error;
     }
 
-    return ok;
+    return result;
 }
 
 bool TaskServiceImpl::deleteTask(const QUuid &taskId) {
+    tracing::Span span("service.deleteTask");
     if (taskId.isNull()) {
         qWarning(appCore) << "[Server] Attempt to delete task with null id";
         return false;
     }
 
-    bool ok = m_storage->deleteTask(taskId);
-    if (ok) {
+    const TaskMutationResult result = m_storage->deleteTask(taskId);
+    if (result.ok) {
         qInfo(appCore) << "[Server] Task deleted (id=" << taskId.toString()
         << ")";
+        noteTagUsage(result.tagsRemoved, -1);
+        m_changeFeed.publish(TaskChangeFeed::Kind::Deleted, taskId, nullptr);
     } else {
         qCritical(appCore) << "[Server] Failed to delete task (id="
                            << taskId.toString() << ")";
     }
 
-    return ok;
+    return result.ok;
 }
 
 bool TaskServiceImpl::deleteAll() {
+    tracing::Span span("service.deleteAll");
     bool ok = m_storage->deleteAll();
     if (ok) {
         qInfo(appCore) << "[Server] All tasks deleted";
+        m_tagIndex.clear();
+        m_changeFeed.publish(TaskChangeFeed::Kind::Cleared, QUuid(), nullptr);
     } else {
         qCritical(appCore) << "[Server] Failed to delete all tasks";
     }
@@ -125,20 +196,306 @@ bool TaskServiceImpl::deleteAll() {
     return ok;
 }
 
+std::vector<TaskMutationResult>
+TaskServiceImpl::applyMutations(const std::vector<TaskMutation> &ops,
+                                bool atomic) {
+    tracing::Span span("service.applyMutations");
+    std::vector<TaskMutationResult> results(ops.size());
+
+    // Валидация до обращения к хранилищу: невалидные операции в хранилище не
+    // попадают, в atomic-режиме весь пакет отклоняется без транзакции.
+    std::vector<TaskMutation> accepted;
+    std::vector<std::size_t> acceptedIndex;
+    accepted.reserve(ops.size());
+    acceptedIndex.reserve(ops.size());
+
+    std::optional<std::size_t> invalidAt;
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        TaskMutation op = ops[i];
+
+        QString error;
+        switch (op.kind) {
+        case TaskMutation::Kind::Create:
+            if (op.task.title.trimmed().isEmpty()) {
+                error = QStringLiteral("Field 'title' is required and must be non-empty");
+                break;
+            }
+            if (op.task.id.isNull()) {
+                op.task.id = createUuidV7();
+            }
+            op.task.tags = uniqueTagIds(op.task.tags);
+            op.id = op.task.id;
+            break;
+        case TaskMutation::Kind::Patch:
+            if (op.id.isNull()) {
+                error = QStringLiteral("Invalid 'id' (expected UUID)");
+                break;
+            }
+            if (op.patch.tags) {
+                op.patch.tags = uniqueTagIds(*op.patch.tags);
+            }
+            break;
+        case TaskMutation::Kind::Delete:
+            if (op.id.isNull()) {
+                error = QStringLiteral("Invalid 'id' (expected UUID)");
+            }
+            break;
+        }
+
+        if (!error.isEmpty()) {
+            results[i].id = op.id;
+            results[i].error = QStringLiteral("validation_error");
+            results[i].message = error;
+            if (atomic) {
+                invalidAt = i;
+                break;
+            }
+            continue;
+        }
+
+        accepted.push_back(std::move(op));
+        acceptedIndex.push_back(i);
+    }
+
+    if (invalidAt) {
+        qWarning(appCore) << "[Server] Batch rejected: op" << *invalidAt
+                          << "is invalid";
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            if (i != *invalidAt) {
+                results[i].id = ops[i].id;
+                results[i].error = QStringLiteral("skipped");
+                results[i].message =
+                    QStringLiteral("Not applied: operation #%1 failed")
+                        .arg(*invalidAt);
+            }
+        }
+        return results;
+    }
+
+    if (!accepted.empty()) {
+        auto stored = m_storage->applyMutations(accepted, atomic);
+        for (std::size_t k = 0; k < stored.size(); ++k) {
+            if (stored[k].ok) {
+                if (accepted[k].kind == TaskMutation::Kind::Create) {
+                    noteTagUsage(accepted[k].task.tags, 1);
+                } else {
+                    noteTagUsage(stored[k].tagsAdded, 1);
+                    noteTagUsage(stored[k].tagsRemoved, -1);
+                }
+                publishMutation(accepted[k].kind, stored[k]);
+            }
+            results[acceptedIndex[k]] = std::move(stored[k]);
+        }
+    }
+
+    const auto applied = std::count_if(results.begin(), results.end(),
+                                       [](const TaskMutationResult &r) {
+                                           return r.ok;
+                                       });
+    qInfo(appCore) << "[Server] Batch applied:" << applied << "of"
+                   << ops.size() << "ops (atomic=" << atomic << ")";
+
+    return results;
+}
+
+TaskBulkResult TaskServiceImpl::applyBulk(const TaskBulkOp &op) {
+    tracing::Span span("service.applyBulk");
+
+    TaskBulkOp normalized = op;
+    normalized.tags = uniqueTagIds(op.tags);
+    normalized.filter.tags = uniqueTagIds(op.filter.tags);
+
+    const bool tagOp = op.kind == TaskBulkOp::Kind::AddTags ||
+                       op.kind == TaskBulkOp::Kind::RemoveTags;
+    if (tagOp && normalized.tags.isEmpty()) {
+        TaskBulkResult result;
+        result.error = QStringLiteral("validation_error");
+        result.message = QStringLiteral("Field 'tags' must contain at least one tag id");
+        return result;
+    }
+    if (!tagOp) {
+        normalized.tags.clear();
+    }
+
+    TaskBulkResult result = m_storage->applyBulk(normalized);
+    if (result.ok) {
+        qInfo(appCore) << "[Server] Bulk operation applied, affected=" << result.affected;
+        // Счётчики использования после массового изменения связей — заново из хранилища
+        if (result.affected > 0 && normalized.kind != TaskBulkOp::Kind::SetCompleted) {
+            reloadTagIndex();
+        }
+        if (result.affected > 0) {
+            m_changeFeed.publish(TaskChangeFeed::Kind::Changed, QUuid(), nullptr);
+        }
+    } else {
+        qWarning(appCore) << "[Server] Bulk operation failed:" << result.error;
+    }
+    return result;
+}
+
+void TaskServiceImpl::publishMutation(TaskMutation::Kind kind,
+                                      const TaskMutationResult &result) {
+    switch (kind) {
+    case TaskMutation::Kind::Create:
+        m_changeFeed.publish(TaskChangeFeed::Kind::Created, result.id,
+                             result.task ? &*result.task : nullptr);
+        break;
+    case TaskMutation::Kind::Patch:
+        m_changeFeed.publish(TaskChangeFeed::Kind::Updated, result.id,
+                             result.task ? &*result.task : nullptr);
+        break;
+    case TaskMutation::Kind::Delete:
+        m_changeFeed.publish(TaskChangeFeed::Kind::Deleted, result.id, nullptr);
+        break;
+    }
+}
+
+std::optional<TaskStats> TaskServiceImpl::getTaskStats() const {
+    tracing::Span span("service.getTaskStats");
+    return m_storage->getTaskStats();
+}
+
+TaskChangeFeed &TaskServiceImpl::changeFeed() {
+    return m_changeFeed;
+}
+
 std::vector<Tag> TaskServiceImpl::getAllTags() const {
+    tracing::Span span("service.getAllTags");
     return m_storage->getAllTags();
 }
 
+bool TaskServiceImpl::forEachTag(
+    const std::function<bool(const Tag &)> &visitor) const {
+    tracing::Span span("service.forEachTag");
+    return m_storage->forEachTag(visitor);
+}
+
+bool TaskServiceImpl::forEachTagUsage(
+    const std::function<bool(const Tag &, qint64 taskCount)> &visitor) const {
+    tracing::Span span("service.forEachTagUsage");
+    return m_storage->forEachTagUsage(visitor);
+}
+
+std::optional<Tag> TaskServiceImpl::getTagById(const QUuid &tagId) const {
+    tracing::Span span("service.getTagById");
+    if (tagId.isNull()) {
+        return std::nullopt;
+    }
+    return m_storage->getTagById(tagId);
+}
+
 QUuid TaskServiceImpl::addTag(const Tag &tag) {
+    tracing::Span span("service.addTag");
     if (tag.name.trimmed().isEmpty()) {
         return QUuid();
     }
 
     Tag toStore = tag;
     if (toStore.id.isNull()) {
-        toStore.id = QUuid::createUuid();
+        toStore.id = createUuidV7();
     }
 
     const QUuid storedId = m_storage->addTag(toStore);
+    if (!storedId.isNull()) {
+        m_tagIndex.insert(storedId, toStore.name);
+    }
     return storedId;
 }
+
+std::vector<TagSuggestion> TaskServiceImpl::suggestTags(QStringView prefix,
+                                                        qsizetype limit) const {
+    tracing::Span span("service.suggestTags");
+    return m_tagIndex.suggest(prefix, limit);
+}
+
+void TaskServiceImpl::reloadTagIndex() {
+    tracing::Span span("service.reloadTagIndex");
+    std::vector<TagSuggestion> tags;
+    m_storage->forEachTagUsage([&tags](const Tag &tag, qint64 taskCount) {
+        tags.push_back({tag.id, tag.name, taskCount});
+        return true;
+    });
+    m_tagIndex.reset(std::move(tags));
+    qInfo(appCore) << "[Server] Tag suggest index built:" << m_tagIndex.size() << "tags";
+}
+
+void TaskServiceImpl::noteTagUsage(const QVector<QUuid> &tagIds, qint64 delta) {
+    for (const QUuid &id : tagIds) {
+        m_tagIndex.addUsage(id, delta);
+    }
+}
+
+DeleteResult TaskServiceImpl::deleteTag(const QUuid &tagId) {
+    tracing::Span span("service.deleteTag");
+    if (tagId.isNull()) {
+        qWarning(appCore) << "[Server] Attempt to delete tag with null id";
+        return DeleteResult::NotFound;
+    }
+
+    const TagDeleteResult result = m_storage->deleteTag(tagId);
+    if (result.status == DeleteResult::Deleted) {
+        qInfo(appCore) << "[Server] Tag deleted (id=" << tagId.toString()
+                       << ", links=" << result.linksRemoved << ")";
+        m_tagIndex.remove(tagId);
+        // У задач с этим тегом изменился список tags
+        if (result.linksRemoved > 0) {
+            m_changeFeed.publish(TaskChangeFeed::Kind::Changed, QUuid(), nullptr);
+        }
+    } else if (result.status == DeleteResult::Failed) {
+        qCritical(appCore) << "[Server] Failed to delete tag (id=" << tagId.toString() << ")";
+    }
+    return result.status;
+}
+
+bool TaskServiceImpl::deleteAllTags() {
+    tracing::Span span("service.deleteAllTags");
+    const std::optional<qint64> linksRemoved = m_storage->deleteAllTags();
+    if (linksRemoved) {
+        qInfo(appCore) << "[Server] All tags deleted, links=" << *linksRemoved;
+        m_tagIndex.clear();
+        if (*linksRemoved > 0) {
+            m_changeFeed.publish(TaskChangeFeed::Kind::Changed, QUuid(), nullptr);
+        }
+    } else {
+        qCritical(appCore) << "[Server] Failed to delete all tags";
+    }
+    return linksRemoved.has_value();
+}
+
+// ───────────────────────────────────────────────
+// Idempotency keys
+// ───────────────────────────────────────────────
+
+std::optional<IdempotencyRecord>
+TaskServiceImpl::findIdempotencyRecord(const QString &key) {
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    if (auto cached = m_idempotency.get(key, nowMs)) {
+        metrics::cacheHit("idempotency");
+        return cached;
+    }
+    metrics::cacheMiss("idempotency");
+
+    auto stored = m_storage->getIdempotencyRecord(key);
+    if (!stored || stored->createdAtMs + m_idempotency.ttlMs() <= nowMs) {
+        return std::nullopt;
+    }
+
+    m_idempotency.put(*stored);
+    return stored;
+}
+
+void TaskServiceImpl::rememberIdempotencyRecord(const IdempotencyRecord &record) {
+    m_idempotency.put(record);
+    if (!m_storage->putIdempotencyRecord(record)) {
+        qWarning(appCore) << "[Server] Idempotency key kept in memory only:"
+                          << record.key;
+    }
+
+    if (++m_idempotencyWrites % kIdempotencyPurgeEvery == 0) {
+        const int purged = m_storage->purgeIdempotencyRecords(
+            record.createdAtMs - m_idempotency.ttlMs());
+        if (purged > 0) {
+            qInfo(appCore) << "[Server] Purged" << purged << "expired idempotency keys";
+        }
+    }
+}
@@ -2,12 +2,16 @@
 #define TASKLIT_SERVICE_TASKSERVICEIMPL_HPP
 
 #include <QUuid>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <vector>
 
 #include "IStorage.hpp"
+#include "IdempotencyCache.hpp"
+#include "TaskChangeFeed.hpp"
 #include "ITaskService.hpp"
+#include "TagSuggestIndex.hpp"
 
 class TaskServiceImpl : public ITaskService {
 public:
@@ -15,17 +19,51 @@ public:
 
     std::vector<Task> getAllTasks() const override;
     std::optional<Task> getTaskById(const QUuid &taskId) const override;
+    std::optional<Task> getTaskById(const QUuid &taskId, TaskFields fields) const override;
+    bool forEachTask(const std::function<bool(const Task &)> &visitor) const override;
+    bool forEachTask(TaskFields fields,
+                     const std::function<bool(const Task &)> &visitor) const override;
+    bool forEachTaskBatch(const TaskScan &scan,
+                          const std::function<bool(const TaskBatch &)> &visitor) const override;
+    std::optional<TaskQueryPlan> explainTaskScan(const TaskScan &scan) const override;
 
     QUuid addTask(const Task &task) override;
-    bool updateTask(const QUuid &taskId, const Task &task) override;
+    TaskMutationResult patchTask(const QUuid &taskId, const TaskPatch &patch) override;
     bool deleteTask(const QUuid &taskId) override;
     bool deleteAll() override;
 
+    std::vector<TaskMutationResult>
+    applyMutations(const std::vector<TaskMutation> &ops, bool atomic) override;
+    TaskBulkResult applyBulk(const TaskBulkOp &op) override;
+    std::optional<TaskStats> getTaskStats() const override;
+
+    TaskChangeFeed &changeFeed() override;
+
     std::vector<Tag> getAllTags() const override;
+    bool forEachTag(const std::function<bool(const Tag &)> &visitor) const override;
+    std::optional<Tag> getTagById(const QUuid &tagId) const override;
+    bool forEachTagUsage(
+        const std::function<bool(const Tag &, qint64 taskCount)> &visitor) const override;
     QUuid addTag(const Tag &tag) override;
+    std::vector<TagSuggestion> suggestTags(QStringView prefix, qsizetype limit) const override;
+    DeleteResult deleteTag(const QUuid &tagId) override;
+    bool deleteAllTags() override;
+
+    std::optional<IdempotencyRecord> findIdempotencyRecord(const QString &key) override;
+    void rememberIdempotencyRecord(const IdempotencyRecord &record) override;
 
 private:
+    void publishMutation(TaskMutation::Kind kind, const TaskMutationResult &result);
+    void reloadTagIndex();
+    // Изменение связей тегов с задачей (создание, patch, удаление): delta к
+    // usage в индексе автодополнения
+    void noteTagUsage(const QVector<QUuid> &tagIds, qint64 delta);
+
     std::shared_ptr<IStorage> m_storage;
+    TaskChangeFeed m_changeFeed;
+    TagSuggestIndex m_tagIndex;
+    IdempotencyCache m_idempotency;
+    quint32 m_idempotencyWrites = 0;
 };
 
 #endif // TASKLIT_SERVICE_TASKSERVICEIMPL_HPP
@@ -1,11 +1,130 @@
 #ifndef TASKLIT_STORAGE_ISTORAGE_HPP
 #define TASKLIT_STORAGE_ISTORAGE_HPP
 
+#include <functional>
 #include <vector>
 #include <optional>
+#include <QStringList>
 #include <QUuid>
+#include <QVector>
 #include "Task.hpp"
 #include "Tag.hpp"
+#include "TaskBatch.hpp"
+#include "TaskFields.hpp"
+#include "TaskPatch.hpp"
+
+// Одна операция пакетного изменения (POST /tasks/batch)
+struct TaskMutation {
+    enum class Kind { Create, Patch, Delete };
+
+    Kind kind = Kind::Create;
+    QUuid id;        // Patch / Delete
+    Task task;       // Create
+    TaskPatch patch; // Patch
+};
+
+struct TaskMutationResult {
+    bool ok = false;
+    QString error;   // not_found | validation_error | internal_error | skipped | rolled_back
+    QString message;
+    QUuid id;
+    std::optional<Task> task;
+    // Фактически добавленные и снятые связи с тегами (для счётчиков usage):
+    // Patch с tags — разность, Delete — все теги задачи
+    QVector<QUuid> tagsAdded;
+    QVector<QUuid> tagsRemoved;
+};
+
+// Набор задач для списков (GET /tasks) и операций над множеством
+// (POST /tasks/bulk). Условия объединяются через AND; пустой фильтр — все задачи
+struct TaskFilter {
+    QVector<QUuid> ids;
+    std::optional<bool> isCompleted;
+    QVector<QUuid> tags;   // есть хотя бы один из тегов
+    QString titlePrefix;   // title начинается с (диапазон по idx_tasks_title)
+    QString titleContains; // подстрока title (LIKE, регистр ASCII не важен)
+
+    bool isEmpty() const {
+        return ids.isEmpty() && !isCompleted && tags.isEmpty() && titlePrefix.isEmpty() &&
+               titleContains.isEmpty();
+    }
+};
+
+// Предел длины списков в фильтре и операции: все значения одного оператора
+// остаются ниже SQLITE_MAX_VARIABLE_NUMBER старых сборок (999)
+inline constexpr qsizetype kMaxBulkListSize = 200;
+
+// Операция над всеми задачами под фильтром — один SQL-оператор
+struct TaskBulkOp {
+    enum class Kind { SetCompleted, Delete, AddTags, RemoveTags };
+
+    Kind kind = Kind::SetCompleted;
+    TaskFilter filter;
+    bool isCompleted = true; // SetCompleted
+    QVector<QUuid> tags;     // AddTags / RemoveTags
+};
+
+struct TaskBulkResult {
+    bool ok = false;
+    QString error;   // validation_error | not_found | internal_error
+    QString message;
+    // Изменённые строки: задачи (SetCompleted, Delete) или связи с тегами
+    // (AddTags, RemoveTags); строки, уже бывшие в нужном состоянии, не считаются
+    qint64 affected = 0;
+};
+
+// Порядок списка задач; Insertion — по rowid (порядок вставки)
+enum class TaskSort { Insertion, IdAsc, IdDesc, TitleAsc, TitleDesc };
+
+// Пакетное чтение списка задач в TaskBatch с keyset-пагинацией. Курсор —
+// ключ сортировки последней строки предыдущей страницы:
+//   Insertion       — afterRowId;
+//   IdAsc / IdDesc  — afterTaskId;
+//   TitleAsc / Desc — (afterTitle, afterRowId), rowid различает равные title.
+struct TaskScan {
+    TaskFields fields;
+    TaskFilter filter;
+    TaskSort sort = TaskSort::Insertion;
+    qint64 afterRowId = 0;         // Insertion: только строки с rowid > afterRowId
+    QUuid afterTaskId;             // null — с начала
+    std::optional<QString> afterTitle;
+    qsizetype limit = -1;      // -1 — без ограничения
+    qsizetype batchSize = 512; // строк на один вызов visitor'а
+    // Не null — только задачи с этим тегом (индекс task_tags(tag_id, task_id)):
+    // порядок и keyset по id задачи; filter и sort не используются
+    QUuid tagId;
+};
+
+// EXPLAIN QUERY PLAN для списка задач (GET /tasks?explain=1)
+struct TaskQueryPlan {
+    QString sql;
+    QStringList steps; // строки плана с отступом по вложенности
+};
+
+// Счётчики задач; обновляются триггерами в той же транзакции, что и запись
+struct TaskStats {
+    qint64 total = 0;
+    qint64 completed = 0;
+};
+
+// Итог удаления одной строки: «нет такой» отличается от сбоя БД
+enum class DeleteResult { Deleted, NotFound, Failed };
+
+// Удаление тега: снятые вместе с ним связи с задачами (для ленты изменений)
+struct TagDeleteResult {
+    DeleteResult status = DeleteResult::Failed;
+    qint64 linksRemoved = 0;
+};
+
+// Сохранённый ответ на POST с заголовком Idempotency-Key
+struct IdempotencyRecord {
+    QString key;
+    QByteArray fingerprint; // SHA-256 от маршрута и тела исходного запроса
+    int status = 0;
+    QByteArray contentType;
+    QByteArray body;
+    qint64 createdAtMs = 0; // UTC, мс с эпохи
+};
 
 class IStorage {
 public:
@@ -13,14 +132,54 @@ public:
 
     virtual std::vector<Task> getAllTasks() const = 0;
     virtual std::optional<Task> getTaskById(const QUuid& id) const = 0;
+    // Проекция: читаются только колонки из fields, остальные поля Task пустые
+    virtual std::optional<Task> getTaskById(const QUuid& id, TaskFields fields) const = 0;
+
+    // Потоковое чтение: строки отдаются visitor'у по мере чтения курсора,
+    // без накопления всей таблицы. visitor возвращает false → остановить.
+    virtual bool forEachTask(const std::function<bool(const Task&)>& visitor) const = 0;
+    virtual bool forEachTask(TaskFields fields,
+                             const std::function<bool(const Task&)>& visitor) const = 0;
+    // То же пачками: visitor получает один и тот же TaskBatch, заполненный
+    // очередными batchSize строками; строки Task не создаются
+    virtual bool forEachTaskBatch(const TaskScan& scan,
+                                  const std::function<bool(const TaskBatch&)>& visitor) const = 0;
+    // План запроса, который forEachTaskBatch выполнил бы для scan
+    virtual std::optional<TaskQueryPlan> explainTaskScan(const TaskScan& scan) const = 0;
 
     virtual QUuid addTask(const Task& task) = 0;
-    virtual bool updateTask(const QUuid& id, const Task& task) = 0;
-    virtual bool deleteTask(const QUuid& id) = 0;
+    // Частичное обновление в одной транзакции: только изменённые колонки и
+    // разность связей с тегами; в result.task — строка после изменения
+    virtual TaskMutationResult patchTask(const QUuid& id, const TaskPatch& patch) = 0;
+    // В result.tagsRemoved — теги удалённой задачи
+    virtual TaskMutationResult deleteTask(const QUuid& id) = 0;
     virtual bool deleteAll() = 0;
 
+    // Все операции выполняются в одной транзакции, по порядку.
+    // atomic = true  → первая ошибка откатывает весь пакет;
+    // atomic = false → каждая операция в своём SAVEPOINT, ошибки не мешают остальным.
+    virtual std::vector<TaskMutationResult>
+    applyMutations(const std::vector<TaskMutation>& ops, bool atomic) = 0;
+    virtual TaskBulkResult applyBulk(const TaskBulkOp& op) = 0;
+    // Одна строка task_stats, без обхода задач
+    virtual std::optional<TaskStats> getTaskStats() const = 0;
+
     virtual std::vector<Tag> getAllTags() const = 0;
+    virtual bool forEachTag(const std::function<bool(const Tag&)>& visitor) const = 0;
+    // Теги с числом задач, в которых они стоят (из tag_stats), по имени
+    virtual bool forEachTagUsage(
+        const std::function<bool(const Tag&, qint64 taskCount)>& visitor) const = 0;
+    virtual std::optional<Tag> getTagById(const QUuid& id) const = 0;
     virtual QUuid addTag(const Tag& tag) = 0;
+    // Связи с задачами удаляются в той же транзакции
+    virtual TagDeleteResult deleteTag(const QUuid& id) = 0;
+    // Число снятых связей с задачами; nullopt — ошибка
+    virtual std::optional<qint64> deleteAllTags() = 0;
+
+    virtual std::optional<IdempotencyRecord> getIdempotencyRecord(const QString& key) const = 0;
+    virtual bool putIdempotencyRecord(const IdempotencyRecord& record) = 0;
+    // Удаляет записи старше createdBeforeMs, возвращает число удалённых (-1 при ошибке)
+    virtual int purgeIdempotencyRecords(qint64 createdBeforeMs) = 0;
 };
 
 #endif // TASKLIT_STORAGE_ISTORAGE_HPP
@@ -1,21 +1,136 @@
 #include "SQLiteStorageImpl.hpp"
 
+#include <QHash>
 #include <QJsonArray>
+#include <QSet>
+#include <QStringList>
 #include <QVariant>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
-#include <QtSql/QSqlRecord>
+#include <algorithm>
 
 #include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Tracing.hpp"
+#include "UuidCodec.hpp"
 
 // ─────────────────────────────────────────────────────────────────────────────
 // helpers
 // ─────────────────────────────────────────────────────────────────────────────
 namespace {
 
-QString uuidToStr(const QUuid &id) { return id.toString(QUuid::WithoutBraces); }
+QString uuidToStr(const QUuid &id) { return uuidToString(id); }
 
-QUuid strToUuid(const QString &s) { return QUuid::fromString(s); }
+QUuid strToUuid(const QString &s) { return parseUuid(s); }
+
+// exec() с замером латентности для /metrics (метка query = name)
+// и span'ом в трассе запроса
+bool execTimed(QSqlQuery &query, const char *name) {
+    tracing::Span span(name);
+    const auto started = metrics::Clock::now();
+    const bool ok = query.exec();
+    metrics::observeSqlQuery(name, metrics::elapsedNs(started), ok);
+    return ok;
+}
+
+bool execTimed(QSqlQuery &query, const char *name, const QString &sql) {
+    tracing::Span span(name);
+    const auto started = metrics::Clock::now();
+    const bool ok = query.exec(sql);
+    metrics::observeSqlQuery(name, metrics::elapsedNs(started), ok);
+    return ok;
+}
+
+// Счётчики для GET /stats и GET /tags?withCounts=1. Их ведут триггеры, поэтому
+// любой путь записи (в т.ч. applyBulk и каскад из tags) меняет их в своей же
+// транзакции. Для базы без счётчиков они один раз считаются по данным.
+// BEGIN IMMEDIATE берёт блокировку записи до проверки строки task_stats:
+// второй процесс на той же базе ждёт и уже не запускает заполнение повторно.
+bool ensureStatsSchema(QSqlDatabase db) {
+    QSqlQuery query(db);
+    if (!query.exec(QStringLiteral("BEGIN IMMEDIATE"))) {
+        qCritical(appSql) << "schema stats tx:" << query.lastError().text();
+        return false;
+    }
+
+    const auto rollback = [&db] {
+        QSqlQuery(db).exec(QStringLiteral("ROLLBACK"));
+    };
+    const auto run = [&](const char *name, const char *sql) {
+        if (query.exec(QLatin1String(sql))) {
+            return true;
+        }
+        qCritical(appSql) << "schema" << name << ":" << query.lastError().text();
+        query.finish();
+        rollback();
+        return false;
+    };
+
+    // одна строка id = 0
+    if (!run("task_stats", "CREATE TABLE IF NOT EXISTS task_stats ("
+                           "  id INTEGER PRIMARY KEY CHECK (id = 0),"
+                           "  total INTEGER NOT NULL,"
+                           "  completed INTEGER NOT NULL"
+                           ");") ||
+        !run("tag_stats", "CREATE TABLE IF NOT EXISTS tag_stats ("
+                          "  tag_id TEXT PRIMARY KEY,"
+                          "  task_count INTEGER NOT NULL,"
+                          "  FOREIGN KEY(tag_id) REFERENCES tags(id) ON DELETE CASCADE"
+                          ") WITHOUT ROWID;")) {
+        return false;
+    }
+
+    if (!run("task_stats row", "SELECT 1 FROM task_stats WHERE id = 0")) {
+        return false;
+    }
+    if (!query.next()) {
+        qInfo(appSql) << "Backfilling task/tag counters...";
+        if (!run("task_stats backfill",
+                 "INSERT INTO task_stats(id, total, completed) "
+                 "SELECT 0, COUNT(*), COALESCE(SUM(isCompleted <> 0), 0) FROM tasks") ||
+            !run("tag_stats backfill",
+                 "INSERT OR REPLACE INTO tag_stats(tag_id, task_count) "
+                 "SELECT tag_id, COUNT(*) FROM task_tags GROUP BY tag_id")) {
+            return false;
+        }
+    }
+    query.finish();
+
+    // INSERT OR IGNORE в task_tags без вставки триггер не вызывает
+    if (!run("trg_tasks_insert",
+             "CREATE TRIGGER IF NOT EXISTS trg_tasks_insert AFTER INSERT ON tasks "
+             "BEGIN UPDATE task_stats SET total = total + 1, "
+             "completed = completed + (new.isCompleted <> 0) WHERE id = 0; END") ||
+        !run("trg_tasks_delete",
+             "CREATE TRIGGER IF NOT EXISTS trg_tasks_delete AFTER DELETE ON tasks "
+             "BEGIN UPDATE task_stats SET total = total - 1, "
+             "completed = completed - (old.isCompleted <> 0) WHERE id = 0; END") ||
+        !run("trg_tasks_completed",
+             "CREATE TRIGGER IF NOT EXISTS trg_tasks_completed "
+             "AFTER UPDATE OF isCompleted ON tasks "
+             "WHEN (old.isCompleted <> 0) <> (new.isCompleted <> 0) "
+             "BEGIN UPDATE task_stats SET completed = completed "
+             "+ (new.isCompleted <> 0) - (old.isCompleted <> 0) WHERE id = 0; END") ||
+        !run("trg_task_tags_insert",
+             "CREATE TRIGGER IF NOT EXISTS trg_task_tags_insert AFTER INSERT ON task_tags "
+             "BEGIN INSERT INTO tag_stats(tag_id, task_count) VALUES (new.tag_id, 1) "
+             "ON CONFLICT(tag_id) DO UPDATE SET task_count = task_count + 1; END") ||
+        // после удаления тега строка уже снята каскадом — UPDATE её не вернёт
+        !run("trg_task_tags_delete",
+             "CREATE TRIGGER IF NOT EXISTS trg_task_tags_delete AFTER DELETE ON task_tags "
+             "BEGIN UPDATE tag_stats SET task_count = task_count - 1 "
+             "WHERE tag_id = old.tag_id; END")) {
+        return false;
+    }
+
+    if (!query.exec(QStringLiteral("COMMIT"))) {
+        qCritical(appSql) << "schema stats commit:" << query.lastError().text();
+        query.finish();
+        rollback();
+        return false;
+    }
+    return true;
+}
 
 bool ensureSchema(QSqlDatabase db) {
     QSqlQuery query(db);
@@ -55,34 +170,52 @@ bool ensureSchema(QSqlDatabase db) {
         return false;
     }
 
-    qInfo(appSql) << "Schema OK";
-    return true;
-}
+    // обратный поиск "задачи с тегом" и каскад из tags без полного скана;
+    // task_id во втором столбце — порядок для keyset-страниц GET /tag/tasks
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_task_tags_tag "
+                    "ON task_tags(tag_id, task_id);")) {
+        qCritical(appSql) << "schema idx_task_tags_tag:" << query.lastError().text();
+        return false;
+    }
 
-static QVector<QUuid> fetchTagIdsForTask(QSqlDatabase db, const QUuid &taskId) {
-    QVector<QUuid> out;
-    QSqlQuery query(db);
+    // фильтры и сортировки GET /tasks: isCompleted (rowid в индексе неявно —
+    // порядок вставки сохраняется без сортировки), title — префикс и sort=title
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_tasks_completed "
+                    "ON tasks(isCompleted);")) {
+        qCritical(appSql) << "schema idx_tasks_completed:" << query.lastError().text();
+        return false;
+    }
 
-    query.prepare("SELECT tt.tag_id "
-                  "FROM task_tags tt "
-                  "WHERE tt.task_id = ?");
-    query.addBindValue(uuidToStr(taskId));
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_tasks_title ON tasks(title);")) {
+        qCritical(appSql) << "schema idx_tasks_title:" << query.lastError().text();
+        return false;
+    }
 
-    if (!query.exec()) {
-        qWarning(appSql) << "fetchTagIdsForTask:" << query.lastError().text();
-        return out;
+    // ответы на POST по Idempotency-Key (TTL обслуживает сервис)
+    if (!query.exec("CREATE TABLE IF NOT EXISTS idempotency_keys ("
+                    "  key TEXT PRIMARY KEY,"
+                    "  fingerprint BLOB NOT NULL,"
+                    "  status INTEGER NOT NULL,"
+                    "  content_type TEXT NOT NULL,"
+                    "  body BLOB NOT NULL,"
+                    "  created_at INTEGER NOT NULL"
+                    ");")) {
+        qCritical(appSql) << "schema idempotency_keys:" << query.lastError().text();
+        return false;
     }
 
-    while (query.next()) {
-        const QUuid id = strToUuid(query.value(0).toString());
-        if (!id.isNull()) {
-            out.append(id);
-        }
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_idempotency_created "
+                    "ON idempotency_keys(created_at);")) {
+        qCritical(appSql) << "schema idx_idempotency_created:" << query.lastError().text();
+        return false;
     }
 
-    qInfo(appSql) << "Fetched" << out.size() << "tag ids for task"
-                  << uuidToStr(taskId);
-    return out;
+    if (!ensureStatsSchema(db)) {
+        return false;
+    }
+
+    qInfo(appSql) << "Schema OK";
+    return true;
 }
 
 static bool allTagsExist(QSqlDatabase db, const QVector<QUuid> &tagIds) {
@@ -95,7 +228,7 @@ static bool allTagsExist(QSqlDatabase db, const QVector<QUuid> &tagIds) {
     for (const QUuid &id : tagIds) {
         query.addBindValue(uuidToStr(id));
 
-        if (!query.exec()) {
+        if (!execTimed(query, "tagExists")) {
             qWarning(appSql) << "allTagsExist:" << query.lastError().text();
             return false;
         }
@@ -124,7 +257,7 @@ static bool replaceTaskTags(QSqlDatabase db, const QUuid &taskId,
     del.prepare("DELETE FROM task_tags WHERE task_id = ?");
     del.addBindValue(uuidToStr(taskId));
 
-    if (!del.exec()) {
+    if (!execTimed(del, "deleteTaskTags")) {
         qWarning(appSql) << "clear task_tags:" << del.lastError().text();
         return false;
     }
@@ -140,7 +273,7 @@ static bool replaceTaskTags(QSqlDatabase db, const QUuid &taskId,
         add.addBindValue(uuidToStr(taskId));
         add.addBindValue(uuidToStr(tagId));
 
-        if (!add.exec()) {
+        if (!execTimed(add, "insertTaskTag")) {
             qWarning(appSql) << "add tag link:" << add.lastError().text();
             return false;
         }
@@ -155,24 +288,461 @@ static bool replaceTaskTags(QSqlDatabase db, const QUuid &taskId,
     return true;
 }
 
-static Task rowToTask(const QSqlRecord &record) {
-    Task task;
-    task.id = strToUuid(record.value("id").toString());
-    task.title = record.value("title").toString();
-    task.description = record.value("description").toString();
-    task.isCompleted = record.value("isCompleted").toInt() != 0;
+// ─────────────────────────────────────────────────────────────────────────────
+// операции над строками без управления транзакцией (вызываются внутри tx)
+// ─────────────────────────────────────────────────────────────────────────────
+enum class WriteStatus { Ok, NotFound, MissingTag, Failed };
+
+// Список колонок SELECT под проекцию: id читается всегда, теги — одной
+// строкой через коррелированный подзапрос по PK task_tags и только если
+// они запрошены. Индексы колонок: -1 — колонка не выбиралась.
+struct TaskColumns {
+    QString sql;
+    int title = -1;
+    int description = -1;
+    int isCompleted = -1;
+    int tags = -1;
+    int rowId = -1;
+};
+
+static TaskColumns taskColumns(TaskFields fields, bool withRowId = false) {
+    TaskColumns columns;
+    columns.sql = QStringLiteral("t.id");
+    int next = 1;
+    if (fields.has(TaskFields::Title)) {
+        columns.sql += QStringLiteral(", t.title");
+        columns.title = next++;
+    }
+    if (fields.has(TaskFields::Description)) {
+        columns.sql += QStringLiteral(", t.description");
+        columns.description = next++;
+    }
+    if (fields.has(TaskFields::IsCompleted)) {
+        columns.sql += QStringLiteral(", t.isCompleted");
+        columns.isCompleted = next++;
+    }
+    if (fields.has(TaskFields::Tags)) {
+        columns.sql += QStringLiteral(
+            ", (SELECT group_concat(tt.tag_id) FROM task_tags tt "
+            "WHERE tt.task_id = t.id) AS tag_ids");
+        columns.tags = next++;
+    }
+    if (withRowId) {
+        columns.sql += QStringLiteral(", t.rowid");
+        columns.rowId = next++;
+    }
+    return columns;
+}
+
+static void readTaskRow(const QSqlQuery &query, const TaskColumns &columns,
+                        Task &task) {
+    task.id = strToUuid(query.value(0).toString());
+    if (columns.title >= 0) {
+        task.title = query.value(columns.title).toString();
+    }
+    if (columns.description >= 0) {
+        task.description = query.value(columns.description).toString();
+    }
+    if (columns.isCompleted >= 0) {
+        task.isCompleted = query.value(columns.isCompleted).toInt() != 0;
+    }
+    task.tags.clear();
+    if (columns.tags >= 0) {
+        parseUuidList(query.value(columns.tags).toString(), u',', task.tags);
+    }
+}
+
+static std::optional<Task> selectTask(QSqlDatabase db, const QUuid &id,
+                                      TaskFields fields = TaskFields::all()) {
+    const TaskColumns columns = taskColumns(fields);
+    QSqlQuery query(db);
+    query.prepare(QStringLiteral("SELECT %1 FROM tasks t WHERE t.id = ?")
+                      .arg(columns.sql));
+    query.addBindValue(uuidToStr(id));
 
+    if (!execTimed(query, "selectTask")) {
+        qWarning(appSql) << "selectTask:" << query.lastError().text();
+        return std::nullopt;
+    }
+
+    if (!query.next()) {
+        return std::nullopt;
+    }
+
+    Task task;
+    readTaskRow(query, columns, task);
     return task;
 }
 
+static WriteStatus insertTaskRow(QSqlDatabase db, const Task &task) {
+    if (!allTagsExist(db, task.tags)) {
+        qWarning(appSql) << "Insert aborted: some tag ids do not exist";
+        return WriteStatus::MissingTag;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO tasks(id, title, description, isCompleted) "
+                  "VALUES(?, ?, ?, ?)");
+    query.addBindValue(uuidToStr(task.id));
+    query.addBindValue(task.title);
+    query.addBindValue(task.description);
+    query.addBindValue(task.isCompleted ? 1 : 0);
+
+    if (!execTimed(query, "insertTask")) {
+        qCritical(appSql) << "addTask:" << query.lastError().text();
+        return WriteStatus::Failed;
+    }
+
+    if (!replaceTaskTags(db, task.id, task.tags)) {
+        return WriteStatus::Failed;
+    }
+
+    return WriteStatus::Ok;
+}
+
+// "?, ?, ?" для IN (...) / VALUES
+static QString placeholders(qsizetype count, QStringView group = u"?") {
+    QString out;
+    out.reserve(count * (group.size() + 2));
+    for (qsizetype i = 0; i < count; ++i) {
+        if (i > 0) {
+            out += QStringLiteral(", ");
+        }
+        out += group;
+    }
+    return out;
+}
+
+// Пачки для IN (...) и многострочного VALUES — с запасом ниже лимита
+// SQLITE_MAX_VARIABLE_NUMBER старых сборок (999)
+constexpr qsizetype kMaxLinkBatch = 400;
+
+// WHERE по TaskFilter над tasks под именем table ("tasks" или псевдоним),
+// значения дописываются в binds по порядку. Пустой фильтр — "1", т.е. все задачи
+static QString taskFilterSql(const TaskFilter &filter, QVariantList &binds,
+                             const QString &table = QStringLiteral("tasks")) {
+    QStringList terms;
+    if (!filter.ids.isEmpty()) {
+        terms << QStringLiteral("%1.id IN (%2)").arg(table, placeholders(filter.ids.size()));
+        for (const QUuid &id : filter.ids) {
+            binds << uuidToStr(id);
+        }
+    }
+    if (filter.isCompleted) {
+        terms << QStringLiteral("%1.isCompleted = ?").arg(table);
+        binds << (*filter.isCompleted ? 1 : 0);
+    }
+    if (!filter.tags.isEmpty()) {
+        // Подзапрос по idx_task_tags_tag — без дублей задач с несколькими тегами
+        terms << QStringLiteral("%1.id IN (SELECT ft.task_id FROM task_tags ft "
+                                "WHERE ft.tag_id IN (%2))")
+                     .arg(table, placeholders(filter.tags.size()));
+        for (const QUuid &id : filter.tags) {
+            binds << uuidToStr(id);
+        }
+    }
+    if (!filter.titlePrefix.isEmpty()) {
+        // Диапазон [prefix, prefix + U+10FFFF) вместо LIKE: LIKE по индексу
+        // с BINARY-сравнением SQLite не использует
+        terms << QStringLiteral("%1.title >= ? AND %1.title < ?").arg(table);
+        binds << filter.titlePrefix
+              << QString(filter.titlePrefix + QStringLiteral("\U0010FFFF"));
+    }
+    if (!filter.titleContains.isEmpty()) {
+        QString pattern = filter.titleContains;
+        pattern.replace(u'\\', QStringLiteral("\\\\"))
+            .replace(u'%', QStringLiteral("\\%"))
+            .replace(u'_', QStringLiteral("\\_"));
+        terms << QStringLiteral("%1.title LIKE ? ESCAPE '\\'").arg(table);
+        binds << QString(QLatin1Char('%') + pattern + QLatin1Char('%'));
+    }
+    return terms.isEmpty() ? QStringLiteral("1") : terms.join(QStringLiteral(" AND "));
+}
+
+static std::optional<QVector<QUuid>> selectTaskTagIds(QSqlDatabase db,
+                                                      const QUuid &taskId) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT tag_id FROM task_tags WHERE task_id = ?");
+    query.addBindValue(uuidToStr(taskId));
+
+    if (!execTimed(query, "selectTaskTags")) {
+        qWarning(appSql) << "selectTaskTagIds:" << query.lastError().text();
+        return std::nullopt;
+    }
+
+    QVector<QUuid> out;
+    while (query.next()) {
+        const QUuid id = strToUuid(query.value(0).toString());
+        if (!id.isNull()) {
+            out.push_back(id);
+        }
+    }
+    return out;
+}
+
+// Все ли теги существуют — один запрос на пачку вместо запроса на тег
+static bool tagsExist(QSqlDatabase db, const QVector<QUuid> &tagIds) {
+    for (qsizetype from = 0; from < tagIds.size(); from += kMaxLinkBatch) {
+        const qsizetype count = std::min(kMaxLinkBatch, tagIds.size() - from);
+        QSqlQuery query(db);
+        query.prepare(QStringLiteral("SELECT COUNT(*) FROM tags WHERE id IN (%1)")
+                          .arg(placeholders(count)));
+        for (qsizetype i = from; i < from + count; ++i) {
+            query.addBindValue(uuidToStr(tagIds[i]));
+        }
+
+        if (!execTimed(query, "countTags") || !query.next()) {
+            qWarning(appSql) << "tagsExist:" << query.lastError().text();
+            return false;
+        }
+        if (query.value(0).toLongLong() != count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool unlinkTags(QSqlDatabase db, const QUuid &taskId,
+                       const QVector<QUuid> &tagIds) {
+    for (qsizetype from = 0; from < tagIds.size(); from += kMaxLinkBatch) {
+        const qsizetype count = std::min(kMaxLinkBatch, tagIds.size() - from);
+        QSqlQuery query(db);
+        query.prepare(QStringLiteral("DELETE FROM task_tags "
+                                     "WHERE task_id = ? AND tag_id IN (%1)")
+                          .arg(placeholders(count)));
+        query.addBindValue(uuidToStr(taskId));
+        for (qsizetype i = from; i < from + count; ++i) {
+            query.addBindValue(uuidToStr(tagIds[i]));
+        }
+
+        if (!execTimed(query, "unlinkTaskTags")) {
+            qWarning(appSql) << "unlinkTags:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool linkTags(QSqlDatabase db, const QUuid &taskId,
+                     const QVector<QUuid> &tagIds) {
+    const QString task = uuidToStr(taskId);
+    for (qsizetype from = 0; from < tagIds.size(); from += kMaxLinkBatch / 2) {
+        const qsizetype count = std::min(kMaxLinkBatch / 2, tagIds.size() - from);
+        QSqlQuery query(db);
+        query.prepare(QStringLiteral("INSERT OR IGNORE INTO task_tags(task_id, tag_id) "
+                                     "VALUES %1")
+                          .arg(placeholders(count, u"(?, ?)")));
+        for (qsizetype i = from; i < from + count; ++i) {
+            query.addBindValue(task);
+            query.addBindValue(uuidToStr(tagIds[i]));
+        }
+
+        if (!execTimed(query, "linkTaskTags")) {
+            qWarning(appSql) << "linkTags:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Частичное обновление: UPDATE только изменённых колонок с RETURNING
+// (строка без второго SELECT), связи с тегами — разностью множеств,
+// она же возвращается в tagsAdded / tagsRemoved.
+// Без изменённых колонок строка читается обычным SELECT.
+static WriteStatus patchTaskRow(QSqlDatabase db, const QUuid &id,
+                                const TaskPatch &patch, Task &out,
+                                QVector<QUuid> &tagsAdded,
+                                QVector<QUuid> &tagsRemoved) {
+    QStringList assignments;
+    if (patch.title) {
+        assignments << QStringLiteral("title = ?");
+    }
+    if (patch.description) {
+        assignments << QStringLiteral("description = ?");
+    }
+    if (patch.isCompleted) {
+        assignments << QStringLiteral("isCompleted = ?");
+    }
+
+    QSqlQuery row(db);
+    if (assignments.isEmpty()) {
+        row.prepare("SELECT id, title, description, isCompleted FROM tasks WHERE id = ?");
+    } else {
+        row.prepare(QStringLiteral("UPDATE tasks SET %1 WHERE id = ? "
+                                   "RETURNING id, title, description, isCompleted")
+                        .arg(assignments.join(QStringLiteral(", "))));
+        if (patch.title) {
+            row.addBindValue(*patch.title);
+        }
+        if (patch.description) {
+            row.addBindValue(*patch.description);
+        }
+        if (patch.isCompleted) {
+            row.addBindValue(*patch.isCompleted ? 1 : 0);
+        }
+    }
+    row.addBindValue(uuidToStr(id));
+
+    if (!execTimed(row, assignments.isEmpty() ? "selectTask" : "patchTask")) {
+        qCritical(appSql) << "patchTask:" << row.lastError().text();
+        return WriteStatus::Failed;
+    }
+    if (!row.next()) {
+        qInfo(appSql) << "No rows patched for id=" << uuidToStr(id);
+        return WriteStatus::NotFound;
+    }
+
+    out.id = strToUuid(row.value(0).toString());
+    out.title = row.value(1).toString();
+    out.description = row.value(2).toString();
+    out.isCompleted = row.value(3).toInt() != 0;
+    out.tagsExpanded.reset();
+    row.finish();
+
+    auto current = selectTaskTagIds(db, id);
+    if (!current) {
+        return WriteStatus::Failed;
+    }
+    if (!patch.tags) {
+        out.tags = std::move(*current);
+        return WriteStatus::Ok;
+    }
+
+    const QSet<QUuid> before(current->cbegin(), current->cend());
+    const QSet<QUuid> after(patch.tags->cbegin(), patch.tags->cend());
+
+    QVector<QUuid> added;
+    for (const QUuid &tagId : *patch.tags) {
+        if (!before.contains(tagId)) {
+            added.push_back(tagId);
+        }
+    }
+    QVector<QUuid> removed;
+    for (const QUuid &tagId : *current) {
+        if (!after.contains(tagId)) {
+            removed.push_back(tagId);
+        }
+    }
+
+    if (!tagsExist(db, added)) {
+        qWarning(appSql) << "Patch aborted: some tag ids do not exist";
+        return WriteStatus::MissingTag;
+    }
+    if (!unlinkTags(db, id, removed) || !linkTags(db, id, added)) {
+        return WriteStatus::Failed;
+    }
+
+    out.tags = *patch.tags;
+    tagsAdded = std::move(added);
+    tagsRemoved = std::move(removed);
+    return WriteStatus::Ok;
+}
+
+// Связи с тегами снимает каскад; их теги читаются заранее для счётчиков usage
+static WriteStatus deleteTaskRow(QSqlDatabase db, const QUuid &id,
+                                 QVector<QUuid> &tagsRemoved) {
+    auto tags = selectTaskTagIds(db, id);
+    if (!tags) {
+        return WriteStatus::Failed;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM tasks WHERE id = ?");
+    query.addBindValue(uuidToStr(id));
+
+    if (!execTimed(query, "deleteTask")) {
+        qWarning(appSql) << "deleteTask:" << query.lastError().text();
+        return WriteStatus::Failed;
+    }
+
+    if (query.numRowsAffected() == 0) {
+        return WriteStatus::NotFound;
+    }
+    tagsRemoved = std::move(*tags);
+    return WriteStatus::Ok;
+}
+
+static TaskMutationResult mutationResult(WriteStatus status, const QUuid &id) {
+    TaskMutationResult result;
+    result.id = id;
+    result.ok = status == WriteStatus::Ok;
+
+    switch (status) {
+    case WriteStatus::Ok:
+        break;
+    case WriteStatus::NotFound:
+        result.error = QStringLiteral("not_found");
+        result.message = QStringLiteral("Task with id=%1 not found")
+                             .arg(uuidToStr(id));
+        break;
+    case WriteStatus::MissingTag:
+        result.error = QStringLiteral("validation_error");
+        result.message = QStringLiteral("Some tag ids do not exist");
+        break;
+    case WriteStatus::Failed:
+        result.error = QStringLiteral("internal_error");
+        result.message = QStringLiteral("Storage error");
+        break;
+    }
+
+    return result;
+}
+
+static TaskMutationResult applyMutation(QSqlDatabase db,
+                                        const TaskMutation &op) {
+    switch (op.kind) {
+    case TaskMutation::Kind::Create: {
+        Task task = op.task;
+        if (task.id.isNull()) {
+            task.id = createUuidV7();
+        }
+
+        TaskMutationResult result =
+            mutationResult(insertTaskRow(db, task), task.id);
+        if (result.ok) {
+            result.task = std::move(task);
+        }
+        return result;
+    }
+
+    case TaskMutation::Kind::Patch: {
+        Task patched;
+        QVector<QUuid> added, removed;
+        TaskMutationResult result = mutationResult(
+            patchTaskRow(db, op.id, op.patch, patched, added, removed), op.id);
+        if (result.ok) {
+            result.task = std::move(patched);
+            result.tagsAdded = std::move(added);
+            result.tagsRemoved = std::move(removed);
+        }
+        return result;
+    }
+
+    case TaskMutation::Kind::Delete: {
+        QVector<QUuid> removed;
+        TaskMutationResult result =
+            mutationResult(deleteTaskRow(db, op.id, removed), op.id);
+        if (result.ok) {
+            result.tagsRemoved = std::move(removed);
+        }
+        return result;
+    }
+    }
+
+    return mutationResult(WriteStatus::Failed, op.id);
+}
+
 } // END NAMESPACE
 
 // ─────────────────────────────────────────────────────────────────────────────
 // ctor
 // ─────────────────────────────────────────────────────────────────────────────
-SQLiteStorage::SQLiteStorage(const QString &dbPath) {
-    m_db = QSqlDatabase::addDatabase("QSQLITE");
+SQLiteStorage::SQLiteStorage(const QString &dbPath, const QString &connectionName) {
+    m_db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     m_db.setDatabaseName(dbPath);
+    // Параллельные соединения к одному файлу ждут блокировку, а не падают с BUSY
+    m_db.setConnectOptions(QStringLiteral("QSQLITE_BUSY_TIMEOUT=5000"));
 
     if (!m_db.open()) {
         qCritical(appSql) << "Failed to open database:"
@@ -196,191 +766,503 @@ std::vector<Task> SQLiteStorage::getAllTasks() const {
     qInfo(appSql) << "Query: getAllTasks()";
     std::vector<Task> out;
 
+    forEachTask([&out](const Task &task) {
+        out.push_back(task);
+        return true;
+    });
+
+    qInfo(appSql) << "→" << out.size() << "tasks fetched";
+    return out;
+}
+
+bool SQLiteStorage::forEachTask(
+    const std::function<bool(const Task &)> &visitor) const {
+    return forEachTask(TaskFields::all(), visitor);
+}
+
+bool SQLiteStorage::forEachTask(
+    TaskFields fields, const std::function<bool(const Task &)> &visitor) const {
+    const TaskColumns columns = taskColumns(fields);
     QSqlQuery query(m_db);
-    if (!query.exec(
-            "SELECT id, title, description, isCompleted FROM tasks ORDER "
-            "BY rowid ASC")) {
-        qWarning(appSql) << "getAllTasks:" << query.lastError().text();
-        return out;
+    // forward-only: драйвер не кэширует уже прочитанные строки
+    query.setForwardOnly(true);
+
+    if (!execTimed(query, "scanTasks",
+                   QStringLiteral("SELECT %1 FROM tasks t ORDER BY t.rowid ASC")
+                       .arg(columns.sql))) {
+        qWarning(appSql) << "forEachTask:" << query.lastError().text();
+        return false;
     }
 
+    Task task;
     while (query.next()) {
-        Task task = rowToTask(query.record());
-        task.tags = fetchTagIdsForTask(m_db, task.id);
-        task.tagsExpanded.reset();
-        out.push_back(std::move(task));
+        readTaskRow(query, columns, task);
+        if (!visitor(task)) {
+            break;
+        }
+    }
+    if (query.lastError().isValid()) {
+        qWarning(appSql) << "forEachTask:" << query.lastError().text();
+        return false;
     }
 
-    qInfo(appSql) << "→" << out.size() << "tasks fetched";
-    return out;
+    return true;
 }
 
-std::optional<Task> SQLiteStorage::getTaskById(const QUuid &id) const {
-    qInfo(appSql) << "Query: getTaskById id=" << uuidToStr(id);
+// SELECT для TaskScan: фильтр, keyset-условие по курсору и ORDER BY по
+// ключу сортировки (с rowid для неуникального title)
+static QString taskScanSql(const TaskScan &scan, const TaskColumns &columns,
+                           QVariantList &binds) {
+    if (!scan.tagId.isNull()) {
+        // Без курсора условия по task_id нет: null QString привязывается как
+        // NULL, а "x.task_id > NULL" не выполняется ни для одной строки
+        QString after;
+        binds << uuidToStr(scan.tagId);
+        if (!scan.afterTaskId.isNull()) {
+            after = QStringLiteral(" AND x.task_id > ?");
+            binds << uuidToStr(scan.afterTaskId);
+        }
+        binds << (scan.limit < 0 ? qint64(-1) : qint64(scan.limit));
+        return QStringLiteral("SELECT %1 FROM task_tags x "
+                              "JOIN tasks t ON t.id = x.task_id "
+                              "WHERE x.tag_id = ?%2 "
+                              "ORDER BY x.task_id ASC LIMIT ?")
+            .arg(columns.sql, after);
+    }
+
+    QString where = taskFilterSql(scan.filter, binds, QStringLiteral("t"));
+    QString order;
+    switch (scan.sort) {
+    case TaskSort::Insertion:
+        where += QStringLiteral(" AND t.rowid > ?");
+        binds << scan.afterRowId;
+        order = QStringLiteral("t.rowid ASC");
+        break;
+    case TaskSort::IdAsc:
+    case TaskSort::IdDesc: {
+        const bool asc = scan.sort == TaskSort::IdAsc;
+        if (!scan.afterTaskId.isNull()) {
+            where += asc ? QStringLiteral(" AND t.id > ?") : QStringLiteral(" AND t.id < ?");
+            binds << uuidToStr(scan.afterTaskId);
+        }
+        order = asc ? QStringLiteral("t.id ASC") : QStringLiteral("t.id DESC");
+        break;
+    }
+    case TaskSort::TitleAsc:
+    case TaskSort::TitleDesc: {
+        const bool asc = scan.sort == TaskSort::TitleAsc;
+        if (scan.afterTitle) {
+            where += asc ? QStringLiteral(" AND (t.title, t.rowid) > (?, ?)")
+                         : QStringLiteral(" AND (t.title, t.rowid) < (?, ?)");
+            binds << *scan.afterTitle << scan.afterRowId;
+        }
+        order = asc ? QStringLiteral("t.title ASC, t.rowid ASC")
+                    : QStringLiteral("t.title DESC, t.rowid DESC");
+        break;
+    }
+    }
 
+    binds << (scan.limit < 0 ? qint64(-1) : qint64(scan.limit));
+    return QStringLiteral("SELECT %1 FROM tasks t WHERE %2 ORDER BY %3 LIMIT ?")
+        .arg(columns.sql, where, order);
+}
+
+// title нужен курсору sort=title, даже если не запрошен в fields:
+// в пачку он читается, а сериализатор смотрит на batch.fields
+static TaskColumns taskScanColumns(const TaskScan &scan) {
+    TaskFields read = scan.fields;
+    if (scan.sort == TaskSort::TitleAsc || scan.sort == TaskSort::TitleDesc) {
+        read.bits |= TaskFields::Title;
+    }
+    return taskColumns(read, true);
+}
+
+bool SQLiteStorage::forEachTaskBatch(
+    const TaskScan &scan, const std::function<bool(const TaskBatch &)> &visitor) const {
+    const TaskColumns columns = taskScanColumns(scan);
+    const qsizetype batchSize = std::max<qsizetype>(1, scan.batchSize);
+
+    QVariantList binds;
     QSqlQuery query(m_db);
-    query.prepare(
-        "SELECT id, title, description, isCompleted FROM tasks WHERE id = ?");
-    query.addBindValue(uuidToStr(id));
+    query.setForwardOnly(true);
+    query.prepare(taskScanSql(scan, columns, binds));
+    for (const QVariant &value : std::as_const(binds)) {
+        query.addBindValue(value);
+    }
 
-    if (!query.exec()) {
-        qWarning(appSql) << "getTaskById:" << query.lastError().text();
-        return std::nullopt;
+    const char *name = !scan.tagId.isNull()                ? "scanTaskBatchByTag"
+                       : scan.filter.isEmpty() && scan.sort == TaskSort::Insertion
+                           ? "scanTaskBatch"
+                           : "scanTaskBatchFiltered";
+    if (!execTimed(query, name)) {
+        qWarning(appSql) << "forEachTaskBatch:" << query.lastError().text();
+        return false;
     }
 
-    if (!query.next()) {
-        qInfo(appSql) << "Task not found id=" << uuidToStr(id);
+    TaskBatch batch;
+    batch.fields = scan.fields;
+    batch.reserve(batchSize, batchSize * 64, batchSize * 2);
+
+    while (query.next()) {
+        batch.beginRow(strToUuid(query.value(0).toString()),
+                       query.value(columns.rowId).toLongLong(),
+                       columns.isCompleted >= 0 &&
+                           query.value(columns.isCompleted).toInt() != 0);
+        batch.appendText(columns.title >= 0 ? query.value(columns.title).toString()
+                                            : QString());
+        batch.appendText(columns.description >= 0
+                             ? query.value(columns.description).toString()
+                             : QString());
+        if (columns.tags >= 0) {
+            parseUuidList(query.value(columns.tags).toString(), u',', batch.tagIds);
+        }
+        batch.endRow();
+
+        if (batch.size() >= batchSize) {
+            if (!visitor(batch)) {
+                return true;
+            }
+            batch.clear();
+        }
+    }
+    // next() == false бывает и при ошибке шага, не только в конце выборки
+    if (query.lastError().isValid()) {
+        qWarning(appSql) << "forEachTaskBatch:" << query.lastError().text();
+        return false;
+    }
+
+    if (!batch.isEmpty()) {
+        visitor(batch);
+    }
+    return true;
+}
+
+std::optional<TaskQueryPlan> SQLiteStorage::explainTaskScan(const TaskScan &scan) const {
+    QVariantList binds;
+    TaskQueryPlan plan;
+    plan.sql = taskScanSql(scan, taskScanColumns(scan), binds);
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + plan.sql);
+    for (const QVariant &value : std::as_const(binds)) {
+        query.addBindValue(value);
+    }
+
+    if (!execTimed(query, "explainTaskScan")) {
+        qWarning(appSql) << "explainTaskScan:" << query.lastError().text();
         return std::nullopt;
     }
 
-    Task task = rowToTask(query.record());
-    task.tags = fetchTagIdsForTask(m_db, task.id);
-    task.tagsExpanded.reset();
+    // Строки: id, parent, notused, detail; отступ — глубина по parent
+    QHash<int, int> depth;
+    while (query.next()) {
+        const int id = query.value(0).toInt();
+        const int level = depth.value(query.value(1).toInt(), -1) + 1;
+        depth.insert(id, level);
+        plan.steps << QString(level * 2, u' ') + query.value(3).toString();
+    }
+    return plan;
+}
+
+std::optional<Task> SQLiteStorage::getTaskById(const QUuid &id) const {
+    return getTaskById(id, TaskFields::all());
+}
+
+std::optional<Task> SQLiteStorage::getTaskById(const QUuid &id,
+                                               TaskFields fields) const {
+    qInfo(appSql) << "Query: getTaskById id=" << uuidToStr(id);
+
+    auto task = selectTask(m_db, id, fields);
+    if (!task) {
+        qInfo(appSql) << "Task not found id=" << uuidToStr(id);
+    }
 
     return task;
 }
 
 QUuid SQLiteStorage::addTask(const Task &task) {
-    const QUuid newId = task.id.isNull() ? QUuid::createUuid() : task.id;
-    qInfo(appSql) << "Insert task id=" << uuidToStr(newId)
+    Task toStore = task;
+    if (toStore.id.isNull()) {
+        toStore.id = createUuidV7();
+    }
+    qInfo(appSql) << "Insert task id=" << uuidToStr(toStore.id)
                   << "title=" << task.title << "tags=" << task.tags.size();
 
     if (!m_db.transaction()) {
         qWarning(appSql) << "tx begin:" << m_db.lastError().text();
     }
 
-    if (!allTagsExist(m_db, task.tags)) {
-        qWarning(appSql) << "Insert aborted: some tag ids do not exist";
+    if (insertTaskRow(m_db, toStore) != WriteStatus::Ok) {
         m_db.rollback();
         return QUuid{};
     }
 
-    QSqlQuery query(m_db);
-    query.prepare("INSERT INTO tasks(id, title, description, isCompleted) "
-                  "VALUES(?, ?, ?, ?)");
-    query.addBindValue(uuidToStr(newId));
-    query.addBindValue(task.title);
-    query.addBindValue(task.description);
-    query.addBindValue(task.isCompleted ? 1 : 0);
-
-    if (!query.exec()) {
-        qCritical(appSql) << "addTask:" << query.lastError().text();
+    if (!m_db.commit()) {
+        qCritical(appSql) << "tx commit:" << m_db.lastError().text();
         m_db.rollback();
         return QUuid{};
     }
 
-    if (!replaceTaskTags(m_db, newId, task.tags)) {
+    qInfo(appSql) << "Task inserted id=" << uuidToStr(toStore.id);
+    return toStore.id;
+}
+
+TaskMutationResult SQLiteStorage::patchTask(const QUuid &id,
+                                            const TaskPatch &patch) {
+    qInfo(appSql) << "Patch task id=" << uuidToStr(id);
+
+    if (!m_db.transaction()) {
+        qWarning(appSql) << "tx begin:" << m_db.lastError().text();
+    }
+
+    Task patched;
+    QVector<QUuid> added, removed;
+    TaskMutationResult result = mutationResult(
+        patchTaskRow(m_db, id, patch, patched, added, removed), id);
+    if (!result.ok) {
         m_db.rollback();
-        return QUuid{};
+        return result;
     }
 
     if (!m_db.commit()) {
         qCritical(appSql) << "tx commit:" << m_db.lastError().text();
-        return QUuid{};
+        m_db.rollback();
+        return mutationResult(WriteStatus::Failed, id);
     }
 
-    qInfo(appSql) << "Task inserted id=" << uuidToStr(newId);
-    return newId;
+    result.task = std::move(patched);
+    result.tagsAdded = std::move(added);
+    result.tagsRemoved = std::move(removed);
+    return result;
 }
 
-bool SQLiteStorage::updateTask(const QUuid &id, const Task &task) {
-    qInfo(appSql) << "Update task id=" << uuidToStr(id);
+TaskMutationResult SQLiteStorage::deleteTask(const QUuid &id) {
+    qInfo(appSql) << "Delete task id=" << uuidToStr(id);
 
     if (!m_db.transaction()) {
         qWarning(appSql) << "tx begin:" << m_db.lastError().text();
     }
 
-    if (!allTagsExist(m_db, task.tags)) {
-        qWarning(appSql) << "Update aborted: some tag ids do not exist";
+    QVector<QUuid> removed;
+    TaskMutationResult result = mutationResult(deleteTaskRow(m_db, id, removed), id);
+    if (!result.ok) {
         m_db.rollback();
-        return false;
+        qInfo(appSql) << "Not deleted id=" << uuidToStr(id) << ":" << result.error;
+        return result;
+    }
+
+    if (!m_db.commit()) {
+        qCritical(appSql) << "tx commit:" << m_db.lastError().text();
+        m_db.rollback();
+        return mutationResult(WriteStatus::Failed, id);
+    }
+
+    result.tagsRemoved = std::move(removed);
+    qInfo(appSql) << "Deleted id=" << uuidToStr(id);
+    return result;
+}
+
+bool SQLiteStorage::deleteAll() {
+    qInfo(appSql) << "Delete ALL tasks/tags";
+    if (!m_db.transaction()) {
+        qWarning(appSql) << "tx begin:" << m_db.lastError().text();
     }
 
     QSqlQuery query(m_db);
-    query.prepare(
-        "UPDATE tasks SET title = ?, description = ?, isCompleted = ? "
-        "WHERE id = ?");
-    query.addBindValue(task.title);
-    query.addBindValue(task.description);
-    query.addBindValue(task.isCompleted ? 1 : 0);
-    query.addBindValue(uuidToStr(id));
 
-    if (!query.exec()) {
-        qCritical(appSql) << "updateTask:" << query.lastError().text();
+    if (!execTimed(query, "clearTaskTags", "DELETE FROM task_tags")) {
+        qWarning(appSql) << "clear task_tags:" << query.lastError().text();
         m_db.rollback();
         return false;
     }
 
-    if (query.numRowsAffected() == 0) {
-        qInfo(appSql) << "No rows updated for id=" << uuidToStr(id);
+    if (!execTimed(query, "clearTasks", "DELETE FROM tasks")) {
+        qWarning(appSql) << "clear tasks:" << query.lastError().text();
         m_db.rollback();
         return false;
     }
 
-    if (!replaceTaskTags(m_db, id, task.tags)) {
+    if (!execTimed(query, "clearTags", "DELETE FROM tags")) {
+        qWarning(appSql) << "clear tags:" << query.lastError().text();
         m_db.rollback();
         return false;
     }
 
     if (!m_db.commit()) {
         qCritical(appSql) << "tx commit:" << m_db.lastError().text();
+        m_db.rollback();
         return false;
     }
 
-    qInfo(appSql) << "Task updated id=" << uuidToStr(id);
+    qInfo(appSql) << "All cleared";
     return true;
 }
 
-bool SQLiteStorage::deleteTask(const QUuid &id) {
-    qInfo(appSql) << "Delete task id=" << uuidToStr(id);
+// ─────────────────────────────────────────────────────────────────────────────
+// batch
+// ─────────────────────────────────────────────────────────────────────────────
+std::vector<TaskMutationResult>
+SQLiteStorage::applyMutations(const std::vector<TaskMutation> &ops,
+                              bool atomic) {
+    qInfo(appSql) << "Apply batch ops=" << ops.size() << "atomic=" << atomic;
+    std::vector<TaskMutationResult> results(ops.size());
 
-    QSqlQuery query(m_db);
-    query.prepare("DELETE FROM tasks WHERE id = ?");
-    query.addBindValue(uuidToStr(id));
+    if (!m_db.transaction()) {
+        qCritical(appSql) << "tx begin:" << m_db.lastError().text();
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            results[i] = mutationResult(WriteStatus::Failed, ops[i].id);
+        }
+        return results;
+    }
 
-    if (!query.exec()) {
-        qWarning(appSql) << "deleteTask:" << query.lastError().text();
-        return false;
+    QSqlQuery savepoint(m_db);
+    std::optional<std::size_t> failedAt;
+
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        if (atomic) {
+            results[i] = applyMutation(m_db, ops[i]);
+            if (!results[i].ok) {
+                failedAt = i;
+                break;
+            }
+            continue;
+        }
+
+        // per-op режим: неудачная операция откатывается до своего SAVEPOINT
+        if (!savepoint.exec("SAVEPOINT batch_op")) {
+            qCritical(appSql) << "savepoint:" << savepoint.lastError().text();
+            results[i] = mutationResult(WriteStatus::Failed, ops[i].id);
+            continue;
+        }
+
+        results[i] = applyMutation(m_db, ops[i]);
+        if (!results[i].ok) {
+            savepoint.exec("ROLLBACK TO batch_op");
+        }
+        savepoint.exec("RELEASE batch_op");
     }
 
-    const bool ok = query.numRowsAffected() > 0;
-    qInfo(appSql) << (ok ? "Deleted" : "Not found") << "id=" << uuidToStr(id);
-    return ok;
+    if (failedAt) {
+        m_db.rollback();
+        qWarning(appSql) << "Batch rolled back at op" << *failedAt;
+
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            if (i < *failedAt) {
+                results[i].ok = false;
+                results[i].task.reset();
+                results[i].error = QStringLiteral("rolled_back");
+                results[i].message =
+                    QStringLiteral("Rolled back: operation #%1 failed")
+                        .arg(*failedAt);
+            } else if (i > *failedAt) {
+                results[i].id = ops[i].id;
+                results[i].error = QStringLiteral("skipped");
+                results[i].message =
+                    QStringLiteral("Not applied: operation #%1 failed")
+                        .arg(*failedAt);
+            }
+        }
+        return results;
+    }
+
+    if (!m_db.commit()) {
+        qCritical(appSql) << "tx commit:" << m_db.lastError().text();
+        m_db.rollback();
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            results[i] = mutationResult(WriteStatus::Failed, ops[i].id);
+        }
+        return results;
+    }
+
+    qInfo(appSql) << "Batch committed ops=" << ops.size();
+    return results;
 }
 
-bool SQLiteStorage::deleteAll() {
-    qInfo(appSql) << "Delete ALL tasks/tags";
+// Один оператор на операцию; для операций с тегами — вместе с проверкой
+// существования тегов в одной транзакции
+TaskBulkResult SQLiteStorage::applyBulk(const TaskBulkOp &op) {
+    TaskBulkResult result;
+    const auto fail = [&result](const char *error, const QString &message) {
+        result.ok = false;
+        result.error = QLatin1String(error);
+        result.message = message;
+        return result;
+    };
+
+    QVariantList binds;
+    QString sql;
+    const char *name = "";
+    switch (op.kind) {
+    case TaskBulkOp::Kind::SetCompleted:
+        // Уже бывшие в нужном состоянии строки не переписываются
+        binds << (op.isCompleted ? 1 : 0) << (op.isCompleted ? 1 : 0);
+        sql = QStringLiteral("UPDATE tasks SET isCompleted = ? "
+                             "WHERE isCompleted <> ? AND (%1)");
+        name = "bulkSetCompleted";
+        break;
+    case TaskBulkOp::Kind::Delete:
+        // Связи в task_tags снимает ON DELETE CASCADE
+        sql = QStringLiteral("DELETE FROM tasks WHERE %1");
+        name = "bulkDeleteTasks";
+        break;
+    case TaskBulkOp::Kind::AddTags:
+        for (const QUuid &id : op.tags) {
+            binds << uuidToStr(id);
+        }
+        sql = QStringLiteral("INSERT OR IGNORE INTO task_tags(task_id, tag_id) "
+                             "SELECT tasks.id, tags.id FROM tasks "
+                             "JOIN tags ON tags.id IN (%2) WHERE %1");
+        name = "bulkLinkTags";
+        break;
+    case TaskBulkOp::Kind::RemoveTags:
+        for (const QUuid &id : op.tags) {
+            binds << uuidToStr(id);
+        }
+        sql = QStringLiteral("DELETE FROM task_tags WHERE tag_id IN (%2) "
+                             "AND task_id IN (SELECT tasks.id FROM tasks WHERE %1)");
+        name = "bulkUnlinkTags";
+        break;
+    }
+
+    sql = sql.arg(taskFilterSql(op.filter, binds));
+    if (!op.tags.isEmpty()) {
+        sql = sql.arg(placeholders(op.tags.size()));
+    }
+    qInfo(appSql) << "Bulk" << name << "filter binds=" << binds.size();
+
     if (!m_db.transaction()) {
         qWarning(appSql) << "tx begin:" << m_db.lastError().text();
     }
 
-    QSqlQuery query(m_db);
-
-    if (!query.exec("DELETE FROM task_tags")) {
-        qWarning(appSql) << "clear task_tags:" << query.lastError().text();
+    if (!op.tags.isEmpty() && !tagsExist(m_db, op.tags)) {
         m_db.rollback();
-        return false;
+        return fail("not_found", QStringLiteral("One or more tags not found"));
     }
 
-    if (!query.exec("DELETE FROM tasks")) {
-        qWarning(appSql) << "clear tasks:" << query.lastError().text();
-        m_db.rollback();
-        return false;
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    for (const QVariant &value : std::as_const(binds)) {
+        query.addBindValue(value);
     }
 
-    if (!query.exec("DELETE FROM tags")) {
-        qWarning(appSql) << "clear tags:" << query.lastError().text();
+    if (!execTimed(query, name)) {
+        qWarning(appSql) << "applyBulk:" << query.lastError().text();
         m_db.rollback();
-        return false;
+        return fail("internal_error", QStringLiteral("Bulk operation failed"));
     }
+    const qint64 affected = query.numRowsAffected();
 
     if (!m_db.commit()) {
         qCritical(appSql) << "tx commit:" << m_db.lastError().text();
-        return false;
+        m_db.rollback();
+        return fail("internal_error", QStringLiteral("Bulk operation failed"));
     }
 
-    qInfo(appSql) << "All cleared";
-    return true;
+    qInfo(appSql) << "Bulk" << name << "affected=" << affected;
+    result.ok = true;
+    result.affected = affected;
+    return result;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -388,26 +1270,108 @@ bool SQLiteStorage::deleteAll() {
 // ─────────────────────────────────────────────────────────────────────────────
 std::vector<Tag> SQLiteStorage::getAllTags() const {
     std::vector<Tag> out;
+
+    forEachTag([&out](const Tag &tag) {
+        out.push_back(tag);
+        return true;
+    });
+
+    qInfo(appSql) << "→" << out.size() << "tags fetched";
+    return out;
+}
+
+bool SQLiteStorage::forEachTag(
+    const std::function<bool(const Tag &)> &visitor) const {
     QSqlQuery query(m_db);
+    query.setForwardOnly(true);
 
-    if (!query.exec("SELECT id, name FROM tags ORDER BY name ASC")) {
+    if (!execTimed(query, "scanTags",
+                   "SELECT id, name FROM tags ORDER BY name ASC")) {
         qWarning(appSql) << "getAllTags:" << query.lastError().text();
-        return out;
+        return false;
     }
 
+    Tag tag;
     while (query.next()) {
-        Tag tag;
         tag.id = strToUuid(query.value(0).toString());
         tag.name = query.value(1).toString();
-        out.push_back(std::move(tag));
+        if (!visitor(tag)) {
+            break;
+        }
+    }
+    if (query.lastError().isValid()) {
+        qWarning(appSql) << "getAllTags:" << query.lastError().text();
+        return false;
     }
 
-    qInfo(appSql) << "→" << out.size() << "tags fetched";
-    return out;
+    return true;
+}
+
+bool SQLiteStorage::forEachTagUsage(
+    const std::function<bool(const Tag &, qint64 taskCount)> &visitor) const {
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+
+    // порядок — по уникальному индексу name, счётчик — поиск по ключу tag_stats
+    if (!execTimed(query, "scanTagUsage",
+                   "SELECT g.id, g.name, COALESCE(s.task_count, 0) "
+                   "FROM tags g LEFT JOIN tag_stats s ON s.tag_id = g.id "
+                   "ORDER BY g.name ASC")) {
+        qWarning(appSql) << "forEachTagUsage:" << query.lastError().text();
+        return false;
+    }
+
+    Tag tag;
+    while (query.next()) {
+        tag.id = strToUuid(query.value(0).toString());
+        tag.name = query.value(1).toString();
+        if (!visitor(tag, query.value(2).toLongLong())) {
+            break;
+        }
+    }
+    if (query.lastError().isValid()) {
+        qWarning(appSql) << "forEachTagUsage:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<TaskStats> SQLiteStorage::getTaskStats() const {
+    QSqlQuery query(m_db);
+    query.prepare("SELECT total, completed FROM task_stats WHERE id = 0");
+    if (!execTimed(query, "getTaskStats") || !query.next()) {
+        qWarning(appSql) << "getTaskStats:" << query.lastError().text();
+        return std::nullopt;
+    }
+
+    TaskStats stats;
+    stats.total = query.value(0).toLongLong();
+    stats.completed = query.value(1).toLongLong();
+    return stats;
+}
+
+std::optional<Tag> SQLiteStorage::getTagById(const QUuid &id) const {
+    QSqlQuery query(m_db);
+    query.prepare("SELECT id, name FROM tags WHERE id = ?");
+    query.addBindValue(uuidToStr(id));
+
+    if (!execTimed(query, "selectTag")) {
+        qWarning(appSql) << "getTagById:" << query.lastError().text();
+        return std::nullopt;
+    }
+    if (!query.next()) {
+        return std::nullopt;
+    }
+
+    Tag tag;
+    tag.id = strToUuid(query.value(0).toString());
+    tag.name = query.value(1).toString();
+    return tag;
 }
 
 QUuid SQLiteStorage::addTag(const Tag &tag) {
-    const QUuid newId = tag.id.isNull() ? QUuid::createUuid() : tag.id;
+    const QUuid newId = tag.id.isNull() ? createUuidV7() : tag.id;
     qInfo(appSql) << "Insert tag id=" << uuidToStr(newId)
                   << "name=" << tag.name;
 
@@ -416,13 +1380,13 @@ QUuid SQLiteStorage::addTag(const Tag &tag) {
     ins.addBindValue(uuidToStr(newId));
     ins.addBindValue(tag.name);
 
-    if (!ins.exec()) {
+    if (!execTimed(ins, "insertTag")) {
         qWarning(appSql) << "addTag insert failed:" << ins.lastError().text()
         << "trying SELECT existing by name";
         sel.prepare("SELECT id FROM tags WHERE name = ?");
         sel.addBindValue(tag.name);
 
-        if (sel.exec() && sel.next()) {
+        if (execTimed(sel, "selectTagByName") && sel.next()) {
             const QUuid existingId = strToUuid(sel.value(0).toString());
             if (!existingId.isNull()) {
                 qInfo(appSql) << "Tag exists id=" << uuidToStr(existingId);
@@ -436,3 +1400,137 @@ QUuid SQLiteStorage::addTag(const Tag &tag) {
     qInfo(appSql) << "Tag inserted id=" << uuidToStr(newId);
     return newId;
 }
+
+TagDeleteResult SQLiteStorage::deleteTag(const QUuid &id) {
+    qInfo(appSql) << "Delete tag id=" << uuidToStr(id);
+    if (!m_db.transaction()) {
+        qWarning(appSql) << "tx begin:" << m_db.lastError().text();
+    }
+
+    // Связи снимаются явно (по idx_task_tags_tag, как и каскад), чтобы знать
+    // их число: задачи с ними изменились
+    TagDeleteResult result;
+    QSqlQuery links(m_db), query(m_db);
+    links.prepare("DELETE FROM task_tags WHERE tag_id = ?");
+    links.addBindValue(uuidToStr(id));
+    query.prepare("DELETE FROM tags WHERE id = ?");
+    query.addBindValue(uuidToStr(id));
+
+    if (!execTimed(links, "deleteTagLinks")) {
+        qWarning(appSql) << "deleteTag links:" << links.lastError().text();
+        m_db.rollback();
+        return result;
+    }
+    if (!execTimed(query, "deleteTag")) {
+        qWarning(appSql) << "deleteTag:" << query.lastError().text();
+        m_db.rollback();
+        return result;
+    }
+
+    if (query.numRowsAffected() == 0) {
+        qInfo(appSql) << "Tag not found id=" << uuidToStr(id);
+        m_db.rollback();
+        result.status = DeleteResult::NotFound;
+        return result;
+    }
+
+    if (!m_db.commit()) {
+        qCritical(appSql) << "tx commit:" << m_db.lastError().text();
+        m_db.rollback();
+        return result;
+    }
+
+    result.status = DeleteResult::Deleted;
+    result.linksRemoved = links.numRowsAffected();
+    return result;
+}
+
+std::optional<qint64> SQLiteStorage::deleteAllTags() {
+    qInfo(appSql) << "Delete ALL tags";
+    if (!m_db.transaction()) {
+        qWarning(appSql) << "tx begin:" << m_db.lastError().text();
+    }
+
+    // Связи очищаются целиком заранее — каскад построчно здесь дороже
+    QSqlQuery query(m_db);
+
+    if (!execTimed(query, "clearTaskTags", "DELETE FROM task_tags")) {
+        qWarning(appSql) << "clear task_tags:" << query.lastError().text();
+        m_db.rollback();
+        return std::nullopt;
+    }
+    const qint64 linksRemoved = query.numRowsAffected();
+
+    if (!execTimed(query, "clearTags", "DELETE FROM tags")) {
+        qWarning(appSql) << "clear tags:" << query.lastError().text();
+        m_db.rollback();
+        return std::nullopt;
+    }
+
+    if (!m_db.commit()) {
+        qCritical(appSql) << "tx commit:" << m_db.lastError().text();
+        m_db.rollback();
+        return std::nullopt;
+    }
+
+    return linksRemoved;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// idempotency keys
+// ─────────────────────────────────────────────────────────────────────────────
+std::optional<IdempotencyRecord>
+SQLiteStorage::getIdempotencyRecord(const QString &key) const {
+    QSqlQuery query(m_db);
+    query.prepare("SELECT fingerprint, status, content_type, body, created_at "
+                  "FROM idempotency_keys WHERE key = ?");
+    query.addBindValue(key);
+
+    if (!execTimed(query, "selectIdempotency")) {
+        qWarning(appSql) << "getIdempotencyRecord failed:" << query.lastError().text();
+        return std::nullopt;
+    }
+    if (!query.next()) {
+        return std::nullopt;
+    }
+
+    IdempotencyRecord record;
+    record.key = key;
+    record.fingerprint = query.value(0).toByteArray();
+    record.status = query.value(1).toInt();
+    record.contentType = query.value(2).toString().toLatin1();
+    record.body = query.value(3).toByteArray();
+    record.createdAtMs = query.value(4).toLongLong();
+    return record;
+}
+
+bool SQLiteStorage::putIdempotencyRecord(const IdempotencyRecord &record) {
+    QSqlQuery query(m_db);
+    query.prepare("INSERT OR REPLACE INTO idempotency_keys"
+                  "(key, fingerprint, status, content_type, body, created_at) "
+                  "VALUES(?, ?, ?, ?, ?, ?)");
+    query.addBindValue(record.key);
+    query.addBindValue(record.fingerprint);
+    query.addBindValue(record.status);
+    query.addBindValue(QString::fromLatin1(record.contentType));
+    query.addBindValue(record.body);
+    query.addBindValue(record.createdAtMs);
+
+    if (!execTimed(query, "upsertIdempotency")) {
+        qWarning(appSql) << "putIdempotencyRecord failed:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+int SQLiteStorage::purgeIdempotencyRecords(qint64 createdBeforeMs) {
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM idempotency_keys WHERE created_at < ?");
+    query.addBindValue(createdBeforeMs);
+
+    if (!execTimed(query, "purgeIdempotency")) {
+        qWarning(appSql) << "purgeIdempotencyRecords failed:" << query.lastError().text();
+        return -1;
+    }
+    return query.numRowsAffected();
+}
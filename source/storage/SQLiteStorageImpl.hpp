@@ -6,18 +6,45 @@
 
 class SQLiteStorage : public IStorage {
 public:
-    explicit SQLiteStorage(const QString &dbPath);
+    // connectionName — имя соединения QSqlDatabase. Соединение привязано к
+    // потоку, поэтому для работы из нескольких потоков нужен свой экземпляр
+    // (со своим именем) на каждый поток.
+    explicit SQLiteStorage(const QString &dbPath,
+                           const QString &connectionName =
+                               QLatin1String(QSqlDatabase::defaultConnection));
 
     std::vector<Task> getAllTasks() const override;
     std::optional<Task> getTaskById(const QUuid& id) const override;
+    std::optional<Task> getTaskById(const QUuid &id, TaskFields fields) const override;
+    bool forEachTask(const std::function<bool(const Task &)> &visitor) const override;
+    bool forEachTask(TaskFields fields,
+                     const std::function<bool(const Task &)> &visitor) const override;
+    bool forEachTaskBatch(const TaskScan &scan,
+                          const std::function<bool(const TaskBatch &)> &visitor) const override;
+    std::optional<TaskQueryPlan> explainTaskScan(const TaskScan &scan) const override;
 
     QUuid addTask(const Task &task) override;
-    bool updateTask(const QUuid &id, const Task &task) override;
-    bool deleteTask(const QUuid &id) override;
+    TaskMutationResult patchTask(const QUuid &id, const TaskPatch &patch) override;
+    TaskMutationResult deleteTask(const QUuid &id) override;
     bool deleteAll() override;
 
+    std::vector<TaskMutationResult>
+    applyMutations(const std::vector<TaskMutation> &ops, bool atomic) override;
+    TaskBulkResult applyBulk(const TaskBulkOp &op) override;
+
     std::vector<Tag> getAllTags() const override;
+    bool forEachTag(const std::function<bool(const Tag &)> &visitor) const override;
+    std::optional<TaskStats> getTaskStats() const override;
+    bool forEachTagUsage(
+        const std::function<bool(const Tag &, qint64 taskCount)> &visitor) const override;
+    std::optional<Tag> getTagById(const QUuid &id) const override;
     QUuid addTag(const Tag& tag) override;
+    TagDeleteResult deleteTag(const QUuid &id) override;
+    std::optional<qint64> deleteAllTags() override;
+
+    std::optional<IdempotencyRecord> getIdempotencyRecord(const QString &key) const override;
+    bool putIdempotencyRecord(const IdempotencyRecord &record) override;
+    int purgeIdempotencyRecords(qint64 createdBeforeMs) override;
 
 private:
     QSqlDatabase m_db;
@@ -0,0 +1,267 @@
+#include <QTimer>
+#include <QtCore/QtEnvironmentVariables>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "Admission.hpp"
+#include "Logger.hpp"
+
+namespace admission {
+namespace {
+
+constexpr int kProbeIntervalMs = 20;
+constexpr double kLagSmoothing = 0.2;
+constexpr std::array<int, kRouteClassCount> kTargetMultiplier{4, 2, 1};
+
+// LatencyTarget: окно минимума задержки и шаги доли отсекаемых запросов
+constexpr qint64 kShedIntervalNs = 100'000'000;
+constexpr double kShedStep = 0.1;
+constexpr double kShedBackoff = 0.5;
+constexpr double kShedMinFraction = 0.01;
+
+qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct ClassState {
+    std::atomic<int> maxQueueDelayMs{0};
+    std::atomic<quint64> rejected{0};
+    // LatencyTarget: доля отсекаемых и накопленный «долг» отказов — отказ,
+    // когда долг дошёл до 1, так что отсекается ровно эта доля запросов
+    std::atomic<double> shedFraction{0.0};
+    std::atomic<double> shedCredit{0.0};
+};
+
+struct State {
+    std::array<ClassState, kRouteClassCount> classes;
+    std::atomic<int> mode{static_cast<int>(Mode::Static)};
+    std::atomic<int> targetDelayMs{50};
+    std::atomic<double> lagMs{0.0};
+    std::atomic<qint64> lastTickNs{0};
+    std::atomic<double> windowMinLagMs{std::numeric_limits<double>::infinity()};
+    std::atomic<qint64> windowStartNs{0};
+
+    State() { apply(configFromEnvironment()); }
+
+    void apply(const Config &config) {
+        mode.store(static_cast<int>(config.mode), std::memory_order_relaxed);
+        targetDelayMs.store(std::max(1, config.targetDelayMs), std::memory_order_relaxed);
+        for (int i = 0; i < kRouteClassCount; ++i) {
+            classes[i].maxQueueDelayMs.store(config.maxQueueDelayMs[i],
+                                             std::memory_order_relaxed);
+            classes[i].shedFraction.store(0.0, std::memory_order_relaxed);
+            classes[i].shedCredit.store(0.0, std::memory_order_relaxed);
+        }
+    }
+};
+
+State &state() {
+    static State instance;
+    return instance;
+}
+
+ClassState &classState(RouteClass routeClass) {
+    return state().classes[static_cast<int>(routeClass)];
+}
+
+bool isLatencyTarget(const State &s) {
+    return static_cast<Mode>(s.mode.load(std::memory_order_relaxed)) == Mode::LatencyTarget;
+}
+
+// Конец окна: минимум задержки за окно против цели каждого класса
+void adaptShedding(State &s, double minLagMs) {
+    const int target = s.targetDelayMs.load(std::memory_order_relaxed);
+    for (int i = 0; i < kRouteClassCount; ++i) {
+        ClassState &c = s.classes[i];
+        double fraction = c.shedFraction.load(std::memory_order_relaxed);
+        if (minLagMs > target * kTargetMultiplier[i]) {
+            fraction = std::min(1.0, fraction + kShedStep);
+        } else {
+            fraction *= kShedBackoff;
+            if (fraction < kShedMinFraction) {
+                fraction = 0.0;
+                c.shedCredit.store(0.0, std::memory_order_relaxed);
+            }
+        }
+        c.shedFraction.store(fraction, std::memory_order_relaxed);
+    }
+}
+
+void onProbeTick() {
+    State &s = state();
+    const qint64 now = nowNs();
+    const qint64 last = s.lastTickNs.exchange(now, std::memory_order_relaxed);
+    if (last == 0) {
+        return;
+    }
+
+    const double lag = std::max(0.0, double(now - last) / 1e6 - kProbeIntervalMs);
+    const double smoothed = s.lagMs.load(std::memory_order_relaxed) * (1.0 - kLagSmoothing) +
+                            lag * kLagSmoothing;
+    s.lagMs.store(smoothed, std::memory_order_relaxed);
+
+    if (!isLatencyTarget(s)) {
+        return;
+    }
+    const double minLag = std::min(s.windowMinLagMs.load(std::memory_order_relaxed), lag);
+    const qint64 windowStart = s.windowStartNs.load(std::memory_order_relaxed);
+    if (windowStart == 0 || now - windowStart < kShedIntervalNs) {
+        s.windowMinLagMs.store(minLag, std::memory_order_relaxed);
+        if (windowStart == 0) {
+            s.windowStartNs.store(now, std::memory_order_relaxed);
+        }
+        return;
+    }
+    adaptShedding(s, minLag);
+    s.windowMinLagMs.store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+    s.windowStartNs.store(now, std::memory_order_relaxed);
+}
+
+} // namespace
+
+const char *routeClassName(RouteClass routeClass) {
+    switch (routeClass) {
+    case RouteClass::Read: return "read";
+    case RouteClass::Write: return "write";
+    case RouteClass::Bulk: return "bulk";
+    }
+    return "unknown";
+}
+
+Config configFromEnvironment() {
+    Config config;
+    const QString mode = qEnvironmentVariable("TASKLIT_ADMISSION_MODE").trimmed().toLower();
+    if (mode == QLatin1String("latency")) {
+        config.mode = Mode::LatencyTarget;
+    }
+
+    bool ok = false;
+    const int target = qEnvironmentVariableIntValue("TASKLIT_ADMISSION_TARGET_MS", &ok);
+    if (ok && target > 0) {
+        config.targetDelayMs = target;
+    }
+    return config;
+}
+
+void configure(const Config &config) {
+    state().apply(config);
+}
+
+void startLagProbe(QObject *parent) {
+    auto *timer = new QTimer(parent);
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setInterval(kProbeIntervalMs);
+    QObject::connect(timer, &QTimer::timeout, timer, &onProbeTick);
+    timer->start();
+
+    const State &s = state();
+    qInfo(appHttp) << "Admission control:"
+                   << (static_cast<Mode>(s.mode.load()) == Mode::LatencyTarget
+                           ? "latency target" : "static")
+                   << "| targetMs=" << s.targetDelayMs.load();
+}
+
+// Задержка очереди: сглаженное опоздание пробы или, если проба сама
+// сейчас просрочена (цикл занят), текущее опоздание — что больше
+double queueDelayMs() {
+    const State &s = state();
+    const double smoothed = s.lagMs.load(std::memory_order_relaxed);
+    const qint64 last = s.lastTickNs.load(std::memory_order_relaxed);
+    if (last == 0) {
+        return smoothed;
+    }
+    const double overdue = double(nowNs() - last) / 1e6 - kProbeIntervalMs;
+    return std::max(smoothed, overdue);
+}
+
+int queueDelayThresholdMs(RouteClass routeClass) {
+    const State &s = state();
+    if (isLatencyTarget(s)) {
+        return s.targetDelayMs.load(std::memory_order_relaxed) *
+               kTargetMultiplier[static_cast<int>(routeClass)];
+    }
+    return classState(routeClass).maxQueueDelayMs.load(std::memory_order_relaxed);
+}
+
+double shedFraction(RouteClass routeClass) {
+    if (isLatencyTarget(state())) {
+        return classState(routeClass).shedFraction.load(std::memory_order_relaxed);
+    }
+    return queueDelayMs() > queueDelayThresholdMs(routeClass) ? 1.0 : 0.0;
+}
+
+Decision tryAdmit(RouteClass routeClass) {
+    Decision decision;
+    ClassState &c = classState(routeClass);
+    bool shed = false;
+    if (isLatencyTarget(state())) {
+        const double fraction = c.shedFraction.load(std::memory_order_relaxed);
+        if (fraction > 0.0) {
+            double credit = c.shedCredit.load(std::memory_order_relaxed) + fraction;
+            shed = credit >= 1.0;
+            if (shed) {
+                credit -= 1.0;
+            }
+            c.shedCredit.store(credit, std::memory_order_relaxed);
+        }
+    } else {
+        shed = queueDelayMs() > queueDelayThresholdMs(routeClass);
+    }
+
+    if (shed) {
+        c.rejected.fetch_add(1, std::memory_order_relaxed);
+        decision.admitted = false;
+        decision.retryAfterSeconds = std::max(1, int(std::ceil(queueDelayMs() / 1000.0)));
+    }
+    return decision;
+}
+
+void appendPrometheus(QByteArray &out) {
+    const State &s = state();
+
+    out.append("# HELP tasklit_admission_queue_delay_seconds Estimated event-loop queue delay.\n"
+               "# TYPE tasklit_admission_queue_delay_seconds gauge\n"
+               "tasklit_admission_queue_delay_seconds ");
+    out.append(QByteArray::number(queueDelayMs() / 1000.0, 'g', 6)).append('\n');
+
+    out.append("# HELP tasklit_admission_queue_delay_threshold_seconds Queue delay above "
+               "which a route class is shed.\n"
+               "# TYPE tasklit_admission_queue_delay_threshold_seconds gauge\n");
+    for (int i = 0; i < kRouteClassCount; ++i) {
+        out.append("tasklit_admission_queue_delay_threshold_seconds{class=\"")
+            .append(routeClassName(static_cast<RouteClass>(i)))
+            .append("\"} ")
+            .append(QByteArray::number(
+                queueDelayThresholdMs(static_cast<RouteClass>(i)) / 1000.0, 'g', 6))
+            .append('\n');
+    }
+
+    out.append("# HELP tasklit_admission_shed_fraction Fraction of a route class's "
+               "requests currently shed.\n"
+               "# TYPE tasklit_admission_shed_fraction gauge\n");
+    for (int i = 0; i < kRouteClassCount; ++i) {
+        out.append("tasklit_admission_shed_fraction{class=\"")
+            .append(routeClassName(static_cast<RouteClass>(i)))
+            .append("\"} ")
+            .append(QByteArray::number(shedFraction(static_cast<RouteClass>(i)), 'g', 6))
+            .append('\n');
+    }
+
+    out.append("# HELP tasklit_admission_rejected_total Requests shed with 503.\n"
+               "# TYPE tasklit_admission_rejected_total counter\n");
+    for (int i = 0; i < kRouteClassCount; ++i) {
+        out.append("tasklit_admission_rejected_total{class=\"")
+            .append(routeClassName(static_cast<RouteClass>(i)))
+            .append("\"} ")
+            .append(QByteArray::number(s.classes[i].rejected.load()))
+            .append('\n');
+    }
+}
+
+} // namespace admission
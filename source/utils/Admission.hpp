@@ -0,0 +1,68 @@
+#ifndef ADMISSION_HPP
+#define ADMISSION_HPP
+
+#include <QByteArray>
+#include <QObject>
+
+#include <array>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Admission control перед маршрутами. Все запросы обслуживает один цикл
+// событий и обработчики синхронны: одновременно выполняется один запрос,
+// а остальные ждут в сокетах и очереди событий. Поэтому ограничивается не
+// число запросов в работе, а длина этой очереди во времени — задержка цикла,
+// которую меряет таймер-проба. Класс маршрута отсекается, если задержка
+// выше его порога; клиент получает 503 + Retry-After. Первым отсекается
+// Bulk, последним — Read.
+//
+// Режимы:
+//   Static         — класс отсекается целиком, пока задержка выше порога из
+//                    конфигурации;
+//   LatencyTarget  — как CoDel: цель класса кратна целевой задержке (Read ×4,
+//                    Write ×2, Bulk ×1); если минимум задержки за окно 100 мс
+//                    выше цели, доля отсекаемых запросов класса растёт на 0.1,
+//                    иначе — вдвое убывает. Кратковременный всплеск минимум не
+//                    поднимает, а устойчивая очередь отсекается постепенно.
+// Переменные окружения: TASKLIT_ADMISSION_MODE=static|latency,
+// TASKLIT_ADMISSION_TARGET_MS (по умолчанию 50).
+// ─────────────────────────────────────────────────────────────────────────────
+namespace admission {
+
+enum class RouteClass { Read = 0, Write = 1, Bulk = 2 };
+inline constexpr int kRouteClassCount = 3;
+
+const char *routeClassName(RouteClass routeClass);
+
+enum class Mode { Static, LatencyTarget };
+
+struct Config {
+    Mode mode = Mode::Static;
+    std::array<int, kRouteClassCount> maxQueueDelayMs{2000, 1000, 250};
+    int targetDelayMs = 50;
+};
+
+Config configFromEnvironment();
+void configure(const Config &config);
+
+// Таймер-проба задержки цикла; запускать в потоке HTTP-сервера
+void startLagProbe(QObject *parent);
+
+struct Decision {
+    bool admitted = true;
+    int retryAfterSeconds = 0;
+};
+
+Decision tryAdmit(RouteClass routeClass);
+
+double queueDelayMs();
+// Static — порог, LatencyTarget — цель класса
+int queueDelayThresholdMs(RouteClass routeClass);
+// Доля отсекаемых запросов класса: Static — 0 или 1 по текущей задержке
+double shedFraction(RouteClass routeClass);
+
+// Серии tasklit_admission_* для /metrics
+void appendPrometheus(QByteArray &out);
+
+} // namespace admission
+
+#endif // ADMISSION_HPP
@@ -0,0 +1,140 @@
+#include <QtNetwork/QHttpHeaders>
+
+#include "ChunkedResponse.hpp"
+#include "Logger.hpp"
+
+ChunkedResponse::ChunkedResponse(QHttpServerResponder &responder,
+                                 qsizetype chunkSize)
+    : m_responder(&responder), m_chunkSize(chunkSize) {
+    m_buffer.reserve(m_chunkSize + m_chunkSize / 4);
+}
+
+ChunkedResponse::ChunkedResponse(std::unique_ptr<QHttpServerResponder> owned,
+                                 qsizetype chunkSize)
+    : m_owned(std::move(owned)), m_responder(m_owned.get()), m_chunkSize(chunkSize) {}
+
+ChunkedResponse::~ChunkedResponse() {
+    // Поток прерван (исключение посреди ответа, закрытый StreamPump) —
+    // закрываем chunked-тело, клиент получит усечённый JSON вместо зависшего
+    // соединения.
+    if (m_started && !m_finished) {
+        qWarning(appHttp) << "Chunked response aborted";
+        sendHeaders();
+        m_responder->writeEndChunked(QByteArrayView());
+        m_finished = true;
+        complete(m_status);
+    }
+}
+
+std::unique_ptr<ChunkedResponse> ChunkedResponse::detach() {
+    std::unique_ptr<ChunkedResponse> next(new ChunkedResponse(
+        std::make_unique<QHttpServerResponder>(std::move(*m_responder)), m_chunkSize));
+    next->m_buffer = std::move(m_buffer);
+    next->m_contentType = std::move(m_contentType);
+    next->m_beginStatus = m_beginStatus;
+    next->m_started = m_started;
+    next->m_headersSent = m_headersSent;
+    next->m_finished = m_finished;
+    next->m_status = m_status;
+    next->m_onDone = std::move(m_onDone);
+
+    m_buffer = QByteArray();
+    m_onDone = {};
+    m_finished = true;
+    m_detached = true;
+    return next;
+}
+
+void ChunkedResponse::complete(int status) {
+    if (m_onDone) {
+        const DoneCallback callback = std::move(m_onDone);
+        m_onDone = {};
+        callback(status);
+    }
+}
+
+void ChunkedResponse::begin(QByteArrayView contentType,
+                            QHttpServerResponder::StatusCode status) {
+    if (m_started || m_finished) {
+        return;
+    }
+
+    m_contentType = contentType.toByteArray();
+    m_beginStatus = status;
+    m_started = true;
+    m_status = static_cast<int>(status);
+}
+
+void ChunkedResponse::sendHeaders() {
+    if (m_headersSent) {
+        return;
+    }
+
+    QHttpHeaders headers;
+    headers.append(QHttpHeaders::WellKnownHeader::ContentType, m_contentType);
+    m_responder->writeBeginChunked(headers, m_beginStatus);
+    m_headersSent = true;
+}
+
+void ChunkedResponse::write(QByteArrayView data) {
+    m_buffer.append(data);
+    flushIfFull();
+}
+
+void ChunkedResponse::flushIfFull() {
+    if (m_buffer.size() < m_chunkSize) {
+        return;
+    }
+
+    sendHeaders();
+    m_responder->writeChunk(m_buffer);
+    m_buffer.resize(0);
+}
+
+void ChunkedResponse::finish() {
+    if (!m_started || m_finished) {
+        return;
+    }
+
+    sendHeaders();
+    m_responder->writeEndChunked(m_buffer);
+    m_buffer.resize(0);
+    m_finished = true;
+    complete(m_status);
+}
+
+void ChunkedResponse::fail(const QHttpServerResponse &response) {
+    if (m_finished) {
+        return;
+    }
+
+    if (!m_headersSent) {
+        m_buffer.resize(0);
+        m_responder->sendResponse(response);
+        m_finished = true;
+        m_status = static_cast<int>(response.statusCode());
+        complete(m_status);
+        return;
+    }
+
+    // Статус 200 уже отправлен; в метриках и логах — фактический исход
+    qWarning(appHttp) << "Chunked response failed after" << m_status << "was sent";
+    m_responder->writeEndChunked(QByteArrayView());
+    m_buffer.resize(0);
+    m_finished = true;
+    m_status = static_cast<int>(response.statusCode());
+    complete(m_status);
+}
+
+void ChunkedResponse::sendResponse(const QHttpServerResponse &response) {
+    if (m_headersSent || m_finished) {
+        qWarning(appHttp) << "sendResponse after chunked stream started";
+        return;
+    }
+
+    m_buffer.resize(0);
+    m_responder->sendResponse(response);
+    m_finished = true;
+    m_status = static_cast<int>(response.statusCode());
+    complete(m_status);
+}
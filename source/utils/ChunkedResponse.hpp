@@ -0,0 +1,84 @@
+#ifndef CHUNKEDRESPONSE_HPP
+#define CHUNKEDRESPONSE_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QtHttpServer/QHttpServerResponder>
+#include <QtHttpServer/QHttpServerResponse>
+#include <functional>
+#include <memory>
+
+// Потоковый ответ с Transfer-Encoding: chunked поверх QHttpServerResponder.
+// Данные копятся в буфере и передаются сокету чанками по chunkSize байт.
+// Сокет отправляет их только после возврата в цикл событий: тело,
+// записанное за один обработчик, целиком лежит в его буфере записи.
+// Большие ответы дописываются по частям через StreamPump (detach()).
+// Заголовки уходят вместе с первым чанком: пока он не отправлен, ответ ещё
+// можно заменить ошибкой.
+class ChunkedResponse {
+public:
+    // Итог ответа (статус) — один раз, когда ответ завершён любым путём
+    using DoneCallback = std::function<void(int status)>;
+
+    explicit ChunkedResponse(QHttpServerResponder &responder,
+                             qsizetype chunkSize = 16 * 1024);
+    ~ChunkedResponse();
+
+    ChunkedResponse(const ChunkedResponse &) = delete;
+    ChunkedResponse &operator=(const ChunkedResponse &) = delete;
+
+    bool started() const { return m_started; }
+    bool headersSent() const { return m_headersSent; }
+    bool finished() const { return m_finished; }
+    bool detached() const { return m_detached; }
+    bool canceled() const { return m_responder->isResponseCanceled(); }
+    int status() const { return m_status; }
+
+    void onDone(DoneCallback callback) { m_onDone = std::move(callback); }
+
+    // Ответ продолжится после возврата из обработчика: responder, буфер и
+    // onDone переходят в новый объект, этот больше ничего не пишет
+    std::unique_ptr<ChunkedResponse> detach();
+
+    void begin(QByteArrayView contentType = "application/json",
+               QHttpServerResponder::StatusCode status =
+                   QHttpServerResponder::StatusCode::Ok);
+
+    void write(QByteArrayView data);
+
+    // Прямой доступ к буферу для сериализаторов; после записи — flushIfFull()
+    QByteArray &buffer() { return m_buffer; }
+    void flushIfFull();
+
+    void finish();
+
+    // Ошибка посреди потока (например, сбой чтения из БД). Если в сокет ещё
+    // ничего не ушло — вместо потока отправляется response; иначе тело
+    // обрывается незакрытым JSON, чтобы клиент не принял его за полный список
+    void fail(const QHttpServerResponse &response);
+
+    // Обычный (не потоковый) ответ, пока в сокет ничего не ушло
+    void sendResponse(const QHttpServerResponse &response);
+
+private:
+    explicit ChunkedResponse(std::unique_ptr<QHttpServerResponder> owned,
+                             qsizetype chunkSize);
+
+    void sendHeaders();
+    void complete(int status);
+
+    std::unique_ptr<QHttpServerResponder> m_owned;
+    QHttpServerResponder *m_responder;
+    DoneCallback m_onDone;
+    QByteArray m_buffer;
+    QByteArray m_contentType;
+    QHttpServerResponder::StatusCode m_beginStatus = QHttpServerResponder::StatusCode::Ok;
+    qsizetype m_chunkSize;
+    bool m_started = false;
+    bool m_headersSent = false;
+    bool m_finished = false;
+    bool m_detached = false;
+    int m_status = 0;
+};
+
+#endif // CHUNKEDRESPONSE_HPP
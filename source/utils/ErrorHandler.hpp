@@ -4,12 +4,21 @@
 #include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QUuid>
 #include <QtHttpServer/QHttpServerRequest>
 #include <QtHttpServer/QHttpServerResponse>
-#include <functional>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "Admission.hpp"
+#include "ChunkedResponse.hpp"
+#include "JsonWriter.hpp"
 #include "Logger.hpp"
+#include "Metrics.hpp"
+#include "RequestId.hpp"
+#include "Tracing.hpp"
+#include "TrafficCapture.hpp"
 
 inline QHttpServerResponse
 makeApiError(QHttpServerResponse::StatusCode status, const QString &message,
@@ -20,9 +29,7 @@ makeApiError(QHttpServerResponse::StatusCode status, const QString &message,
                     {"type", type},
                     {"message", message},
                     {"status", static_cast<int>(status)},
-                    {"requestId", requestId.isEmpty()
-                                      ? QUuid::createUuid().toString(QUuid::WithoutBraces)
-                                      : requestId},
+                    {"requestId", requestId.isEmpty() ? nextRequestId() : requestId},
                     {"ts", QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs)}};
     if (!details.isEmpty())
         obj.insert("details", details);
@@ -30,57 +37,83 @@ makeApiError(QHttpServerResponse::StatusCode status, const QString &message,
     return QHttpServerResponse(obj, status);
 }
 
+inline QString ensureRequestId(const QString &requestId) {
+    return requestId.isEmpty() ? nextRequestId() : requestId;
+}
+
+// Успешный ответ с уже сериализованным data (JsonWriter) — без QJsonObject
+inline QHttpServerResponse makeApiOkRaw(const QString &message,
+                                        QByteArrayView dataJson,
+                                        const QString &requestId = {},
+                                        QHttpServerResponse::StatusCode status = QHttpServerResponse::StatusCode::Ok) {
+    QByteArray body;
+    body.reserve(160 + dataJson.size());
+    writeApiOkOpen(body, message, ensureRequestId(requestId));
+    if (!dataJson.isEmpty()) {
+        body.append(",\"data\":");
+        body.append(dataJson);
+    }
+    body.append('}');
+    return QHttpServerResponse("application/json", body, status);
+}
+
 inline QHttpServerResponse makeApiOk(const QString &message = QString(),
                                      QJsonObject data = {},
                                      const QString &requestId = {},
                                      QHttpServerResponse::StatusCode status = QHttpServerResponse::StatusCode::Ok) {
-    QJsonObject obj{
-        {"ok", true},
-        {"message", message},
-        {"requestId", requestId.isEmpty()
-                          ? QUuid::createUuid().toString(QUuid::WithoutBraces)
-                          : requestId},
-        {"ts", QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs)}
-    };
-    if (!data.isEmpty())
-        obj.insert("data", data);
-    return QHttpServerResponse(obj, status);
+    return makeApiOkRaw(message,
+                        data.isEmpty() ? QByteArray()
+                                       : QJsonDocument(data).toJson(QJsonDocument::Compact),
+                        requestId, status);
 }
 
-template <typename Fn> auto wrapSafe(const char *routeName, Fn fn) {
-    return [routeName, fn](auto &&...args) -> QHttpServerResponse {
-        const QString requestId =
-            QUuid::createUuid().toString(QUuid::WithoutBraces);
-        const auto started = QDateTime::currentMSecsSinceEpoch();
-        try {
-            auto resp = fn(std::forward<decltype(args)>(args)...,
-                           requestId); // см. сигнатуру ниже
-            const auto elapsed = QDateTime::currentMSecsSinceEpoch() - started;
-            qInfo(appHttp) << "[DONE]" << routeName
-                           << "| requestId=" << requestId << "| ms=" << elapsed;
-            return resp;
-        } catch (const std::exception &e) {
-            const auto elapsed = QDateTime::currentMSecsSinceEpoch() - started;
-            qCritical(appHttp)
-                << "[EXC]" << routeName << "| requestId=" << requestId
-                << "| ms=" << elapsed << "| what=" << e.what();
-            return makeApiError(
-                QHttpServerResponse::StatusCode::InternalServerError,
-                QStringLiteral("Internal error"),
-                QStringLiteral("internal_error"),
-                QJsonObject{{"what", e.what()}}, requestId);
-        } catch (...) {
-            const auto elapsed = QDateTime::currentMSecsSinceEpoch() - started;
-            qCritical(appHttp)
-                << "[EXC]" << routeName << "| requestId=" << requestId
-                << "| ms=" << elapsed << "| unknown exception";
-            return makeApiError(
-                QHttpServerResponse::StatusCode::InternalServerError,
-                QStringLiteral("Internal error"),
-                QStringLiteral("internal_error"),
-                QJsonObject{{"what", "unknown"}}, requestId);
-        }
-    };
+// Начало конверта makeApiOk без закрывающей скобки: `{...,"data":`.
+// Для потоковых ответов — тело data дописывается следом, затем `}`.
+inline void writeApiOkEnvelopeHead(QByteArray &out, const QString &message,
+                                   const QString &requestId) {
+    writeApiOkOpen(out, message, ensureRequestId(requestId));
+    out.append(",\"data\":");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Итог запроса: строка [DONE]/[EXC] в лог и латентность в метрики маршрута
+// ─────────────────────────────────────────────────────────────────────────────
+// body — тело ответа для записи трафика (пусто — не сравнивается при replay)
+inline void reportRequestDone(const char *routeName, const QString &requestId,
+                              metrics::Clock::time_point started, int status,
+                              QByteArrayView body = {}) {
+    const quint64 ns = metrics::elapsedNs(started);
+    metrics::observeHttpRequest(routeName, status, ns);
+    tracing::setRequestStatus(status);
+    capture::recordResponse(routeName, requestId, status, ns, body);
+    qInfo(appHttp) << "[DONE]" << routeName
+                   << "| requestId=" << requestId
+                   << "| status=" << status
+                   << "| ms=" << double(ns) / 1e6;
+}
+
+// what == nullptr → неизвестное исключение
+inline QHttpServerResponse reportRequestFailed(const char *routeName,
+                                               const QString &requestId,
+                                               metrics::Clock::time_point started,
+                                               const char *what) {
+    const quint64 ns = metrics::elapsedNs(started);
+    metrics::observeHttpRequest(
+        routeName,
+        static_cast<int>(QHttpServerResponse::StatusCode::InternalServerError), ns);
+    tracing::setRequestStatus(
+        static_cast<int>(QHttpServerResponse::StatusCode::InternalServerError));
+    capture::recordResponse(
+        routeName, requestId,
+        static_cast<int>(QHttpServerResponse::StatusCode::InternalServerError), ns, {});
+    qCritical(appHttp) << "[EXC]" << routeName
+                       << "| requestId=" << requestId
+                       << "| ms=" << double(ns) / 1e6
+                       << "| what=" << (what ? what : "unknown exception");
+    return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
+                        QStringLiteral("Internal error"),
+                        QStringLiteral("internal_error"),
+                        QJsonObject{{"what", what ? what : "unknown"}}, requestId);
 }
 
 inline void sendNotFound(QHttpServerResponder &responder,
@@ -98,128 +131,178 @@ inline void sendNotFound(QHttpServerResponder &responder,
     responder.sendResponse(response);
 }
 
+// Отказ admission control: 503 + Retry-After, обработчик не вызывается
+inline QHttpServerResponse reportRequestShed(const char *routeName,
+                                             const QString &requestId,
+                                             metrics::Clock::time_point started,
+                                             admission::RouteClass routeClass,
+                                             const admission::Decision &decision) {
+    constexpr auto status = QHttpServerResponse::StatusCode::ServiceUnavailable;
+    const double queueDelayMs = admission::queueDelayMs();
+    const quint64 ns = metrics::elapsedNs(started);
+    metrics::observeHttpRequest(routeName, static_cast<int>(status), ns);
+    tracing::setRequestStatus(static_cast<int>(status));
+    capture::recordResponse(routeName, requestId, static_cast<int>(status), ns, {});
+    qWarning(appHttp) << "[SHED]" << routeName
+                      << "| requestId=" << requestId
+                      << "| class=" << admission::routeClassName(routeClass)
+                      << "| queueDelayMs=" << queueDelayMs
+                      << "| thresholdMs=" << admission::queueDelayThresholdMs(routeClass);
+
+    QHttpServerResponse response = makeApiError(
+        status, QStringLiteral("Server is overloaded, retry later"),
+        QStringLiteral("overloaded"),
+        QJsonObject{{"class", admission::routeClassName(routeClass)},
+                    {"queueDelayMs", queueDelayMs},
+                    {"retryAfter", decision.retryAfterSeconds}},
+        requestId);
+    QHttpHeaders headers = response.headers();
+    headers.append(QHttpHeaders::WellKnownHeader::RetryAfter,
+                   QByteArray::number(decision.retryAfterSeconds));
+    response.setHeaders(std::move(headers));
+    return response;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
-// Safe wrapper overloads с фиксированными сигнатурами
+// wrapSafe: обработчик маршрута принимает аргументы Qt (путь, request) и
+// последним — requestId. Сигнатура выводится из operator() на этапе
+// компиляции, наружу отдаётся лямбда с теми же аргументами без requestId —
+// без std::function, вызов обработчика инлайнится. С RouteClass запрос
+// сначала проходит admission control (см. Admission.hpp).
 // ─────────────────────────────────────────────────────────────────────────────
+namespace route_detail {
 
-inline auto wrapSafe(const char *routeName,
-                     std::function<QHttpServerResponse(const QString &requestId)> fn) {
-    return [routeName, fn]() -> QHttpServerResponse {
-        const QString requestId = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        const qint64 started = QDateTime::currentMSecsSinceEpoch();
-        try {
-            auto resp = fn(requestId);
-            qInfo(appHttp) << "[DONE]" << routeName
-                           << "| requestId=" << requestId
-                           << "| ms=" << (QDateTime::currentMSecsSinceEpoch() - started);
-            return resp;
-        } catch (const std::exception &e) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| what=" << e.what();
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", e.what()}}, requestId);
-        } catch (...) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| unknown exception";
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", "unknown"}}, requestId);
-        }
-    };
+template <typename... Ts> struct TypeList {};
+
+template <typename T>
+struct HandlerTraits : HandlerTraits<decltype(&T::operator())> {};
+
+template <typename C, typename R, typename... Args>
+struct HandlerTraits<R (C::*)(Args...) const> {
+    using ArgsTuple = std::tuple<Args...>;
+};
+
+template <typename C, typename R, typename... Args>
+struct HandlerTraits<R (C::*)(Args...)> : HandlerTraits<R (C::*)(Args...) const> {};
+
+template <typename Tuple, typename Seq> struct FrontArgs;
+
+template <typename Tuple, std::size_t... I>
+struct FrontArgs<Tuple, std::index_sequence<I...>> {
+    using type = TypeList<std::tuple_element_t<I, Tuple>...>;
+};
+
+template <typename Fn> struct RouteArgs {
+    using ArgsTuple = typename HandlerTraits<Fn>::ArgsTuple;
+    static constexpr std::size_t kCount = std::tuple_size_v<ArgsTuple>;
+    static_assert(kCount >= 1 &&
+                      std::is_same_v<std::decay_t<std::tuple_element_t<kCount - 1, ArgsTuple>>,
+                                     QString>,
+                  "route handler must take const QString &requestId as its last argument");
+    using type = typename FrontArgs<ArgsTuple, std::make_index_sequence<kCount - 1>>::type;
+};
+
+// QHttpServerRequest среди аргументов маршрута (для записи трафика)
+inline const QHttpServerRequest *requestArg(const QHttpServerRequest &request) {
+    return &request;
 }
 
-inline auto wrapSafe(const char *routeName,
-                     std::function<QHttpServerResponse(const QHttpServerRequest &request,
-                                                       const QString &requestId)> fn) {
-    return [routeName, fn](const QHttpServerRequest &request) -> QHttpServerResponse {
-        const QString requestId = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        const qint64 started = QDateTime::currentMSecsSinceEpoch();
-        try {
-            auto resp = fn(request, requestId);
-            qInfo(appHttp) << "[DONE]" << routeName
-                           << "| requestId=" << requestId
-                           << "| ms=" << (QDateTime::currentMSecsSinceEpoch() - started);
-            return resp;
-        } catch (const std::exception &e) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| what=" << e.what();
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", e.what()}}, requestId);
-        } catch (...) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| unknown exception";
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", "unknown"}}, requestId);
-        }
-    };
+template <typename T> const QHttpServerRequest *requestArg(const T &) { return nullptr; }
+
+template <typename... Args> const QHttpServerRequest *findRequest(const Args &...args) {
+    const QHttpServerRequest *found = nullptr;
+    ((found = found ? found : requestArg(args)), ...);
+    return found;
 }
 
-inline auto wrapSafe(const char *routeName,
-                     std::function<QHttpServerResponse(qint64 pathId,
-                                                       const QHttpServerRequest &request,
-                                                       const QString &requestId)> fn) {
-    return [routeName, fn](qint64 pathId, const QHttpServerRequest &request) -> QHttpServerResponse {
-        const QString requestId = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        const qint64 started = QDateTime::currentMSecsSinceEpoch();
+template <typename Fn, typename... Args>
+auto bindSafe(const char *routeName, std::optional<admission::RouteClass> routeClass,
+              Fn fn, TypeList<Args...>) {
+    return [routeName, routeClass, fn = std::move(fn)](Args... args) -> QHttpServerResponse {
+        const QString requestId = nextRequestId();
+        const auto started = metrics::Clock::now();
+        tracing::RequestTrace trace(routeName, requestId);
+        if (capture::isActive()) {
+            capture::recordRequest(routeName, findRequest(args...), requestId);
+        }
+        if (routeClass) {
+            const admission::Decision decision = admission::tryAdmit(*routeClass);
+            if (!decision.admitted) {
+                return reportRequestShed(routeName, requestId, started, *routeClass,
+                                         decision);
+            }
+        }
         try {
-            auto resp = fn(pathId, request, requestId);
-            qInfo(appHttp) << "[DONE]" << routeName
-                           << "| requestId=" << requestId
-                           << "| ms=" << (QDateTime::currentMSecsSinceEpoch() - started);
+            QHttpServerResponse resp = fn(std::forward<Args>(args)..., requestId);
+            reportRequestDone(routeName, requestId, started,
+                              static_cast<int>(resp.statusCode()),
+                              capture::isActive() ? QByteArrayView(resp.data())
+                                                  : QByteArrayView());
             return resp;
         } catch (const std::exception &e) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| what=" << e.what();
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", e.what()}}, requestId);
+            return reportRequestFailed(routeName, requestId, started, e.what());
         } catch (...) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| unknown exception";
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", "unknown"}}, requestId);
+            return reportRequestFailed(routeName, requestId, started, nullptr);
         }
     };
 }
 
-inline auto wrapSafe(const char *routeName,
-                     std::function<QHttpServerResponse(const QString &pathArg,
-                                                       const QHttpServerRequest &request,
-                                                       const QString &requestId)> fn) {
-    return [routeName, fn](const QString &pathArg, const QHttpServerRequest &request) -> QHttpServerResponse {
-        const QString requestId = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        const qint64 started = QDateTime::currentMSecsSinceEpoch();
+} // namespace route_detail
+
+template <typename Fn> auto wrapSafe(const char *routeName, Fn fn) {
+    return route_detail::bindSafe(routeName, std::nullopt, std::move(fn),
+                                  typename route_detail::RouteArgs<Fn>::type{});
+}
+
+template <typename Fn>
+auto wrapSafe(const char *routeName, admission::RouteClass routeClass, Fn fn) {
+    return route_detail::bindSafe(routeName, routeClass, std::move(fn),
+                                  typename route_detail::RouteArgs<Fn>::type{});
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Потоковые маршруты: обработчик пишет ответ сам через ChunkedResponse.
+// Итог запроса (лог, метрики) фиксируется, когда ответ завершён, — в том
+// числе позже, если обработчик передал его StreamPump (detach()).
+// Если исключение случилось до отправки первого чанка — отдаём обычный 500,
+// после — поток обрывается (см. ~ChunkedResponse).
+// ─────────────────────────────────────────────────────────────────────────────
+template <typename Fn>
+auto wrapSafeStream(const char *routeName, admission::RouteClass routeClass, Fn fn) {
+    return [routeName, routeClass, fn](const QHttpServerRequest &request,
+                                       QHttpServerResponder &responder) {
+        const QString requestId = nextRequestId();
+        const auto started = metrics::Clock::now();
+        tracing::RequestTrace trace(routeName, requestId);
+        if (capture::isActive()) {
+            capture::recordRequest(routeName, &request, requestId);
+        }
+        ChunkedResponse stream(responder);
+        const admission::Decision decision = admission::tryAdmit(routeClass);
+        if (!decision.admitted) {
+            stream.sendResponse(reportRequestShed(routeName, requestId, started,
+                                                  routeClass, decision));
+            return;
+        }
+        stream.onDone([routeName, requestId, started](int status) {
+            reportRequestDone(routeName, requestId, started, status);
+        });
         try {
-            auto resp = fn(pathArg, request, requestId);
-            qInfo(appHttp) << "[DONE]" << routeName
-                           << "| requestId=" << requestId
-                           << "| ms=" << (QDateTime::currentMSecsSinceEpoch() - started);
-            return resp;
+            fn(request, stream, requestId);
         } catch (const std::exception &e) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| what=" << e.what();
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", e.what()}}, requestId);
+            stream.onDone({});
+            auto error = reportRequestFailed(routeName, requestId, started, e.what());
+            if (!stream.headersSent()) {
+                stream.sendResponse(error);
+            }
         } catch (...) {
-            qCritical(appHttp) << "[EXC]" << routeName
-                               << "| requestId=" << requestId
-                               << "| unknown exception";
-            return makeApiError(QHttpServerResponse::StatusCode::InternalServerError,
-                                "Internal error", "internal_error",
-                                QJsonObject{{"what", "unknown"}}, requestId);
+            stream.onDone({});
+            auto error = reportRequestFailed(routeName, requestId, started, nullptr);
+            if (!stream.headersSent()) {
+                stream.sendResponse(error);
+            }
         }
     };
 }
+
 #endif // ERRORHANDLER_HPP
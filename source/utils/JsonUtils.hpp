@@ -9,6 +9,7 @@
 #include <optional>
 
 #include "Task.hpp"
+#include "UuidCodec.hpp"
 
 inline QHttpServerResponse makeJson(const QJsonObject &obj,
                                     QHttpServerResponse::StatusCode status =
@@ -104,9 +105,9 @@ inline Task patchedTask(const Task &original, const QJsonObject &patch) {
         for (const QJsonValue &v : tagsArray) {
             QUuid id;
             if (v.isString()) {
-                id = QUuid::fromString(v.toString());
+                id = parseUuid(v.toString());
             } else if (v.isObject()) {
-                id = QUuid::fromString(v.toObject().value("id").toString());
+                id = parseUuid(v.toObject().value("id").toString());
             }
             if (!id.isNull()) {
                 newIds.push_back(id);
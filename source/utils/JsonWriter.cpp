@@ -0,0 +1,296 @@
+#include <QDateTime>
+#include <QTimeZone>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+
+#include "JsonWriter.hpp"
+#include "UuidCodec.hpp"
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Худший случай на одну UTF-16 единицу — \u00XX (6 байт)
+constexpr qsizetype kMaxBytesPerUnit = 6;
+
+char *writeEscapedUnit(char *dst, char16_t c) {
+    switch (c) {
+    case u'"':  *dst++ = '\\'; *dst++ = '"';  return dst;
+    case u'\\': *dst++ = '\\'; *dst++ = '\\'; return dst;
+    case u'\b': *dst++ = '\\'; *dst++ = 'b';  return dst;
+    case u'\f': *dst++ = '\\'; *dst++ = 'f';  return dst;
+    case u'\n': *dst++ = '\\'; *dst++ = 'n';  return dst;
+    case u'\r': *dst++ = '\\'; *dst++ = 'r';  return dst;
+    case u'\t': *dst++ = '\\'; *dst++ = 't';  return dst;
+    default:
+        *dst++ = '\\';
+        *dst++ = 'u';
+        *dst++ = '0';
+        *dst++ = '0';
+        *dst++ = kHexDigits[(c >> 4) & 0xF];
+        *dst++ = kHexDigits[c & 0xF];
+        return dst;
+    }
+}
+
+inline bool needsEscape(char16_t c) {
+    return c < 0x20 || c == u'"' || c == u'\\';
+}
+
+struct TimestampCache {
+    qint64 second = -1;
+    char prefix[19]; // yyyy-MM-ddTHH:mm:ss
+};
+
+} // namespace
+
+void writeJsonString(QByteArray &out, QStringView value) {
+    const qsizetype start = out.size();
+    out.resize(start + value.size() * kMaxBytesPerUnit + 2);
+
+    char *const begin = out.data() + start;
+    char *dst = begin;
+    *dst++ = '"';
+
+    const char16_t *src = value.utf16();
+    const char16_t *const end = src + value.size();
+
+    while (src < end) {
+        // быстрый путь: ASCII без экранирования
+        while (src < end && *src < 0x80 && !needsEscape(*src)) {
+            *dst++ = static_cast<char>(*src++);
+        }
+        if (src == end) {
+            break;
+        }
+
+        const char16_t c = *src++;
+        if (c < 0x80) {
+            dst = writeEscapedUnit(dst, c);
+        } else if (c < 0x800) {
+            *dst++ = static_cast<char>(0xC0 | (c >> 6));
+            *dst++ = static_cast<char>(0x80 | (c & 0x3F));
+        } else if (QChar::isHighSurrogate(c) && src < end &&
+                   QChar::isLowSurrogate(*src)) {
+            const char32_t cp = QChar::surrogateToUcs4(c, *src++);
+            *dst++ = static_cast<char>(0xF0 | (cp >> 18));
+            *dst++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            *dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *dst++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (QChar::isSurrogate(c)) {
+            // одиночный суррогат → U+FFFD, как делает QJsonDocument
+            *dst++ = static_cast<char>(0xEF);
+            *dst++ = static_cast<char>(0xBF);
+            *dst++ = static_cast<char>(0xBD);
+        } else {
+            *dst++ = static_cast<char>(0xE0 | (c >> 12));
+            *dst++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    *dst++ = '"';
+    out.resize(start + (dst - begin));
+}
+
+void writeJsonInt(QByteArray &out, qint64 value) {
+    char buf[24];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr - buf);
+}
+
+void writeJsonBool(QByteArray &out, bool value) {
+    out.append(value ? QByteArrayView("true") : QByteArrayView("false"));
+}
+
+void writeJsonUuid(QByteArray &out, const QUuid &id) {
+    char buf[kUuidTextLength + 2];
+    buf[0] = '"';
+    formatUuid(id, buf + 1);
+    buf[kUuidTextLength + 1] = '"';
+    out.append(buf, sizeof(buf));
+}
+
+void writeJsonUuidArray(QByteArray &out, const QVector<QUuid> &ids) {
+    writeJsonUuidArray(out, ids.constData(), ids.size());
+}
+
+void writeJsonUuidArray(QByteArray &out, const QUuid *ids, qsizetype n) {
+    // ["…","…"]: 38 байт на id + запятые и скобки — пишем одним блоком
+    constexpr qsizetype kItem = kUuidTextLength + 2;
+    const qsizetype start = out.size();
+    out.resize(start + 2 + n * kItem + (n > 0 ? n - 1 : 0));
+
+    char *d = out.data() + start;
+    *d++ = '[';
+    for (qsizetype i = 0; i < n; ++i) {
+        if (i > 0) {
+            *d++ = ',';
+        }
+        *d++ = '"';
+        formatUuid(ids[i], d);
+        d += kUuidTextLength;
+        *d++ = '"';
+    }
+    *d = ']';
+}
+
+void writeTagJson(QByteArray &out, const Tag &tag) {
+    out.append("{\"id\":");
+    writeJsonUuid(out, tag.id);
+    out.append(",\"name\":");
+    writeJsonString(out, tag.name);
+    out.append('}');
+}
+
+void writeTaskJson(QByteArray &out, const Task &task, bool includeExpanded) {
+    out.append("{\"id\":");
+    writeJsonUuid(out, task.id);
+    out.append(",\"title\":");
+    writeJsonString(out, task.title);
+    out.append(",\"description\":");
+    writeJsonString(out, task.description);
+    out.append(",\"isCompleted\":");
+    writeJsonBool(out, task.isCompleted);
+
+    out.append(",\"tags\":");
+    writeJsonUuidArray(out, task.tags);
+
+    if (includeExpanded && task.tagsExpanded && !task.tagsExpanded->isEmpty()) {
+        out.append(",\"tagsExpanded\":[");
+        bool first = true;
+        for (const Tag &tag : *task.tagsExpanded) {
+            if (!first) {
+                out.append(',');
+            }
+            first = false;
+            writeTagJson(out, tag);
+        }
+        out.append(']');
+    }
+
+    out.append('}');
+}
+
+void writeTaskJson(QByteArray &out, const Task &task, TaskFields fields) {
+    if (fields.isAll()) {
+        writeTaskJson(out, task);
+        return;
+    }
+
+    char separator = '{';
+    const auto key = [&out, &separator](const char *name) {
+        out.append(separator);
+        out.append(name);
+        separator = ',';
+    };
+
+    if (fields.has(TaskFields::Id)) {
+        key("\"id\":");
+        writeJsonUuid(out, task.id);
+    }
+    if (fields.has(TaskFields::Title)) {
+        key("\"title\":");
+        writeJsonString(out, task.title);
+    }
+    if (fields.has(TaskFields::Description)) {
+        key("\"description\":");
+        writeJsonString(out, task.description);
+    }
+    if (fields.has(TaskFields::IsCompleted)) {
+        key("\"isCompleted\":");
+        writeJsonBool(out, task.isCompleted);
+    }
+    if (fields.has(TaskFields::Tags)) {
+        key("\"tags\":");
+        writeJsonUuidArray(out, task.tags);
+    }
+
+    if (separator == '{') {
+        out.append('{');
+    }
+    out.append('}');
+}
+
+void writeTaskJson(QByteArray &out, const TaskBatch &batch, qsizetype row) {
+    const TaskFields fields = batch.fields;
+
+    char separator = '{';
+    const auto key = [&out, &separator](const char *name) {
+        out.append(separator);
+        out.append(name);
+        separator = ',';
+    };
+
+    if (fields.has(TaskFields::Id)) {
+        key("\"id\":");
+        writeJsonUuid(out, batch.id(row));
+    }
+    if (fields.has(TaskFields::Title)) {
+        key("\"title\":");
+        writeJsonString(out, batch.title(row));
+    }
+    if (fields.has(TaskFields::Description)) {
+        key("\"description\":");
+        writeJsonString(out, batch.description(row));
+    }
+    if (fields.has(TaskFields::IsCompleted)) {
+        key("\"isCompleted\":");
+        writeJsonBool(out, batch.isCompleted(row));
+    }
+    if (fields.has(TaskFields::Tags)) {
+        key("\"tags\":");
+        writeJsonUuidArray(out, batch.tagsBegin(row), batch.tagCount(row));
+    }
+
+    if (separator == '{') {
+        out.append('{');
+    }
+    out.append('}');
+}
+
+void writeJsonTimestamp(QByteArray &out) {
+    thread_local TimestampCache cache;
+
+    const qint64 nowMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    const qint64 second = nowMs / 1000;
+
+    if (second != cache.second) {
+        const QByteArray formatted =
+            QDateTime::fromSecsSinceEpoch(second, QTimeZone::UTC)
+                .toString(QStringLiteral("yyyy-MM-dd'T'HH:mm:ss"))
+                .toLatin1();
+        std::copy_n(formatted.constData(),
+                    std::min<qsizetype>(formatted.size(), sizeof(cache.prefix)),
+                    cache.prefix);
+        cache.second = second;
+    }
+
+    const int ms = static_cast<int>(nowMs % 1000);
+    char buf[sizeof(cache.prefix) + 7];
+    std::copy_n(cache.prefix, sizeof(cache.prefix), buf);
+    char *d = buf + sizeof(cache.prefix);
+    *d++ = '.';
+    *d++ = static_cast<char>('0' + ms / 100);
+    *d++ = static_cast<char>('0' + (ms / 10) % 10);
+    *d++ = static_cast<char>('0' + ms % 10);
+    *d++ = 'Z';
+
+    out.append('"');
+    out.append(buf, d - buf);
+    out.append('"');
+}
+
+void writeApiOkOpen(QByteArray &out, QStringView message,
+                    QStringView requestId) {
+    out.append("{\"ok\":true,\"message\":");
+    writeJsonString(out, message);
+    out.append(",\"requestId\":");
+    writeJsonString(out, requestId);
+    out.append(",\"ts\":");
+    writeJsonTimestamp(out);
+}
@@ -0,0 +1,47 @@
+#ifndef JSONWRITER_HPP
+#define JSONWRITER_HPP
+
+#include <QByteArray>
+#include <QStringView>
+
+#include "Tag.hpp"
+#include "Task.hpp"
+#include "TaskBatch.hpp"
+#include "TaskFields.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Прямая сериализация в QByteArray без промежуточных QJsonObject/QJsonArray.
+// Все функции дописывают в конец out; буфер можно переиспользовать между
+// ответами (resize(0) сохраняет ёмкость). Формат совпадает с Task::toJson,
+// Tag::toJson и конвертом makeApiOk (порядок ключей не гарантируется).
+// ─────────────────────────────────────────────────────────────────────────────
+
+// JSON-строка в кавычках: UTF-16 → UTF-8 с экранированием ", \ и управляющих
+void writeJsonString(QByteArray &out, QStringView value);
+
+void writeJsonInt(QByteArray &out, qint64 value);
+void writeJsonBool(QByteArray &out, bool value);
+
+// "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" (без фигурных скобок)
+void writeJsonUuid(QByteArray &out, const QUuid &id);
+void writeJsonUuidArray(QByteArray &out, const QUuid *ids, qsizetype count);
+void writeJsonUuidArray(QByteArray &out, const QVector<QUuid> &ids);
+
+void writeTagJson(QByteArray &out, const Tag &tag);
+void writeTaskJson(QByteArray &out, const Task &task,
+                   bool includeExpanded = false);
+// Только выбранные поля (?fields=), в том же порядке ключей
+void writeTaskJson(QByteArray &out, const Task &task, TaskFields fields);
+// Строка row из TaskBatch, поля — batch.fields
+void writeTaskJson(QByteArray &out, const TaskBatch &batch, qsizetype row);
+
+// Открытие конверта: {"ok":true,"message":..,"requestId":..,"ts":..
+// Дальше вызывающий дописывает `,"data":{...}` (если есть) и `}`.
+void writeApiOkOpen(QByteArray &out, QStringView message,
+                    QStringView requestId);
+
+// Текущее время UTC в формате Qt::ISODateWithMs ("…T12:34:56.789Z").
+// Часть до секунд кэшируется на поток и пересчитывается раз в секунду.
+void writeJsonTimestamp(QByteArray &out);
+
+#endif // JSONWRITER_HPP
@@ -0,0 +1,134 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Лог-линейная гистограмма задержек в наносекундах (по типу HdrHistogram):
+// каждая степень двойки делится на 16 равных под-корзин → относительная
+// погрешность ≤ 6.25%. Диапазон до 2^40 нс (~18 мин), больше — в последнюю.
+// Корзины закрыты сверху, (lo, hi]: значение, равное границе, попадает в
+// нижнюю корзину, как le в Prometheus. record() — relaxed-операции, без блокировок.
+// ─────────────────────────────────────────────────────────────────────────────
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr int kBucketCount =
+        (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    // Неатомарный срез для агрегации и расчёта перцентилей
+    struct Snapshot {
+        std::array<quint64, kBucketCount> counts{};
+        quint64 count = 0;
+        quint64 sumNs = 0;
+        quint64 maxNs = 0;
+
+        void merge(const Snapshot &other) {
+            for (int i = 0; i < kBucketCount; ++i) {
+                counts[i] += other.counts[i];
+            }
+            count += other.count;
+            sumNs += other.sumNs;
+            maxNs = std::max(maxNs, other.maxNs);
+        }
+
+        // Оценка значения на квантиле q ∈ [0, 1] (верхняя граница корзины)
+        quint64 valueAt(double q) const {
+            if (count == 0) {
+                return 0;
+            }
+            const auto rank = static_cast<quint64>(q * double(count - 1)) + 1;
+            quint64 seen = 0;
+            for (int i = 0; i < kBucketCount; ++i) {
+                seen += counts[i];
+                if (seen >= rank) {
+                    return std::min(bucketUpperBound(i), maxNs);
+                }
+            }
+            return maxNs;
+        }
+
+        // Число значений ≤ boundNs; точно, если boundNs — степень двойки
+        quint64 countAtMost(quint64 boundNs) const {
+            quint64 total = 0;
+            for (int i = 0; i < kBucketCount; ++i) {
+                if (bucketUpperBound(i) > boundNs) {
+                    break;
+                }
+                total += counts[i];
+            }
+            return total;
+        }
+    };
+
+    // Корзина значения ns: корзина ns - 1 в полуоткрытой [lo, hi) разбивке,
+    // т.е. ns ∈ (lo, hi]; 0 — в первую
+    static int bucketIndex(quint64 ns) {
+        if (ns > 0) {
+            --ns;
+        }
+        if (ns < quint64(kSubBuckets)) {
+            return int(ns);
+        }
+        const int exponent = std::bit_width(ns) - 1;
+        if (exponent > kMaxExponent) {
+            return kBucketCount - 1;
+        }
+        const int shift = exponent - kSubBucketBits;
+        const int group = shift + 1;
+        return group * kSubBuckets + int(ns >> shift) - kSubBuckets;
+    }
+
+    // Включающая верхняя граница корзины, нс
+    static quint64 bucketUpperBound(int index) {
+        const int group = index / kSubBuckets;
+        const quint64 sub = quint64(index % kSubBuckets);
+        if (group == 0) {
+            return sub + 1;
+        }
+        const int shift = group - 1;
+        return ((sub + kSubBuckets) << shift) + (quint64(1) << shift);
+    }
+
+    void record(quint64 ns) {
+        m_counts[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sumNs.fetch_add(ns, std::memory_order_relaxed);
+
+        quint64 prevMax = m_maxNs.load(std::memory_order_relaxed);
+        while (ns > prevMax &&
+               !m_maxNs.compare_exchange_weak(prevMax, ns,
+                                              std::memory_order_relaxed)) {
+        }
+    }
+
+    void addTo(Snapshot &snapshot) const {
+        for (int i = 0; i < kBucketCount; ++i) {
+            snapshot.counts[i] += m_counts[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count += m_count.load(std::memory_order_relaxed);
+        snapshot.sumNs += m_sumNs.load(std::memory_order_relaxed);
+        snapshot.maxNs =
+            std::max(snapshot.maxNs, m_maxNs.load(std::memory_order_relaxed));
+    }
+
+    Snapshot snapshot() const {
+        Snapshot out;
+        addTo(out);
+        return out;
+    }
+
+private:
+    std::array<std::atomic<quint64>, kBucketCount> m_counts{};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sumNs{0};
+    std::atomic<quint64> m_maxNs{0};
+};
+
+#endif // LATENCYHISTOGRAM_HPP
@@ -1,52 +1,281 @@
-#include <QtCore/QFile>
-#include <QtCore/QTextStream>
+#include <QtCore/QByteArray>
 #include <QtCore/QDateTime>
-#include <QtCore/QMutex>
-#include <QtCore/QMutexLocker>
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
 #include <QtHttpServer/QHttpServerRequest>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
 #include "Logger.hpp"
 
 Q_LOGGING_CATEGORY(appCore, "tasklit.core")
 Q_LOGGING_CATEGORY(appHttp, "tasklit.http")
 Q_LOGGING_CATEGORY(appSql,  "tasklit.sql")
 
-static QFile* g_logFile = nullptr;
-QMutex g_logMutex;
+// ─────────────────────────────────────────────────────────────────────────────
+// Асинхронный бэкенд: обработчик на потоке запроса только форматирует строку
+// и кладёт её в ограниченное lock-free кольцо; фоновый поток забирает записи
+// пачками и пишет в stderr и файл. При переполнении запись отбрасывается
+// и учитывается в счётчике drops. Синхронная запись (fatal, до старта и после
+// остановки) сначала дописывает кольцо — порядок строк не нарушается.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
 
-static void messageHandler(QtMsgType type, const QMessageLogContext& ctx, const QString& msg)
-{
-    QString line = qFormatLogMessage(type, ctx, msg) + '\n';
+constexpr std::size_t kRingCapacity = 8192; // степень двойки
+constexpr std::size_t kRingMask = kRingCapacity - 1;
+constexpr qsizetype kBatchBytes = 64 * 1024;
 
-    fprintf(stderr, "%s", line.toLocal8Bit().constData());
+// Ограниченная MPMC-очередь (D. Vyukov): у каждого слота свой номер
+// последовательности, производители и потребитель синхронизируются только им.
+class LogRing {
+public:
+    LogRing() {
+        for (std::size_t i = 0; i < kRingCapacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(QByteArray &&line) {
+        Slot *slot = nullptr;
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &m_slots[pos & kRingMask];
+            const std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) -
+                              static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // кольцо заполнено
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
 
-    if (g_logFile && g_logFile->isOpen()) {
-        QMutexLocker lock(&g_logMutex);
-        QTextStream ts(g_logFile);
-        ts << line;
-        ts.flush();
+        slot->line = std::move(line);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(QByteArray &out) {
+        Slot *slot = nullptr;
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &m_slots[pos & kRingMask];
+            const std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) -
+                              static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // пусто
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        out = std::move(slot->line);
+        slot->line = QByteArray();
+        slot->sequence.store(pos + kRingCapacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        QByteArray line;
+    };
+
+    alignas(64) std::array<Slot, kRingCapacity> m_slots;
+    alignas(64) std::atomic<std::size_t> m_enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> m_dequeuePos{0};
+};
+
+struct AsyncLog {
+    LogRing ring;
+    // Вся запись в stderr/file и закрытие file — под writeMutex
+    std::mutex writeMutex;
+    std::FILE *file = nullptr;
+    std::thread writer;
+    std::atomic<std::uint32_t> signal{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<quint64> dropped{0};
+    // Производители, увидевшие g_running == true и ещё не положившие запись
+    std::atomic<int> producers{0};
+};
+
+AsyncLog *g_log = nullptr;
+std::atomic<bool> g_running{false};
+
+void writeBatch(std::FILE *file, const QByteArray &batch) {
+    std::fwrite(batch.constData(), 1, static_cast<std::size_t>(batch.size()), stderr);
+    std::fflush(stderr);
+    if (file) {
+        std::fwrite(batch.constData(), 1, static_cast<std::size_t>(batch.size()), file);
+        std::fflush(file);
+    }
+}
+
+// Под writeMutex: всё, что есть в кольце, — в stderr/file
+void drainLocked(AsyncLog *log, QByteArray &batch) {
+    QByteArray line;
+    while (log->ring.tryPop(line)) {
+        batch.append(line);
+        if (batch.size() >= kBatchBytes) {
+            writeBatch(log->file, batch);
+            batch.resize(0);
+        }
+    }
+    if (!batch.isEmpty()) {
+        writeBatch(log->file, batch);
+        batch.resize(0);
     }
 }
 
+void writerLoop(AsyncLog *log) {
+    QByteArray batch;
+    batch.reserve(kBatchBytes + 1024);
+    quint64 reportedDrops = 0;
+
+    for (;;) {
+        const std::uint32_t seen = log->signal.load(std::memory_order_acquire);
+        const bool stopping = log->stopping.load(std::memory_order_acquire);
+
+        std::unique_lock lock(log->writeMutex);
+        drainLocked(log, batch);
+
+        const quint64 drops = log->dropped.load(std::memory_order_relaxed);
+        if (drops != reportedDrops) {
+            batch.append(QDateTime::currentDateTime()
+                             .toString("yyyy-MM-dd hh:mm:ss.zzz")
+                             .toUtf8());
+            batch.append(" [warning] tasklit.core: log backpressure, dropped ");
+            batch.append(QByteArray::number(drops - reportedDrops));
+            batch.append(" records\n");
+            reportedDrops = drops;
+        }
+
+        if (!batch.isEmpty()) {
+            writeBatch(log->file, batch);
+            batch.resize(0);
+        }
+        lock.unlock();
+
+        // остаток после этого прохода дописывает shutdownLogging
+        if (stopping) {
+            return;
+        }
+
+        log->signal.wait(seen, std::memory_order_acquire);
+    }
+}
+
+// Синхронная запись после уже стоящих в кольце строк
+void writeSync(const QByteArray &line) {
+    if (!g_log) {
+        writeBatch(nullptr, line);
+        return;
+    }
+
+    std::lock_guard lock(g_log->writeMutex);
+    QByteArray batch;
+    drainLocked(g_log, batch);
+    writeBatch(g_log->file, line);
+}
+
+void messageHandler(QtMsgType type, const QMessageLogContext &ctx, const QString &msg)
+{
+    QByteArray line = (qFormatLogMessage(type, ctx, msg) + '\n').toUtf8();
+
+    // Fatal, а также до initLogging / после shutdownLogging — синхронно.
+    // producers поднимается до проверки g_running: shutdownLogging ждёт,
+    // пока запись, начатая до остановки, окажется в кольце
+    if (type != QtFatalMsg && g_log) {
+        g_log->producers.fetch_add(1);
+        if (g_running.load()) {
+            if (!g_log->ring.tryPush(std::move(line))) {
+                g_log->dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            g_log->signal.fetch_add(1, std::memory_order_release);
+            g_log->signal.notify_one();
+            g_log->producers.fetch_sub(1);
+            return;
+        }
+        g_log->producers.fetch_sub(1);
+    }
+
+    writeSync(line);
+}
+
+} // namespace
+
 void initLogging(const QString& filePath) {
     qSetMessagePattern("%{time yyyy-MM-dd hh:mm:ss.zzz} [%{type}] %{category} "
                        "(%{if-debug}%{function}:%{line}%{endif}): %{message}");
 
-    if (!filePath.isEmpty()) {
+    if (g_running.load()) {
+        return;
+    }
 
-        g_logFile = new QFile(filePath);
-        if (!g_logFile->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-            delete g_logFile;
-            g_logFile = nullptr;
-            qWarning(appCore) << "Failed to open log file:" << filePath;
-        }
+    g_log = new AsyncLog;
+
+    bool fileFailed = false;
+    if (!filePath.isEmpty()) {
+        g_log->file = std::fopen(QFile::encodeName(filePath).constData(), "ab");
+        fileFailed = g_log->file == nullptr;
     }
 
     qInstallMessageHandler(messageHandler);
 
+    g_log->writer = std::thread(writerLoop, g_log);
+    g_running.store(true, std::memory_order_release);
+
+    if (fileFailed) {
+        qWarning(appCore) << "Failed to open log file:" << filePath;
+    }
+
     qInfo(appCore) << "Logging initialized"
-                   << (g_logFile ? QString("-> %1").arg(filePath) : "(stderr only)");
+                   << (g_log->file ? QString("-> %1").arg(filePath) : "(stderr only)");
+}
+
+void shutdownLogging() {
+    if (!g_running.exchange(false)) {
+        return;
+    }
+
+    // Новые сообщения уже идут синхронно; ждём тех, кто успел выбрать кольцо
+    while (g_log->producers.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    g_log->stopping.store(true, std::memory_order_release);
+    g_log->signal.fetch_add(1, std::memory_order_release);
+    g_log->signal.notify_one();
+    g_log->writer.join();
+
+    std::lock_guard lock(g_log->writeMutex);
+    QByteArray batch;
+    drainLocked(g_log, batch);
+    if (g_log->file) {
+        std::fclose(g_log->file);
+        g_log->file = nullptr;
+    }
+    // g_log не освобождаем: поздние сообщения идут синхронно в stderr через него
+}
+
+quint64 droppedLogRecords() {
+    return g_log ? g_log->dropped.load(std::memory_order_relaxed) : 0;
 }
 
 const char* toString(QHttpServerRequest::Method m) {
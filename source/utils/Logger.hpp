@@ -11,6 +11,12 @@ Q_DECLARE_LOGGING_CATEGORY(appSql)
 
 void initLogging(const QString& filePath = QString());
 
+// Дописывает очередь логов и останавливает фоновый поток записи
+void shutdownLogging();
+
+// Сколько записей отброшено из-за переполнения очереди
+quint64 droppedLogRecords();
+
 const char* toString(QHttpServerRequest::Method m);
 
 #endif // LOGGER_HPP
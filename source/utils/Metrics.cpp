@@ -0,0 +1,266 @@
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Admission.hpp"
+#include "LatencyHistogram.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+namespace metrics {
+namespace {
+
+// Границы le для экспорта: степени двойки от ~1 мкс до ~34 с — совпадают
+// с границами групп гистограммы, поэтому countAtMost() по ним точен
+constexpr int kFirstLeExponent = 10;
+constexpr int kLastLeExponent = 35;
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+struct HttpKey {
+    const char *route;
+    int status;
+
+    bool operator==(const HttpKey &other) const {
+        return route == other.route && status == other.status;
+    }
+};
+
+struct HttpKeyHash {
+    std::size_t operator()(const HttpKey &key) const {
+        return std::hash<const void *>()(key.route) ^
+               (static_cast<std::size_t>(key.status) * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+struct SqlStats {
+    LatencyHistogram latency;
+    std::atomic<quint64> errors{0};
+};
+
+struct CacheStats {
+    std::atomic<quint64> hits{0};
+    std::atomic<quint64> misses{0};
+};
+
+// Шард пишет только свой поток. Вставка нового ключа и экспорт берут mutex;
+// поиск на горячем пути идёт без блокировки (вставки делает тот же поток).
+struct Shard {
+    std::mutex mutex;
+    std::unordered_map<HttpKey, std::unique_ptr<LatencyHistogram>, HttpKeyHash> http;
+    std::unordered_map<const char *, std::unique_ptr<SqlStats>> sql;
+    std::unordered_map<const char *, std::unique_ptr<CacheStats>> caches;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Shard>> shards;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+Shard &localShard() {
+    thread_local const std::shared_ptr<Shard> shard = [] {
+        auto created = std::make_shared<Shard>();
+        std::lock_guard lock(registry().mutex);
+        registry().shards.push_back(created);
+        return created;
+    }();
+    return *shard;
+}
+
+template <typename Map, typename Key>
+typename Map::mapped_type::element_type &findOrInsert(Shard &shard, Map &map,
+                                                      const Key &key) {
+    const auto it = map.find(key);
+    if (it != map.end()) {
+        return *it->second;
+    }
+
+    std::lock_guard lock(shard.mutex);
+    auto &slot = map[key];
+    slot = std::make_unique<typename Map::mapped_type::element_type>();
+    return *slot;
+}
+
+void appendLabelValue(QByteArray &out, const std::string &value) {
+    out.append('"');
+    for (const char c : value) {
+        if (c == '\\' || c == '"') {
+            out.append('\\');
+            out.append(c);
+        } else if (c == '\n') {
+            out.append("\\n");
+        } else {
+            out.append(c);
+        }
+    }
+    out.append('"');
+}
+
+QByteArray seconds(quint64 ns) {
+    return QByteArray::number(double(ns) / 1e9, 'g', 9);
+}
+
+void appendHistogram(QByteArray &out, const char *name, const QByteArray &labels,
+                     const LatencyHistogram::Snapshot &snapshot) {
+    const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+
+    for (int e = kFirstLeExponent; e <= kLastLeExponent; ++e) {
+        const quint64 bound = quint64(1) << e;
+        out.append(name).append("_bucket{").append(prefix).append("le=\"");
+        out.append(seconds(bound)).append("\"} ");
+        out.append(QByteArray::number(snapshot.countAtMost(bound))).append('\n');
+    }
+    out.append(name).append("_bucket{").append(prefix).append("le=\"+Inf\"} ");
+    out.append(QByteArray::number(snapshot.count)).append('\n');
+
+    out.append(name).append("_sum{").append(labels).append("} ");
+    out.append(seconds(snapshot.sumNs)).append('\n');
+    out.append(name).append("_count{").append(labels).append("} ");
+    out.append(QByteArray::number(snapshot.count)).append('\n');
+}
+
+void appendQuantiles(QByteArray &out, const char *name, const QByteArray &labels,
+                     const LatencyHistogram::Snapshot &snapshot) {
+    for (const double q : kQuantiles) {
+        out.append(name).append('{').append(labels).append(",quantile=\"");
+        out.append(QByteArray::number(q)).append("\"} ");
+        out.append(seconds(snapshot.valueAt(q))).append('\n');
+    }
+}
+
+} // namespace
+
+void observeHttpRequest(const char *route, int status, quint64 ns) {
+    Shard &shard = localShard();
+    findOrInsert(shard, shard.http, HttpKey{route, status}).record(ns);
+}
+
+void observeSqlQuery(const char *query, quint64 ns, bool ok) {
+    Shard &shard = localShard();
+    SqlStats &stats = findOrInsert(shard, shard.sql, query);
+    stats.latency.record(ns);
+    if (!ok) {
+        stats.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void cacheHit(const char *cache) {
+    Shard &shard = localShard();
+    findOrInsert(shard, shard.caches, cache)
+        .hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+void cacheMiss(const char *cache) {
+    Shard &shard = localShard();
+    findOrInsert(shard, shard.caches, cache)
+        .misses.fetch_add(1, std::memory_order_relaxed);
+}
+
+QByteArray renderPrometheus() {
+    std::map<std::pair<std::string, int>, LatencyHistogram::Snapshot> http;
+    std::map<std::string, std::pair<LatencyHistogram::Snapshot, quint64>> sql;
+    std::map<std::string, std::pair<quint64, quint64>> caches;
+
+    std::vector<std::shared_ptr<Shard>> shards;
+    {
+        std::lock_guard lock(registry().mutex);
+        shards = registry().shards;
+    }
+
+    // Сливаем шарды по именам: один литерал может иметь разные адреса в разных TU
+    for (const auto &shard : shards) {
+        std::lock_guard lock(shard->mutex);
+        for (const auto &[key, histogram] : shard->http) {
+            histogram->addTo(http[{key.route, key.status}]);
+        }
+        for (const auto &[name, stats] : shard->sql) {
+            auto &entry = sql[name];
+            stats->latency.addTo(entry.first);
+            entry.second += stats->errors.load(std::memory_order_relaxed);
+        }
+        for (const auto &[name, stats] : shard->caches) {
+            auto &entry = caches[name];
+            entry.first += stats->hits.load(std::memory_order_relaxed);
+            entry.second += stats->misses.load(std::memory_order_relaxed);
+        }
+    }
+
+    QByteArray out;
+    out.reserve(64 * 1024);
+
+    out.append("# HELP tasklit_http_request_duration_seconds HTTP request latency by route and status.\n"
+               "# TYPE tasklit_http_request_duration_seconds histogram\n");
+    for (const auto &[key, snapshot] : http) {
+        QByteArray labels("route=");
+        appendLabelValue(labels, key.first);
+        labels.append(",status=\"").append(QByteArray::number(key.second)).append('"');
+        appendHistogram(out, "tasklit_http_request_duration_seconds", labels, snapshot);
+    }
+
+    out.append("# HELP tasklit_http_request_duration_quantile_seconds HTTP request latency quantiles since start.\n"
+               "# TYPE tasklit_http_request_duration_quantile_seconds gauge\n");
+    for (const auto &[key, snapshot] : http) {
+        QByteArray labels("route=");
+        appendLabelValue(labels, key.first);
+        labels.append(",status=\"").append(QByteArray::number(key.second)).append('"');
+        appendQuantiles(out, "tasklit_http_request_duration_quantile_seconds", labels, snapshot);
+    }
+
+    out.append("# HELP tasklit_sql_query_duration_seconds SQLite statement latency by query.\n"
+               "# TYPE tasklit_sql_query_duration_seconds histogram\n");
+    for (const auto &[name, entry] : sql) {
+        QByteArray labels("query=");
+        appendLabelValue(labels, name);
+        appendHistogram(out, "tasklit_sql_query_duration_seconds", labels, entry.first);
+    }
+
+    out.append("# HELP tasklit_sql_query_errors_total Failed SQLite statements by query.\n"
+               "# TYPE tasklit_sql_query_errors_total counter\n");
+    for (const auto &[name, entry] : sql) {
+        out.append("tasklit_sql_query_errors_total{query=");
+        appendLabelValue(out, name);
+        out.append("} ").append(QByteArray::number(entry.second)).append('\n');
+    }
+
+    out.append("# HELP tasklit_cache_requests_total Cache lookups by cache and result.\n"
+               "# TYPE tasklit_cache_requests_total counter\n");
+    for (const auto &[name, entry] : caches) {
+        for (const auto &[result, value] :
+             {std::pair{"hit", entry.first}, std::pair{"miss", entry.second}}) {
+            out.append("tasklit_cache_requests_total{cache=");
+            appendLabelValue(out, name);
+            out.append(",result=\"").append(result).append("\"} ");
+            out.append(QByteArray::number(value)).append('\n');
+        }
+    }
+
+    out.append("# HELP tasklit_cache_hit_ratio Cache hit ratio since start.\n"
+               "# TYPE tasklit_cache_hit_ratio gauge\n");
+    for (const auto &[name, entry] : caches) {
+        const quint64 total = entry.first + entry.second;
+        out.append("tasklit_cache_hit_ratio{cache=");
+        appendLabelValue(out, name);
+        out.append("} ");
+        out.append(QByteArray::number(total ? double(entry.first) / double(total) : 0.0));
+        out.append('\n');
+    }
+
+    out.append("# HELP tasklit_log_dropped_records_total Log records dropped under backpressure.\n"
+               "# TYPE tasklit_log_dropped_records_total counter\n"
+               "tasklit_log_dropped_records_total ");
+    out.append(QByteArray::number(droppedLogRecords())).append('\n');
+
+    admission::appendPrometheus(out);
+
+    return out;
+}
+
+} // namespace metrics
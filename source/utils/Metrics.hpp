@@ -0,0 +1,34 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <QByteArray>
+#include <chrono>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Метрики процесса в формате Prometheus (GET /metrics).
+// Каждый поток пишет в свой шард (relaxed-атомики, без блокировок на горячем
+// пути); экспорт сливает шарды по именам. Имена маршрутов/запросов/кэшей —
+// строковые литералы со статическим временем жизни.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace metrics {
+
+using Clock = std::chrono::steady_clock;
+
+inline quint64 elapsedNs(Clock::time_point started) {
+    return static_cast<quint64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started)
+            .count());
+}
+
+void observeHttpRequest(const char *route, int status, quint64 ns);
+void observeSqlQuery(const char *query, quint64 ns, bool ok);
+
+void cacheHit(const char *cache);
+void cacheMiss(const char *cache);
+
+// Текстовый формат Prometheus 0.0.4
+QByteArray renderPrometheus();
+
+} // namespace metrics
+
+#endif // METRICS_HPP
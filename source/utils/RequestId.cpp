@@ -0,0 +1,46 @@
+#include <QRandomGenerator>
+
+#include <atomic>
+
+#include "RequestId.hpp"
+
+namespace {
+
+constexpr qsizetype kBootDigits = 8;
+constexpr qsizetype kThreadDigits = 4;
+constexpr qsizetype kCounterDigits = 12;
+constexpr qsizetype kRequestIdLength =
+    kBootDigits + 1 + kThreadDigits + 1 + kCounterDigits;
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+std::atomic<quint32> g_nextThread{1};
+
+void writeHex(char *out, quint64 value, qsizetype digits) {
+    for (qsizetype i = digits - 1; i >= 0; --i) {
+        out[i] = kHexDigits[value & 0xF];
+        value >>= 4;
+    }
+}
+
+struct RequestIdState {
+    char text[kRequestIdLength];
+    quint64 counter = 0;
+
+    RequestIdState() {
+        static const quint32 boot = QRandomGenerator::system()->generate();
+        writeHex(text, boot, kBootDigits);
+        text[kBootDigits] = '-';
+        writeHex(text + kBootDigits + 1, g_nextThread.fetch_add(1), kThreadDigits);
+        text[kBootDigits + 1 + kThreadDigits] = '-';
+    }
+};
+
+} // namespace
+
+QString nextRequestId() {
+    thread_local RequestIdState state;
+    writeHex(state.text + kRequestIdLength - kCounterDigits, ++state.counter,
+             kCounterDigits);
+    return QString::fromLatin1(state.text, kRequestIdLength);
+}
@@ -0,0 +1,10 @@
+#ifndef REQUESTID_HPP
+#define REQUESTID_HPP
+
+#include <QString>
+
+// requestId вида "<boot>-<thread>-<counter>" (8-4-12 hex): префикс процесса
+// случаен, номер потока и счётчик монотонны. Без ГСЧ и блокировок на запрос.
+QString nextRequestId();
+
+#endif // REQUESTID_HPP
@@ -0,0 +1,585 @@
+#include <QUuid>
+#include <cstring>
+
+#include "TaskBodyDecoder.hpp"
+#include "Tracing.hpp"
+#include "UuidCodec.hpp"
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+
+enum class Mode { Create, Patch };
+
+class Decoder {
+public:
+    explicit Decoder(QByteArrayView body)
+        : m_begin(body.data()), m_pos(body.data()),
+          m_end(body.data() + body.size()) {}
+
+    bool decode(Mode mode, Task &task, TaskPatch &patch);
+
+    BodyDecodeError error() const { return m_error; }
+
+private:
+    // ── лексер ──────────────────────────────────────────────────────────────
+    void skipWs() {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' ||
+                                 *m_pos == '\n' || *m_pos == '\r')) {
+            ++m_pos;
+        }
+    }
+
+    bool atEnd() const { return m_pos >= m_end; }
+    char peek() const { return m_pos < m_end ? *m_pos : '\0'; }
+
+    bool consume(char c) {
+        skipWs();
+        if (peek() != c) {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    bool expect(char c, const char *what) {
+        if (consume(c)) {
+            return true;
+        }
+        return fail(atEnd() ? QStringLiteral("unexpected end of input, expected %1")
+                                  .arg(QLatin1StringView(what))
+                            : QStringLiteral("expected %1")
+                                  .arg(QLatin1StringView(what)));
+    }
+
+    bool matchLiteral(const char *literal) {
+        const char *p = m_pos;
+        for (; *literal; ++literal, ++p) {
+            if (p >= m_end || *p != *literal) {
+                return fail(QStringLiteral("invalid literal"));
+            }
+        }
+        m_pos = p;
+        return true;
+    }
+
+    bool fail(const QString &message, const char *at = nullptr) {
+        m_error.kind = BodyDecodeError::Kind::Syntax;
+        m_error.message = message;
+        setLocation(at ? at : m_pos);
+        return false;
+    }
+
+    bool invalid(const QString &field, const QString &message,
+                 const char *at) {
+        m_error.kind = BodyDecodeError::Kind::Validation;
+        m_error.field = field;
+        m_error.message = message;
+        setLocation(at);
+        return false;
+    }
+
+    void setLocation(const char *at) {
+        m_error.offset = at - m_begin;
+        m_error.line = 1;
+        m_error.column = 1;
+        for (const char *p = m_begin; p < at && p < m_end; ++p) {
+            if (*p == '\n') {
+                ++m_error.line;
+                m_error.column = 1;
+            } else if ((static_cast<unsigned char>(*p) & 0xC0) != 0x80) {
+                ++m_error.column;
+            }
+        }
+    }
+
+    bool parseHex4(char16_t &out);
+    bool parseString(QString &out);
+    bool skipString();
+    bool skipNumber();
+    bool skipValue(int depth);
+
+    // ── схема ───────────────────────────────────────────────────────────────
+    bool parseUuidValue(const QString &field, QUuid &out);
+    bool parseTagList(QVector<QUuid> &out);
+    bool parseTagElement(qsizetype index, QUuid &out);
+
+    const char *m_begin;
+    const char *m_pos;
+    const char *m_end;
+    BodyDecodeError m_error;
+};
+
+bool Decoder::parseHex4(char16_t &out) {
+    if (m_end - m_pos < 4) {
+        return fail(QStringLiteral("truncated \\u escape"));
+    }
+    char16_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = m_pos[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+        } else {
+            return fail(QStringLiteral("invalid \\u escape"), m_pos + i);
+        }
+    }
+    m_pos += 4;
+    out = value;
+    return true;
+}
+
+bool Decoder::parseString(QString &out) {
+    skipWs();
+    if (peek() != '"') {
+        return fail(QStringLiteral("expected string"));
+    }
+    ++m_pos;
+
+    // быстрый путь: строка без escape-последовательностей
+    const char *start = m_pos;
+    while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\') {
+        if (static_cast<unsigned char>(*m_pos) < 0x20) {
+            return fail(QStringLiteral("control character in string"));
+        }
+        ++m_pos;
+    }
+    if (atEnd()) {
+        return fail(QStringLiteral("unterminated string"), start - 1);
+    }
+    if (*m_pos == '"') {
+        out = QString::fromUtf8(start, m_pos - start);
+        ++m_pos;
+        return true;
+    }
+
+    // медленный путь: собираем UTF-16 по кускам
+    out = QString::fromUtf8(start, m_pos - start);
+    while (m_pos < m_end) {
+        const char c = *m_pos;
+        if (c == '"') {
+            ++m_pos;
+            return true;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return fail(QStringLiteral("control character in string"));
+        }
+        if (c != '\\') {
+            const char *run = m_pos;
+            while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\' &&
+                   static_cast<unsigned char>(*m_pos) >= 0x20) {
+                ++m_pos;
+            }
+            out.append(QString::fromUtf8(run, m_pos - run));
+            continue;
+        }
+
+        ++m_pos;
+        if (atEnd()) {
+            break;
+        }
+        switch (*m_pos++) {
+        case '"': out.append(u'"'); break;
+        case '\\': out.append(u'\\'); break;
+        case '/': out.append(u'/'); break;
+        case 'b': out.append(u'\b'); break;
+        case 'f': out.append(u'\f'); break;
+        case 'n': out.append(u'\n'); break;
+        case 'r': out.append(u'\r'); break;
+        case 't': out.append(u'\t'); break;
+        case 'u': {
+            char16_t unit = 0;
+            if (!parseHex4(unit)) {
+                return false;
+            }
+            out.append(QChar(unit));
+            break;
+        }
+        default:
+            return fail(QStringLiteral("invalid escape sequence"), m_pos - 1);
+        }
+    }
+
+    return fail(QStringLiteral("unterminated string"), start - 1);
+}
+
+bool Decoder::skipString() {
+    skipWs();
+    if (peek() != '"') {
+        return fail(QStringLiteral("expected string"));
+    }
+    const char *start = m_pos++;
+    while (m_pos < m_end) {
+        const char c = *m_pos++;
+        if (c == '"') {
+            return true;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return fail(QStringLiteral("control character in string"),
+                        m_pos - 1);
+        }
+        if (c == '\\') {
+            if (atEnd()) {
+                break;
+            }
+            const char e = *m_pos++;
+            if (e == 'u') {
+                char16_t unused = 0;
+                if (!parseHex4(unused)) {
+                    return false;
+                }
+            } else if (e == '\0' || !std::strchr("\"\\/bfnrt", e)) {
+                return fail(QStringLiteral("invalid escape sequence"),
+                            m_pos - 1);
+            }
+        }
+    }
+    return fail(QStringLiteral("unterminated string"), start);
+}
+
+bool Decoder::skipNumber() {
+    const char *start = m_pos;
+    auto digits = [this]() {
+        const char *from = m_pos;
+        while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9') {
+            ++m_pos;
+        }
+        return m_pos > from;
+    };
+
+    if (peek() == '-') {
+        ++m_pos;
+    }
+    if (peek() == '0') {
+        ++m_pos;
+    } else if (!digits()) {
+        return fail(QStringLiteral("invalid number"), start);
+    }
+    if (peek() == '.') {
+        ++m_pos;
+        if (!digits()) {
+            return fail(QStringLiteral("invalid number"), start);
+        }
+    }
+    if (peek() == 'e' || peek() == 'E') {
+        ++m_pos;
+        if (peek() == '+' || peek() == '-') {
+            ++m_pos;
+        }
+        if (!digits()) {
+            return fail(QStringLiteral("invalid number"), start);
+        }
+    }
+    return true;
+}
+
+bool Decoder::skipValue(int depth) {
+    if (depth > kMaxDepth) {
+        return fail(QStringLiteral("nesting too deep"));
+    }
+
+    skipWs();
+    switch (peek()) {
+    case '"':
+        return skipString();
+    case 't':
+        return matchLiteral("true");
+    case 'f':
+        return matchLiteral("false");
+    case 'n':
+        return matchLiteral("null");
+    case '{': {
+        ++m_pos;
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            if (!skipString() || !expect(':', "':'") || !skipValue(depth + 1)) {
+                return false;
+            }
+        } while (consume(','));
+        return expect('}', "',' or '}'");
+    }
+    case '[': {
+        ++m_pos;
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (!skipValue(depth + 1)) {
+                return false;
+            }
+        } while (consume(','));
+        return expect(']', "',' or ']'");
+    }
+    default:
+        if (peek() == '-' || (peek() >= '0' && peek() <= '9')) {
+            return skipNumber();
+        }
+        return fail(atEnd() ? QStringLiteral("unexpected end of input")
+                            : QStringLiteral("unexpected character"));
+    }
+}
+
+bool Decoder::parseUuidValue(const QString &field, QUuid &out) {
+    skipWs();
+    const char *at = m_pos;
+    if (peek() != '"') {
+        return fail(QStringLiteral("expected string"));
+    }
+
+    // UUID без escape-последовательностей разбираем прямо из байтов тела
+    const char *start = m_pos + 1;
+    const char *close = start;
+    while (close < m_end && *close != '"' && *close != '\\') {
+        ++close;
+    }
+
+    bool parsed = false;
+    if (close < m_end && *close == '"') {
+        parsed = parseUuid(QByteArrayView(start, close - start), out);
+        m_pos = close + 1;
+    } else {
+        QString text;
+        if (!parseString(text)) {
+            return false;
+        }
+        parsed = parseUuid(QStringView(text), out);
+    }
+
+    if (!parsed || out.isNull()) {
+        return invalid(field, QStringLiteral("Invalid UUID"), at);
+    }
+    return true;
+}
+
+bool Decoder::parseTagElement(qsizetype index, QUuid &out) {
+    const QString field = QStringLiteral("tags[%1]").arg(index);
+
+    skipWs();
+    const char *at = m_pos;
+    if (peek() == '"') {
+        return parseUuidValue(field, out);
+    }
+
+    if (peek() != '{') {
+        if (!skipValue(1)) {
+            return false;
+        }
+        return invalid(field,
+                       QStringLiteral("Each tag must be a UUID string or an "
+                                      "object with 'id' (UUID)"),
+                       at);
+    }
+
+    ++m_pos;
+    bool hasId = false;
+    if (!consume('}')) {
+        do {
+            QString key;
+            if (!parseString(key) || !expect(':', "':'")) {
+                return false;
+            }
+            if (key == QLatin1StringView("id")) {
+                skipWs();
+                if (peek() != '"') {
+                    return invalid(field + QStringLiteral(".id"),
+                                   QStringLiteral("Tag 'id' must be a UUID string"),
+                                   m_pos);
+                }
+                if (!parseUuidValue(field + QStringLiteral(".id"), out)) {
+                    return false;
+                }
+                hasId = true;
+            } else if (!skipValue(2)) {
+                return false;
+            }
+        } while (consume(','));
+        if (!expect('}', "',' or '}'")) {
+            return false;
+        }
+    }
+
+    if (!hasId) {
+        return invalid(field, QStringLiteral("Tag object must contain 'id'"),
+                       at);
+    }
+    return true;
+}
+
+bool Decoder::parseTagList(QVector<QUuid> &out) {
+    out.clear();
+    if (!expect('[', "'['")) {
+        return false;
+    }
+    if (consume(']')) {
+        return true;
+    }
+
+    do {
+        QUuid id;
+        if (!parseTagElement(out.size(), id)) {
+            return false;
+        }
+        out.push_back(id);
+    } while (consume(','));
+
+    return expect(']', "',' or ']'");
+}
+
+bool Decoder::decode(Mode mode, Task &task, TaskPatch &patch) {
+    skipWs();
+    if (atEnd()) {
+        return fail(QStringLiteral("empty body"));
+    }
+    if (peek() != '{') {
+        return fail(QStringLiteral("expected JSON object"));
+    }
+    ++m_pos;
+
+    const char *titleAt = m_pos;
+    bool hasTitle = false;
+
+    if (!consume('}')) {
+        do {
+            QString key;
+            if (!parseString(key) || !expect(':', "':'")) {
+                return false;
+            }
+            skipWs();
+            const char *valueAt = m_pos;
+            const char next = peek();
+
+            if (key == QLatin1StringView("title")) {
+                QString title;
+                if (next != '"') {
+                    return invalid(key, QStringLiteral("Field 'title' must be a string"),
+                                   valueAt);
+                }
+                if (!parseString(title)) {
+                    return false;
+                }
+                titleAt = valueAt;
+                hasTitle = true;
+                patch.title = std::move(title);
+            } else if (key == QLatin1StringView("description")) {
+                if (next == 'n') {
+                    if (!matchLiteral("null")) {
+                        return false;
+                    }
+                    patch.description = QStringLiteral("");
+                } else if (next == '"') {
+                    QString description;
+                    if (!parseString(description)) {
+                        return false;
+                    }
+                    patch.description = std::move(description);
+                } else {
+                    return invalid(key,
+                                   QStringLiteral("Field 'description' must be a string"),
+                                   valueAt);
+                }
+            } else if (key == QLatin1StringView("isCompleted")) {
+                if (next == 't') {
+                    if (!matchLiteral("true")) {
+                        return false;
+                    }
+                    patch.isCompleted = true;
+                } else if (next == 'f') {
+                    if (!matchLiteral("false")) {
+                        return false;
+                    }
+                    patch.isCompleted = false;
+                } else {
+                    return invalid(key,
+                                   QStringLiteral("Field 'isCompleted' must be a boolean"),
+                                   valueAt);
+                }
+            } else if (key == QLatin1StringView("tags")) {
+                if (next == 'n') {
+                    if (!matchLiteral("null")) {
+                        return false;
+                    }
+                    patch.tags = QVector<QUuid>{};
+                } else if (next == '[') {
+                    QVector<QUuid> tags;
+                    if (!parseTagList(tags)) {
+                        return false;
+                    }
+                    patch.tags = std::move(tags);
+                } else {
+                    return invalid(key, QStringLiteral("Field 'tags' must be an array"),
+                                   valueAt);
+                }
+            } else if (key == QLatin1StringView("id") && mode == Mode::Create) {
+                if (next == 'n') {
+                    if (!matchLiteral("null")) {
+                        return false;
+                    }
+                } else if (!parseUuidValue(key, task.id)) {
+                    return false;
+                }
+            } else if (!skipValue(1)) {
+                return false;
+            }
+        } while (consume(','));
+
+        if (!expect('}', "',' or '}'")) {
+            return false;
+        }
+    }
+
+    skipWs();
+    if (!atEnd()) {
+        return fail(QStringLiteral("unexpected data after JSON object"));
+    }
+
+    if (mode == Mode::Create) {
+        if (!hasTitle || patch.title->trimmed().isEmpty()) {
+            return invalid(QStringLiteral("title"),
+                           QStringLiteral("Field 'title' is required and must be non-empty"),
+                           titleAt);
+        }
+        // NOT NULL-колонка: пустая, но не null-строка
+        task.description = QStringLiteral("");
+        applyTaskPatch(task, patch);
+    }
+
+    return true;
+}
+
+} // namespace
+
+std::optional<Task> decodeTaskCreate(QByteArrayView body,
+                                     BodyDecodeError *error) {
+    tracing::Span span("decodeTaskCreate");
+    Decoder decoder(body);
+    Task task;
+    TaskPatch fields;
+    if (!decoder.decode(Mode::Create, task, fields)) {
+        if (error) {
+            *error = decoder.error();
+        }
+        return std::nullopt;
+    }
+    return task;
+}
+
+std::optional<TaskPatch> decodeTaskPatch(QByteArrayView body,
+                                         BodyDecodeError *error) {
+    tracing::Span span("decodeTaskPatch");
+    Decoder decoder(body);
+    Task unused;
+    TaskPatch patch;
+    if (!decoder.decode(Mode::Patch, unused, patch)) {
+        if (error) {
+            *error = decoder.error();
+        }
+        return std::nullopt;
+    }
+    return patch;
+}
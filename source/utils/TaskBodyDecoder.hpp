@@ -0,0 +1,37 @@
+#ifndef TASKBODYDECODER_HPP
+#define TASKBODYDECODER_HPP
+
+#include <QByteArrayView>
+#include <QString>
+#include <optional>
+
+#include "Task.hpp"
+#include "TaskPatch.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Однопроходный разбор тела запроса прямо в Task / TaskPatch, без
+// QJsonDocument. Схема проверяется во время чтения; неизвестные ключи
+// пропускаются (но синтаксис их значений проверяется).
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct BodyDecodeError {
+    enum class Kind { Syntax, Validation };
+
+    Kind kind = Kind::Syntax;
+    QString message;
+    QString field;       // "title", "tags[2]", ... (для Validation)
+    qsizetype offset = 0; // байтовое смещение в теле
+    int line = 1;
+    int column = 1;
+};
+
+// POST /task/create: "title" обязателен и непуст; "description" → "",
+// "isCompleted" → false, "tags" → [] по умолчанию. "id" (UUID) необязателен.
+std::optional<Task> decodeTaskCreate(QByteArrayView body,
+                                     BodyDecodeError *error = nullptr);
+
+// PATCH /task: заполняются только присутствующие ключи; "tags": null → [].
+std::optional<TaskPatch> decodeTaskPatch(QByteArrayView body,
+                                         BodyDecodeError *error = nullptr);
+
+#endif // TASKBODYDECODER_HPP
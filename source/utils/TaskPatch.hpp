@@ -4,8 +4,22 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QUuid>
+#include <optional>
 
 #include "Task.hpp"
+#include "UuidCodec.hpp"
+
+// Частичное обновление Task: заполнены только поля, переданные клиентом.
+struct TaskPatch {
+    std::optional<QString> title;
+    std::optional<QString> description;
+    std::optional<bool> isCompleted;
+    std::optional<QVector<QUuid>> tags; // пустой вектор → снять все теги
+
+    bool isEmpty() const {
+        return !title && !description && !isCompleted && !tags;
+    }
+};
 
 inline QVector<QUuid> parseTagIdsFromJsonArray(const QJsonArray &arr) {
     QVector<QUuid> out;
@@ -13,9 +27,9 @@ inline QVector<QUuid> parseTagIdsFromJsonArray(const QJsonArray &arr) {
     for (const QJsonValue &v : arr) {
         QUuid id;
         if (v.isString()) {
-            id = QUuid::fromString(v.toString());
+            id = parseUuid(v.toString());
         } else if (v.isObject()) {
-            id = QUuid::fromString(v.toObject().value("id").toString());
+            id = parseUuid(v.toObject().value("id").toString());
         }
         if (!id.isNull()) {
             out.push_back(id);
@@ -24,37 +38,63 @@ inline QVector<QUuid> parseTagIdsFromJsonArray(const QJsonArray &arr) {
     return out;
 }
 
-// Применяем частичный патч к Task.
+// Разбираем JSON-патч в TaskPatch.
 // Поддерживаем ключи:
 //  - "title": string
 //  - "description": string
 //  - "isCompleted": bool
 //  - "tags": array<string|{id:string}> | null  → полная замена набора тегов
-inline void applyTaskPatch(Task &task, const QJsonObject &obj) {
+inline TaskPatch taskPatchFromJson(const QJsonObject &obj) {
+    TaskPatch patch;
+
     if (obj.contains("title")) {
-        task.title = obj.value("title").toString();
+        patch.title = obj.value("title").toString();
     }
 
     if (obj.contains("description")) {
-        task.description = obj.value("description").toString();
+        patch.description = obj.value("description").toString();
     }
 
-    if (obj.contains("isCompleted")) {
-        task.isCompleted = obj.value("isCompleted").toBool(task.isCompleted);
+    if (obj.contains("isCompleted") && obj.value("isCompleted").isBool()) {
+        patch.isCompleted = obj.value("isCompleted").toBool();
     }
 
     if (obj.contains("tags")) {
         const QJsonValue tagsVal = obj.value("tags");
         if (tagsVal.isArray()) {
-            task.tags = parseTagIdsFromJsonArray(tagsVal.toArray());
+            patch.tags = parseTagIdsFromJsonArray(tagsVal.toArray());
         } else if (tagsVal.isNull()) {
-            task.tags.clear();
+            patch.tags = QVector<QUuid>{};
         } else {
             // игнорируем некорректный формат, намеренно не меняем текущие теги
         }
+    }
+
+    return patch;
+}
 
+inline void applyTaskPatch(Task &task, const TaskPatch &patch) {
+    if (patch.title) {
+        task.title = *patch.title;
+    }
+
+    if (patch.description) {
+        task.description = *patch.description;
+    }
+
+    if (patch.isCompleted) {
+        task.isCompleted = *patch.isCompleted;
+    }
+
+    if (patch.tags) {
+        task.tags = *patch.tags;
         task.tagsExpanded.reset();
     }
 }
 
+// Применяем частичный патч к Task (см. taskPatchFromJson).
+inline void applyTaskPatch(Task &task, const QJsonObject &obj) {
+    applyTaskPatch(task, taskPatchFromJson(obj));
+}
+
 #endif // TASKPATCH_HPP
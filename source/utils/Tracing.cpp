@@ -0,0 +1,221 @@
+#include <QtCore/QtEnvironmentVariables>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "JsonWriter.hpp"
+#include "Tracing.hpp"
+
+namespace tracing {
+namespace {
+
+constexpr std::size_t kMaxStoredTraces = 512;
+constexpr std::size_t kMaxSpansPerTrace = 4096;
+
+using Clock = std::chrono::steady_clock;
+
+quint64 nowNs() {
+    static const Clock::time_point epoch = Clock::now();
+    return static_cast<quint64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch)
+            .count());
+}
+
+double initialSampleRate() {
+    bool ok = false;
+    const double rate =
+        qEnvironmentVariable("TASKLIT_TRACE_SAMPLE").toDouble(&ok);
+    return ok ? std::clamp(rate, 0.0, 1.0) : 0.0;
+}
+
+std::atomic<double> g_sampleRate{initialSampleRate()};
+std::atomic<int> g_nextThreadId{1};
+
+struct SpanRecord {
+    const char *name;
+    quint64 startNs;
+    quint64 durationNs;
+};
+
+struct Trace {
+    const char *route = nullptr;
+    QString requestId;
+    int threadId = 0;
+    int status = 0;
+    quint64 startNs = 0;
+    quint64 durationNs = 0;
+    std::vector<SpanRecord> spans;
+};
+
+struct Store {
+    std::mutex mutex;
+    std::deque<Trace> traces;
+};
+
+Store &store() {
+    static Store instance;
+    return instance;
+}
+
+int currentThreadId() {
+    thread_local const int id = g_nextThreadId.fetch_add(1);
+    return id;
+}
+
+bool shouldSample() {
+    const double rate = g_sampleRate.load(std::memory_order_relaxed);
+    if (rate <= 0.0) {
+        return false;
+    }
+    if (rate >= 1.0) {
+        return true;
+    }
+    thread_local std::minstd_rand rng(std::random_device{}());
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < rate;
+}
+
+thread_local Trace *t_active = nullptr;
+
+void writeMicros(QByteArray &out, quint64 ns) {
+    out.append(QByteArray::number(double(ns) / 1000.0, 'f', 3));
+}
+
+} // namespace
+
+void setSampleRate(double rate) {
+    g_sampleRate.store(std::clamp(rate, 0.0, 1.0), std::memory_order_relaxed);
+}
+
+double sampleRate() {
+    return g_sampleRate.load(std::memory_order_relaxed);
+}
+
+RequestTrace::RequestTrace(const char *routeName, const QString &requestId) {
+    if (t_active || !shouldSample()) {
+        return;
+    }
+
+    auto *trace = new Trace;
+    trace->route = routeName;
+    trace->requestId = requestId;
+    trace->threadId = currentThreadId();
+    trace->startNs = nowNs();
+    trace->spans.reserve(32);
+
+    t_active = trace;
+    m_sampled = true;
+}
+
+RequestTrace::~RequestTrace() {
+    if (!m_sampled) {
+        return;
+    }
+
+    Trace *trace = t_active;
+    t_active = nullptr;
+    trace->durationNs = nowNs() - trace->startNs;
+
+    {
+        std::lock_guard lock(store().mutex);
+        store().traces.push_back(std::move(*trace));
+        if (store().traces.size() > kMaxStoredTraces) {
+            store().traces.pop_front();
+        }
+    }
+    delete trace;
+}
+
+void setRequestStatus(int status) {
+    if (t_active) {
+        t_active->status = status;
+    }
+}
+
+Span::Span(const char *name) {
+    Trace *trace = t_active;
+    if (!trace || trace->spans.size() >= kMaxSpansPerTrace) {
+        return;
+    }
+    m_index = static_cast<qsizetype>(trace->spans.size());
+    trace->spans.push_back(SpanRecord{name, nowNs(), 0});
+}
+
+Span::~Span() {
+    if (m_index < 0 || !t_active) {
+        return;
+    }
+    SpanRecord &span = t_active->spans[static_cast<std::size_t>(m_index)];
+    span.durationNs = nowNs() - span.startNs;
+}
+
+QByteArray exportChromeTrace() {
+    std::deque<Trace> traces;
+    {
+        std::lock_guard lock(store().mutex);
+        traces = store().traces;
+    }
+
+    QByteArray out;
+    out.reserve(static_cast<qsizetype>(traces.size()) * 512 + 64);
+    out.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    bool first = true;
+    const auto beginEvent = [&out, &first]() {
+        if (!first) {
+            out.append(',');
+        }
+        first = false;
+    };
+
+    for (const Trace &trace : traces) {
+        beginEvent();
+        out.append("{\"ph\":\"X\",\"cat\":\"request\",\"pid\":1,\"tid\":");
+        writeJsonInt(out, trace.threadId);
+        out.append(",\"name\":");
+        writeJsonString(out, QString::fromLatin1(trace.route));
+        out.append(",\"ts\":");
+        writeMicros(out, trace.startNs);
+        out.append(",\"dur\":");
+        writeMicros(out, trace.durationNs);
+        out.append(",\"args\":{\"requestId\":");
+        writeJsonString(out, trace.requestId);
+        out.append(",\"status\":");
+        writeJsonInt(out, trace.status);
+        out.append("}}");
+
+        for (const SpanRecord &span : trace.spans) {
+            beginEvent();
+            out.append("{\"ph\":\"X\",\"cat\":\"span\",\"pid\":1,\"tid\":");
+            writeJsonInt(out, trace.threadId);
+            out.append(",\"name\":");
+            writeJsonString(out, QString::fromLatin1(span.name));
+            out.append(",\"ts\":");
+            writeMicros(out, span.startNs);
+            out.append(",\"dur\":");
+            writeMicros(out, span.durationNs);
+            out.append(",\"args\":{\"requestId\":");
+            writeJsonString(out, trace.requestId);
+            out.append("}}");
+        }
+    }
+
+    out.append("]}");
+    return out;
+}
+
+qsizetype storedTraceCount() {
+    std::lock_guard lock(store().mutex);
+    return static_cast<qsizetype>(store().traces.size());
+}
+
+void clearTraces() {
+    std::lock_guard lock(store().mutex);
+    store().traces.clear();
+}
+
+} // namespace tracing
@@ -0,0 +1,54 @@
+#ifndef TRACING_HPP
+#define TRACING_HPP
+
+#include <QByteArray>
+#include <QString>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Трассировка фаз запроса. wrapSafe открывает RequestTrace на время обработки;
+// Span внутри (разбор тела, сервис, SQL, сериализация) пишет интервал с
+// наносекундной точностью в трассу текущего потока. Для несэмплированных
+// запросов Span — одна проверка thread_local указателя.
+// Захваченные трассы отдаются в формате Chrome trace-event (chrome://tracing,
+// Perfetto). Доля сэмплирования: TASKLIT_TRACE_SAMPLE (0..1) или админ-маршрут.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace tracing {
+
+void setSampleRate(double rate);
+double sampleRate();
+
+class RequestTrace {
+public:
+    RequestTrace(const char *routeName, const QString &requestId);
+    ~RequestTrace();
+
+    RequestTrace(const RequestTrace &) = delete;
+    RequestTrace &operator=(const RequestTrace &) = delete;
+
+private:
+    bool m_sampled = false;
+};
+
+// HTTP-статус для активной трассы потока (вызывается из reportRequest*)
+void setRequestStatus(int status);
+
+class Span {
+public:
+    explicit Span(const char *name);
+    ~Span();
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    qsizetype m_index = -1;
+};
+
+// {"traceEvents":[...]} по последним сохранённым трассам
+QByteArray exportChromeTrace();
+qsizetype storedTraceCount();
+void clearTraces();
+
+} // namespace tracing
+
+#endif // TRACING_HPP
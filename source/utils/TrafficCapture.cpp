@@ -0,0 +1,403 @@
+#include <QDateTime>
+#include <QDir>
+#include <QUrl>
+#include <QtEndian>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include "Logger.hpp"
+#include "TrafficCapture.hpp"
+
+namespace capture {
+
+namespace detail {
+std::atomic<bool> g_active{false};
+}
+
+namespace {
+
+constexpr qsizetype kFlushBytes = 64 * 1024;
+
+// Заголовки, от которых зависит поведение маршрутов; остальные не пишутся
+constexpr const char *kKeptHeaders[] = {"Content-Type", "Idempotency-Key", "Last-Event-ID",
+                                        "Accept"};
+
+struct CaptureFile {
+    std::mutex mutex;
+    std::FILE *file = nullptr;
+    QString path;
+    std::chrono::steady_clock::time_point started;
+    QByteArray pending;
+    quint64 requests = 0;
+    quint64 responses = 0;
+    quint64 bytes = 0;
+};
+
+CaptureFile &captureFile() {
+    static CaptureFile instance;
+    return instance;
+}
+
+template <typename T>
+void put(QByteArray &out, T value) {
+    const T le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+template <typename Len>
+void putString(QByteArray &out, QByteArrayView value) {
+    const qsizetype length = std::min<qsizetype>(value.size(), qsizetype(Len(~Len(0))));
+    put<Len>(out, Len(length));
+    out.append(value.first(length));
+}
+
+// Маршруты наблюдения и управления не записываются
+bool isRecordedRoute(const char *routeName) {
+    return std::strstr(routeName, " /admin/") == nullptr &&
+           std::strcmp(routeName, "GET /metrics") != 0;
+}
+
+QHttpServerRequest::Method methodFromRouteName(QByteArrayView routeName) {
+    using Method = QHttpServerRequest::Method;
+    if (routeName.startsWith("GET ")) return Method::Get;
+    if (routeName.startsWith("POST ")) return Method::Post;
+    if (routeName.startsWith("PUT ")) return Method::Put;
+    if (routeName.startsWith("PATCH ")) return Method::Patch;
+    if (routeName.startsWith("DELETE ")) return Method::Delete;
+    return Method::Unknown;
+}
+
+quint64 offsetNs(const CaptureFile &capture) {
+    return quint64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - capture.started)
+                       .count());
+}
+
+void flushLocked(CaptureFile &capture) {
+    if (capture.file && !capture.pending.isEmpty()) {
+        std::fwrite(capture.pending.constData(), 1, std::size_t(capture.pending.size()),
+                    capture.file);
+        std::fflush(capture.file);
+    }
+    capture.pending.resize(0);
+}
+
+// offsetNs дописывается под мьютексом — записи в файле упорядочены по времени
+void appendRecord(RecordType type, const QByteArray &payload, bool isRequest) {
+    CaptureFile &capture = captureFile();
+    std::lock_guard lock(capture.mutex);
+    if (!capture.file) {
+        return;
+    }
+
+    put<quint8>(capture.pending, quint8(type));
+    put<quint32>(capture.pending, quint32(payload.size() + sizeof(quint64)));
+    put<quint64>(capture.pending, offsetNs(capture));
+    capture.pending.append(payload);
+    capture.bytes += quint64(payload.size()) + 13;
+    (isRequest ? capture.requests : capture.responses) += 1;
+
+    if (capture.pending.size() >= kFlushBytes) {
+        flushLocked(capture);
+    }
+}
+
+// Только имя файла с расширением записи: ни путей, ни скрытых файлов
+bool isValidName(const QString &name) {
+    return name.size() > kFileSuffix.size() && name.endsWith(kFileSuffix) &&
+           !name.contains(u'/') && !name.contains(u'\\') && !name.startsWith(u'.');
+}
+
+} // namespace
+
+QString directory() {
+    const QString dir = qEnvironmentVariable("TASKLIT_CAPTURE_DIR");
+    return dir.isEmpty() ? QStringLiteral("captures") : dir;
+}
+
+StartResult start(const QString &name) {
+    if (!isValidName(name)) {
+        qWarning(appCore) << "[CAPTURE] invalid file name" << name;
+        return StartResult::InvalidName;
+    }
+
+    const QDir dir(directory());
+    if (!dir.mkpath(QStringLiteral("."))) {
+        qWarning(appCore) << "[CAPTURE] cannot create directory" << dir.path();
+        return StartResult::Failed;
+    }
+    const QString path = dir.filePath(name);
+
+    CaptureFile &capture = captureFile();
+    std::lock_guard lock(capture.mutex);
+
+    if (capture.file) {
+        flushLocked(capture);
+        std::fclose(capture.file);
+        capture.file = nullptr;
+    }
+
+    // "x" — O_CREAT | O_EXCL: существующий файл не усекается
+    std::FILE *file = std::fopen(QFile::encodeName(path).constData(), "wbx");
+    if (!file) {
+        const bool exists = errno == EEXIST;
+        detail::g_active.store(false, std::memory_order_relaxed);
+        qWarning(appCore) << "[CAPTURE] cannot open" << path
+                          << (exists ? "(already exists)" : "");
+        return exists ? StartResult::Exists : StartResult::Failed;
+    }
+
+    capture.file = file;
+    capture.path = path;
+    capture.started = std::chrono::steady_clock::now();
+    capture.requests = 0;
+    capture.responses = 0;
+    capture.pending.resize(0);
+    capture.pending.append(kMagic, sizeof(kMagic));
+    put<qint64>(capture.pending, QDateTime::currentMSecsSinceEpoch());
+    capture.bytes = quint64(capture.pending.size());
+    flushLocked(capture);
+
+    detail::g_active.store(true, std::memory_order_relaxed);
+    qInfo(appCore) << "[CAPTURE] recording traffic to" << path;
+    return StartResult::Started;
+}
+
+void stop() {
+    CaptureFile &capture = captureFile();
+    std::lock_guard lock(capture.mutex);
+    detail::g_active.store(false, std::memory_order_relaxed);
+    if (!capture.file) {
+        return;
+    }
+
+    flushLocked(capture);
+    std::fclose(capture.file);
+    capture.file = nullptr;
+    qInfo(appCore) << "[CAPTURE] stopped," << capture.requests << "requests in" << capture.path;
+}
+
+void startFromEnvironment() {
+    const QString name = qEnvironmentVariable("TASKLIT_CAPTURE");
+    if (!name.isEmpty()) {
+        start(name);
+    }
+}
+
+Status status() {
+    CaptureFile &capture = captureFile();
+    std::lock_guard lock(capture.mutex);
+    return Status{capture.file != nullptr, capture.path, capture.requests, capture.responses,
+                  capture.bytes};
+}
+
+void recordRequest(const char *routeName, const QHttpServerRequest *request,
+                   const QString &requestId) {
+    if (!isActive() || !isRecordedRoute(routeName)) {
+        return;
+    }
+
+    thread_local QByteArray payload;
+    payload.resize(0);
+
+    if (request) {
+        const QUrl url = request->url();
+        put<quint16>(payload, quint16(request->method()));
+        putString<quint8>(payload, requestId.toLatin1());
+        putString<quint16>(payload, url.path(QUrl::FullyEncoded).toUtf8());
+        putString<quint16>(payload, url.query(QUrl::FullyEncoded).toUtf8());
+
+        const QHttpHeaders headers = request->headers();
+        QByteArray headerBlock;
+        quint8 headerCount = 0;
+        for (const char *name : kKeptHeaders) {
+            const QByteArrayView value = headers.value(QAnyStringView(name));
+            if (!value.isEmpty()) {
+                putString<quint8>(headerBlock, name);
+                putString<quint16>(headerBlock, value);
+                ++headerCount;
+            }
+        }
+        put<quint8>(payload, headerCount);
+        payload.append(headerBlock);
+        putString<quint32>(payload, request->body());
+    } else {
+        const QByteArrayView name(routeName);
+        const qsizetype space = name.indexOf(' ');
+        put<quint16>(payload, quint16(methodFromRouteName(name)));
+        putString<quint8>(payload, requestId.toLatin1());
+        putString<quint16>(payload, space >= 0 ? name.sliced(space + 1) : name);
+        putString<quint16>(payload, {});
+        put<quint8>(payload, 0);
+        putString<quint32>(payload, {});
+    }
+
+    appendRecord(RecordType::Request, payload, true);
+}
+
+void recordResponse(const char *routeName, const QString &requestId, int status,
+                    quint64 latencyNs, QByteArrayView body) {
+    if (!isActive() || !isRecordedRoute(routeName)) {
+        return;
+    }
+
+    thread_local QByteArray payload;
+    payload.resize(0);
+    putString<quint8>(payload, requestId.toLatin1());
+    put<quint16>(payload, quint16(status));
+    put<quint64>(payload, latencyNs);
+    put<quint64>(payload, responseFingerprint(body));
+    // Тело ответа на изменение — источник соответствия id при воспроизведении
+    const bool keepBody = methodFromRouteName(routeName) != QHttpServerRequest::Method::Get &&
+                          body.size() <= kMaxStoredResponseBody;
+    putString<quint32>(payload, keepBody ? body : QByteArrayView());
+
+    appendRecord(RecordType::Response, payload, false);
+}
+
+quint64 responseFingerprint(QByteArrayView body) {
+    if (body.isEmpty()) {
+        return 0;
+    }
+
+    // FNV-1a; значения "requestId" и "ts" пропускаются (без экранирования внутри)
+    constexpr QByteArrayView kVolatileKeys[] = {"\"requestId\":\"", "\"ts\":\""};
+    quint64 hash = 1469598103934665603ULL;
+    qsizetype i = 0;
+    while (i < body.size()) {
+        if (body[i] == '"') {
+            bool skipped = false;
+            for (const QByteArrayView key : kVolatileKeys) {
+                if (body.sliced(i).startsWith(key)) {
+                    const qsizetype end = body.indexOf('"', i + key.size());
+                    i = end < 0 ? body.size() : end + 1;
+                    skipped = true;
+                    break;
+                }
+            }
+            if (skipped) {
+                continue;
+            }
+        }
+        hash ^= uchar(body[i]);
+        hash *= 1099511628211ULL;
+        ++i;
+    }
+    return hash ? hash : 1;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Reader
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+// Последовательное чтение полей payload с проверкой границ
+class Cursor {
+public:
+    explicit Cursor(const QByteArray &data) : m_data(data) {}
+
+    bool ok() const { return m_ok; }
+
+    template <typename T>
+    T take() {
+        if (!need(sizeof(T))) {
+            return T{};
+        }
+        T value;
+        std::memcpy(&value, m_data.constData() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return qFromLittleEndian(value);
+    }
+
+    template <typename Len>
+    QByteArray takeString() {
+        const qsizetype length = qsizetype(take<Len>());
+        if (!need(length)) {
+            return {};
+        }
+        QByteArray out(m_data.constData() + m_pos, length);
+        m_pos += length;
+        return out;
+    }
+
+private:
+    bool need(qsizetype bytes) {
+        if (!m_ok || m_data.size() - m_pos < bytes) {
+            m_ok = false;
+            return false;
+        }
+        return true;
+    }
+
+    const QByteArray &m_data;
+    qsizetype m_pos = 0;
+    bool m_ok = true;
+};
+
+} // namespace
+
+bool Reader::open(const QString &path) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray header = m_file.read(sizeof(kMagic) + sizeof(qint64));
+    if (header.size() != qsizetype(sizeof(kMagic) + sizeof(qint64)) ||
+        std::memcmp(header.constData(), kMagic, sizeof(kMagic)) != 0) {
+        m_file.close();
+        return false;
+    }
+    m_startedAtMs = qFromLittleEndian<qint64>(header.constData() + sizeof(kMagic));
+    return true;
+}
+
+bool Reader::next(RecordType &type, RequestRecord &request, ResponseRecord &response) {
+    char prefix[5];
+    if (m_file.read(prefix, sizeof(prefix)) != qint64(sizeof(prefix))) {
+        return false;
+    }
+    const quint32 size = qFromLittleEndian<quint32>(prefix + 1);
+    m_payload.resize(size);
+    if (m_file.read(m_payload.data(), size) != qint64(size)) {
+        return false;
+    }
+
+    Cursor cursor(m_payload);
+    type = RecordType(quint8(prefix[0]));
+    switch (type) {
+    case RecordType::Request: {
+        request = RequestRecord{};
+        request.offsetNs = cursor.take<quint64>();
+        request.method = QHttpServerRequest::Method(cursor.take<quint16>());
+        request.requestId = cursor.takeString<quint8>();
+        request.path = cursor.takeString<quint16>();
+        request.query = cursor.takeString<quint16>();
+        const quint8 headerCount = cursor.take<quint8>();
+        for (quint8 i = 0; i < headerCount && cursor.ok(); ++i) {
+            Header header;
+            header.name = cursor.takeString<quint8>();
+            header.value = cursor.takeString<quint16>();
+            request.headers.append(std::move(header));
+        }
+        request.body = cursor.takeString<quint32>();
+        return cursor.ok();
+    }
+    case RecordType::Response:
+        response = ResponseRecord{};
+        response.offsetNs = cursor.take<quint64>();
+        response.requestId = cursor.takeString<quint8>();
+        response.status = cursor.take<quint16>();
+        response.latencyNs = cursor.take<quint64>();
+        response.fingerprint = cursor.take<quint64>();
+        response.body = cursor.takeString<quint32>();
+        return cursor.ok();
+    }
+    // Неизвестный тип из более новой версии формата — пропускаем
+    return next(type, request, response);
+}
+
+} // namespace capture
@@ -0,0 +1,126 @@
+#ifndef TRAFFICCAPTURE_HPP
+#define TRAFFICCAPTURE_HPP
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QtHttpServer/QHttpServerRequest>
+#include <atomic>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Запись трафика для воспроизведения (tasklit_replay). Включается явно:
+// TASKLIT_CAPTURE=<имя> при старте или PUT /admin/capture. Файлы создаются
+// только в каталоге записей (TASKLIT_CAPTURE_DIR, по умолчанию "captures"),
+// с расширением .tlcap и никогда не перезаписываются. wrapSafe пишет
+// запрос при поступлении и итог (статус, латентность, отпечаток тела) при
+// ответе; выключенная запись — одна relaxed-загрузка.
+//
+// Формат файла (little-endian):
+//   заголовок: "TLCAP\x01\0\0", i64 startedAtMs (UTC)
+//   запись:    u8 type, u32 payloadSize, payload
+//   Request  : u64 offsetNs, u16 method, str8 requestId, str16 path,
+//              str16 query, u8 headerCount × (str8 name, str16 value), str32 body
+//   Response : u64 offsetNs, str8 requestId, u16 status, u64 latencyNs,
+//              u64 fingerprint, str32 body (только для изменяющих запросов)
+// strN — длина uN и байты. offsetNs — монотонное время от начала записи.
+// ─────────────────────────────────────────────────────────────────────────────
+namespace capture {
+
+enum class RecordType : quint8 { Request = 1, Response = 2 };
+
+inline constexpr char kMagic[8] = {'T', 'L', 'C', 'A', 'P', 1, 0, 0};
+
+// Тела ответов на изменяющие запросы хранятся (для сопоставления id при
+// воспроизведении), но не длиннее этого
+inline constexpr qsizetype kMaxStoredResponseBody = 4096;
+
+namespace detail {
+extern std::atomic<bool> g_active;
+}
+
+inline bool isActive() {
+    return detail::g_active.load(std::memory_order_relaxed);
+}
+
+inline constexpr QLatin1StringView kFileSuffix{".tlcap"};
+
+enum class StartResult { Started, InvalidName, Exists, Failed };
+
+// Каталог записей: TASKLIT_CAPTURE_DIR или "captures" в рабочем каталоге
+QString directory();
+
+// name — простое имя "<…>.tlcap" без пути. Файл создаётся в directory()
+// эксклюзивно: существующий файл (в т.ч. не запись) не открывается
+StartResult start(const QString &name);
+void stop();
+
+// TASKLIT_CAPTURE=<имя>
+void startFromEnvironment();
+
+struct Status {
+    bool active = false;
+    QString path;
+    quint64 requests = 0;
+    quint64 responses = 0;
+    quint64 bytes = 0;
+};
+Status status();
+
+// request == nullptr — обработчик маршрута не принимает запрос; метод и путь
+// берутся из routeName ("METHOD /path")
+void recordRequest(const char *routeName, const QHttpServerRequest *request,
+                   const QString &requestId);
+void recordResponse(const char *routeName, const QString &requestId, int status,
+                    quint64 latencyNs, QByteArrayView body);
+
+// Отпечаток тела ответа без изменчивых полей конверта ("requestId", "ts");
+// 0 — тело не сравнивается
+quint64 responseFingerprint(QByteArrayView body);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Чтение файла записи
+// ─────────────────────────────────────────────────────────────────────────────
+struct Header {
+    QByteArray name;
+    QByteArray value;
+};
+
+struct RequestRecord {
+    quint64 offsetNs = 0;
+    QHttpServerRequest::Method method = QHttpServerRequest::Method::Unknown;
+    QByteArray requestId;
+    QByteArray path;
+    QByteArray query;
+    QList<Header> headers;
+    QByteArray body;
+};
+
+struct ResponseRecord {
+    quint64 offsetNs = 0;
+    QByteArray requestId;
+    int status = 0;
+    quint64 latencyNs = 0;
+    quint64 fingerprint = 0;
+    QByteArray body;
+};
+
+class Reader {
+public:
+    // false — файл не открыт или это не файл записи
+    bool open(const QString &path);
+    qint64 startedAtMs() const { return m_startedAtMs; }
+
+    // Следующая запись; false — конец файла или повреждённая запись
+    bool next(RecordType &type, RequestRecord &request, ResponseRecord &response);
+
+private:
+    QFile m_file;
+    qint64 m_startedAtMs = 0;
+    QByteArray m_payload;
+};
+
+} // namespace capture
+
+#endif // TRAFFICCAPTURE_HPP
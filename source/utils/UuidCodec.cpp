@@ -0,0 +1,274 @@
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TASKLIT_UUID_SSE2 1
+#endif
+
+#include "UuidCodec.hpp"
+
+namespace {
+
+constexpr std::array<qint8, 256> makeHexTable() {
+    std::array<qint8, 256> table{};
+    for (int i = 0; i < 256; ++i) {
+        table[i] = -1;
+    }
+    for (int i = 0; i < 10; ++i) {
+        table['0' + i] = static_cast<qint8>(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        table['a' + i] = static_cast<qint8>(10 + i);
+        table['A' + i] = static_cast<qint8>(10 + i);
+    }
+    return table;
+}
+
+constexpr std::array<qint8, 256> kHexValue = makeHexTable();
+
+// Позиции пар hex-цифр в канонической 36-символьной записи
+constexpr int kCanonicalPos[16] = {0,  2,  4,  6,  9,  11, 14, 16,
+                                   19, 21, 24, 26, 28, 30, 32, 34};
+
+template <typename Char> inline int hexByte(const Char *s) {
+    const auto c0 = static_cast<char32_t>(s[0]);
+    const auto c1 = static_cast<char32_t>(s[1]);
+    if (c0 > 0xFF || c1 > 0xFF) {
+        return -1;
+    }
+    const int hi = kHexValue[c0];
+    const int lo = kHexValue[c1];
+    if ((hi | lo) < 0) {
+        return -1;
+    }
+    return (hi << 4) | lo;
+}
+
+inline QUuid uuidFromBytes(const uchar *b) {
+    return QUuid((uint(b[0]) << 24) | (uint(b[1]) << 16) | (uint(b[2]) << 8) |
+                     uint(b[3]),
+                 ushort((b[4] << 8) | b[5]), ushort((b[6] << 8) | b[7]), b[8],
+                 b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
+}
+
+inline void uuidToBytes(const QUuid &id, uchar *b) {
+    b[0] = uchar(id.data1 >> 24);
+    b[1] = uchar(id.data1 >> 16);
+    b[2] = uchar(id.data1 >> 8);
+    b[3] = uchar(id.data1);
+    b[4] = uchar(id.data2 >> 8);
+    b[5] = uchar(id.data2);
+    b[6] = uchar(id.data3 >> 8);
+    b[7] = uchar(id.data3);
+    std::memcpy(b + 8, id.data4, 8);
+}
+
+template <typename Char>
+bool parseUuidImpl(const Char *s, qsizetype n, QUuid &out) {
+    if (n == kUuidTextLength + 2) {
+        if (s[0] != Char('{') || s[n - 1] != Char('}')) {
+            return false;
+        }
+        ++s;
+        n -= 2;
+    }
+
+    uchar bytes[16];
+    if (n == kUuidTextLength) {
+        if (s[8] != Char('-') || s[13] != Char('-') || s[18] != Char('-') ||
+            s[23] != Char('-')) {
+            return false;
+        }
+        for (int i = 0; i < 16; ++i) {
+            const int v = hexByte(s + kCanonicalPos[i]);
+            if (v < 0) {
+                return false;
+            }
+            bytes[i] = uchar(v);
+        }
+    } else if (n == 32) {
+        for (int i = 0; i < 16; ++i) {
+            const int v = hexByte(s + 2 * i);
+            if (v < 0) {
+                return false;
+            }
+            bytes[i] = uchar(v);
+        }
+    } else {
+        return false;
+    }
+
+    out = uuidFromBytes(bytes);
+    return true;
+}
+
+// 16 байт → 32 hex-символа (нижний регистр)
+inline void hexEncode16(const uchar *in, char *out) {
+#ifdef TASKLIT_UUID_SSE2
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+    const __m128i lo = _mm_and_si128(bytes, mask);
+
+    const auto toAscii = [](__m128i nibbles) {
+        const __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+        const __m128i digits = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+        return _mm_add_epi8(
+            digits, _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10)));
+    };
+
+    const __m128i h = toAscii(hi);
+    const __m128i l = toAscii(lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(h, l));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16),
+                     _mm_unpackhi_epi8(h, l));
+#else
+    static constexpr char kDigits[] = "0123456789abcdef";
+    for (int i = 0; i < 16; ++i) {
+        out[2 * i] = kDigits[in[i] >> 4];
+        out[2 * i + 1] = kDigits[in[i] & 0x0F];
+    }
+#endif
+}
+
+} // namespace
+
+bool parseUuid(QByteArrayView text, QUuid &out) {
+    return parseUuidImpl(text.data(), text.size(), out);
+}
+
+bool parseUuid(QStringView text, QUuid &out) {
+    return parseUuidImpl(text.utf16(), text.size(), out);
+}
+
+void formatUuid(const QUuid &id, char *out) {
+    uchar bytes[16];
+    uuidToBytes(id, bytes);
+
+    char hex[32];
+    hexEncode16(bytes, hex);
+
+    std::memcpy(out, hex, 8);
+    out[8] = '-';
+    std::memcpy(out + 9, hex + 8, 4);
+    out[13] = '-';
+    std::memcpy(out + 14, hex + 12, 4);
+    out[18] = '-';
+    std::memcpy(out + 19, hex + 16, 4);
+    out[23] = '-';
+    std::memcpy(out + 24, hex + 20, 12);
+}
+
+QString uuidToString(const QUuid &id) {
+    char buf[kUuidTextLength];
+    formatUuid(id, buf);
+    return QString::fromLatin1(buf, kUuidTextLength);
+}
+
+void formatUuids(const QUuid *ids, qsizetype count, char *out) {
+    for (qsizetype i = 0; i < count; ++i) {
+        formatUuid(ids[i], out + i * kUuidTextLength);
+    }
+}
+
+qsizetype parseUuidList(QStringView text, QChar separator, QVector<QUuid> &out) {
+    qsizetype parsed = 0;
+    qsizetype start = 0;
+    const qsizetype n = text.size();
+
+    // Геометрический рост: при дописывании в общий массив (CSR в TaskBatch)
+    // точный reserve на каждый вызов давал бы перевыделение на каждую строку
+    const qsizetype needed = out.size() + (n + 1) / (kUuidTextLength + 1);
+    if (needed > out.capacity()) {
+        out.reserve(std::max(needed, out.capacity() * 2));
+    }
+    while (start < n) {
+        qsizetype end = text.indexOf(separator, start);
+        if (end < 0) {
+            end = n;
+        }
+
+        QUuid id;
+        if (parseUuid(text.sliced(start, end - start), id) && !id.isNull()) {
+            out.append(id);
+            ++parsed;
+        }
+        start = end + 1;
+    }
+
+    return parsed;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// UUIDv7
+// ─────────────────────────────────────────────────────────────────────────────
+namespace {
+
+constexpr quint64 kV7SequenceMask = (quint64(1) << 42) - 1;
+// Новая мс начинает счётчик со случайного значения в нижней половине
+// диапазона: остаётся запас на 2^41 id до переполнения
+constexpr quint64 kV7SeedMask = (quint64(1) << 41) - 1;
+
+struct V7State {
+    std::mutex mutex;
+    quint64 lastMs = 0;
+    quint64 sequence = 0;
+};
+
+} // namespace
+
+QUuid makeUuidV7(quint64 unixMs, quint64 sequence, quint32 random) {
+    // rand_a (12 бит) и старшие 30 бит rand_b — счётчик, остальное — random
+    const quint64 seq = sequence & kV7SequenceMask;
+    const uint randA = uint(seq >> 30);
+    const quint32 randB = quint32(seq & 0x3FFFFFFF);
+
+    uchar b[16];
+    b[0] = uchar(unixMs >> 40);
+    b[1] = uchar(unixMs >> 32);
+    b[2] = uchar(unixMs >> 24);
+    b[3] = uchar(unixMs >> 16);
+    b[4] = uchar(unixMs >> 8);
+    b[5] = uchar(unixMs);
+    b[6] = uchar(0x70 | (randA >> 8));
+    b[7] = uchar(randA);
+    b[8] = uchar(0x80 | (randB >> 24));
+    b[9] = uchar(randB >> 16);
+    b[10] = uchar(randB >> 8);
+    b[11] = uchar(randB);
+    b[12] = uchar(random >> 24);
+    b[13] = uchar(random >> 16);
+    b[14] = uchar(random >> 8);
+    b[15] = uchar(random);
+    return uuidFromBytes(b);
+}
+
+QUuid createUuidV7() {
+    static V7State state;
+    QRandomGenerator *rng = QRandomGenerator::global();
+    const quint64 seed = rng->generate64() & kV7SeedMask;
+    const quint64 now = quint64(QDateTime::currentMSecsSinceEpoch());
+
+    quint64 ms;
+    quint64 sequence;
+    {
+        std::lock_guard lock(state.mutex);
+        if (now > state.lastMs) {
+            state.lastMs = now;
+            state.sequence = seed;
+        } else if (++state.sequence > kV7SequenceMask) {
+            // Та же мс (или часы пошли назад) — продолжаем счётчик; исчерпан —
+            // занимаем следующую мс
+            ++state.lastMs;
+            state.sequence = seed;
+        }
+        ms = state.lastMs;
+        sequence = state.sequence;
+    }
+    return makeUuidV7(ms, sequence, rng->generate());
+}
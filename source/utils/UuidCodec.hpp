@@ -0,0 +1,58 @@
+#ifndef UUIDCODEC_HPP
+#define UUIDCODEC_HPP
+
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+#include <QUuid>
+#include <QVector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Быстрый текстовый кодек UUID для роутера, хранилища и сериализаторов.
+// Разбор за один проход по таблице; форматирование в буфер вызывающего
+// без выделения памяти (SSE2 там, где доступен).
+//
+// Принимаемые формы (регистр hex любой):
+//   xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx     (36, каноническая)
+//   {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}   (38)
+//   xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx         (32, без дефисов)
+// ─────────────────────────────────────────────────────────────────────────────
+
+constexpr qsizetype kUuidTextLength = 36;
+
+bool parseUuid(QByteArrayView text, QUuid &out);
+bool parseUuid(QStringView text, QUuid &out);
+
+// Null-UUID при ошибке разбора
+inline QUuid parseUuid(QStringView text) {
+    QUuid id;
+    parseUuid(text, id);
+    return id;
+}
+
+// Каноническая форма в нижнем регистре, ровно kUuidTextLength байт в out
+void formatUuid(const QUuid &id, char *out);
+
+// Каноническая форма без скобок — одно выделение под QString
+QString uuidToString(const QUuid &id);
+
+// Пакетно: count записей по kUuidTextLength байт подряд, без разделителей
+void formatUuids(const QUuid *ids, qsizetype count, char *out);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// UUIDv7 (RFC 9562): 48 бит Unix-времени в мс, 42-битный счётчик, 32 случайных
+// бита. Новые id монотонно растут (в т.ч. в пределах одной мс и между
+// потоками), поэтому вставки по TEXT-ключу идут в правый край B-дерева, а не
+// в случайную страницу. Разбор и форматирование от версии не зависят —
+// существующие v4 id остаются валидными.
+// ─────────────────────────────────────────────────────────────────────────────
+QUuid createUuidV7();
+
+// v7 из заданных полей; sequence — младшие 42 бита (генераторы данных, бенчмарки)
+QUuid makeUuidV7(quint64 unixMs, quint64 sequence, quint32 random);
+
+// Пакетно: список через separator (например, результат group_concat).
+// Невалидные элементы пропускаются; возвращает число разобранных.
+qsizetype parseUuidList(QStringView text, QChar separator, QVector<QUuid> &out);
+
+#endif // UUIDCODEC_HPP